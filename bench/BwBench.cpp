@@ -0,0 +1,361 @@
+/*
+ * BwBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Microbenchmarks of the page placement of BwManager, results in JSON to
+ * compare versions
+ *
+ * migration: throughput of move_pages (GB/s, pages/s) of a buffer of this
+ *   process, by page size (4K, THP), source and destination node, flags
+ *   (MPOL_MF_MOVE, MPOL_MF_MOVE_ALL), batch size and threads
+ * placement: get_new_weights, get_new_weights_v2 and the page and node
+ *   arrays of move_pages_remote, alone
+ *
+ * With a single NUMA node the pages are "moved" from node 0 to node 0, what
+ * is left is the cost of the calls (single_node in the results).
+ *
+ * Usage: bwman_bench [-o FILE] [-m MB] [-r REPS] [-b BATCHES] [-t THREADS]
+ *                    [-p SRC:DST,...]
+ *   -o: results (bwman_bench.json)
+ *   -m: the buffer to migrate (128 MB)
+ *   -r: repetitions of every configuration (3)
+ *   -b: batch sizes in pages, 0: all in one call (0,64,512,4096,32768)
+ *   -t: threads (1,2,4,... up to the cpus, at most 8)
+ *   -p: source and destination nodes (0:last,last:0)
+ */
+
+#include <errno.h>
+#include <numa.h>
+#include <numaif.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/BwManager.hpp"
+#include "include/Interleave.hpp"
+#include "include/Logger.hpp"
+
+// the globals of the manager used by the weights
+extern "C" {
+int BWMAN_WORKERS = 1;
+double sum_ww = 0;
+double sum_nww = 0;
+std::vector<std::pair<double, int>> BWMAN_WEIGHTS;
+}
+
+#define THP_SIZE (2UL << 20)
+
+struct MigrationConfig {
+  unsigned long page_size;
+  int src;
+  int dst;
+  int flags;
+  unsigned long batch;
+  int threads;
+};
+
+static uint64_t now_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static std::vector<long> parse_list(const char *arg) {
+  std::vector<long> list;
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    list.push_back(std::stol(item));
+  }
+  return list;
+}
+
+static bool thp_available() {
+  FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (f == NULL) {
+    return false;
+  }
+  char mode[128] = "";
+  bool available = fgets(mode, sizeof(mode), f) != NULL
+      && strstr(mode, "[never]") == NULL;
+  fclose(f);
+  return available;
+}
+
+// a buffer of bytes aligned to the huge pages, backed by pages of page_size,
+// the mapping in raw
+static char *alloc_buffer(unsigned long bytes, unsigned long page_size,
+                          char *&raw) {
+  raw = (char*) mmap(NULL, bytes + THP_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    LERRORF("mmap of %lu bytes failed: %s", bytes, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  char *buffer = (char*) (((uintptr_t) raw + THP_SIZE - 1) & ~(THP_SIZE - 1));
+  madvise(buffer, bytes,
+          page_size == THP_SIZE ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+  memset(buffer, 1, bytes);
+  return buffer;
+}
+
+static const char *flags_name(int flags) {
+  return flags == MPOL_MF_MOVE_ALL ? "MPOL_MF_MOVE_ALL" : "MPOL_MF_MOVE";
+}
+
+// one configuration, repeated; the row of the results
+static std::string bench_migration(char *buffer, unsigned long bytes,
+                                   const MigrationConfig &c, int reps) {
+  unsigned long page_count = bytes / c.page_size;
+  std::vector<void*> addr(page_count);
+  std::vector<int> src_nodes(page_count, c.src);
+  std::vector<int> dst_nodes(page_count, c.dst);
+  std::vector<int> status(page_count);
+  build_page_array(buffer, page_count, c.page_size, addr.data());
+
+  char row[512];
+  int n = snprintf(row, sizeof(row),
+                   "{\"page_size\": %lu, \"src\": %d, \"dst\": %d, "
+                   "\"flags\": \"%s\", \"batch\": %lu, \"threads\": %d, "
+                   "\"pages\": %lu, ",
+                   c.page_size, c.src, c.dst, flags_name(c.flags), c.batch,
+                   c.threads, page_count);
+
+  double best = 0, total = 0;
+  unsigned long moved = 0;
+  for (int r = 0; r < reps; r++) {
+    // back to the source, not timed
+    if (move_pages_batched(0, page_count, addr.data(), src_nodes.data(),
+                           status.data(), 0, MPOL_MF_MOVE) < 0) {
+      snprintf(row + n, sizeof(row) - n, "\"error\": \"%s\"}", strerror(errno));
+      return row;
+    }
+
+    long failed = 0;
+    uint64_t start = now_nsec();
+#pragma omp parallel num_threads(c.threads) reduction(min:failed)
+    {
+      // a contiguous share of the pages per thread
+      unsigned long share = (page_count + c.threads - 1) / c.threads;
+      unsigned long lo = std::min(page_count, omp_get_thread_num() * share);
+      unsigned long hi = std::min(page_count, lo + share);
+      long rc = move_pages_batched(0, hi - lo, addr.data() + lo,
+                                   dst_nodes.data() + lo, status.data() + lo,
+                                   c.batch, c.flags);
+      failed = rc < 0 ? -errno : 0;
+    }
+    double sec = (now_nsec() - start) / 1e9;
+    if (failed < 0) {
+      snprintf(row + n, sizeof(row) - n, "\"error\": \"%s\"}",
+               strerror(-failed));
+      return row;
+    }
+
+    moved = std::count(status.begin(), status.end(), c.dst);
+    total += sec;
+    if (r == 0 || sec < best) {
+      best = sec;
+    }
+  }
+  snprintf(row + n, sizeof(row) - n,
+           "\"moved\": %lu, \"best_sec\": %.6f, \"mean_sec\": %.6f, "
+           "\"gbps\": %.3f, \"pages_per_sec\": %.0f}",
+           moved, best, total / reps, moved * c.page_size / best / 1e9,
+           moved / best);
+  return row;
+}
+
+// ns per call of a function of the ratio, over the ratios
+template<typename F>
+static std::string bench_weights(const char *name, F weights, int low,
+                                 int high) {
+  const int rounds = 2000;
+  uint64_t start = now_nsec();
+  for (int r = 0; r < rounds; r++) {
+    for (int s = low; s <= high; s++) {
+      weights(s);
+    }
+  }
+  unsigned long calls = rounds * (unsigned long) (high - low + 1);
+  char row[256];
+  snprintf(row, sizeof(row),
+           "{\"name\": \"%s\", \"calls\": %lu, \"ns_per_call\": %.1f}", name,
+           calls, (double) (now_nsec() - start) / calls);
+  return row;
+}
+
+static std::string bench_arrays(unsigned long page_count) {
+  std::vector<void*> addr(page_count);
+  std::vector<int> nodes(page_count);
+  char *start = (char*) (1UL << 40);  // not touched
+
+  // a remote ratio of 30%
+  BWMAN_WEIGHTS = { { 0, 1 }, { 100, 0 } };
+  get_new_weights_v2(30);
+
+  uint64_t t0 = now_nsec();
+  build_page_array(start, page_count, 4096, addr.data());
+  uint64_t t1 = now_nsec();
+  build_node_array(BWMAN_WEIGHTS_temp, page_count, nodes.data());
+  uint64_t t2 = now_nsec();
+
+  char rows[512];
+  snprintf(rows, sizeof(rows),
+           "{\"name\": \"build_page_array\", \"pages\": %lu, "
+           "\"ns_per_page\": %.3f, \"pages_per_sec\": %.0f},\n    "
+           "{\"name\": \"build_node_array\", \"pages\": %lu, "
+           "\"ns_per_page\": %.3f, \"pages_per_sec\": %.0f}",
+           page_count, (double) (t1 - t0) / page_count,
+           page_count / ((t1 - t0) / 1e9), page_count,
+           (double) (t2 - t1) / page_count, page_count / ((t2 - t1) / 1e9));
+  return rows;
+}
+
+int main(int argc, char *argv[]) {
+  std::string output = "bwman_bench.json";
+  unsigned long mb = 128;
+  int reps = 3;
+  std::vector<long> batches = { 0, 64, 512, 4096, 32768 };
+  std::vector<long> threads;
+  std::vector<std::pair<int, int>> pairs;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "o:m:r:b:t:p:")) != -1) {
+    switch (opt) {
+      case 'o':
+        output = optarg;
+        break;
+      case 'm':
+        mb = atol(optarg);
+        break;
+      case 'r':
+        reps = std::max(atoi(optarg), 1);
+        break;
+      case 'b':
+        batches = parse_list(optarg);
+        break;
+      case 't':
+        threads = parse_list(optarg);
+        break;
+      case 'p': {
+        std::stringstream ss(optarg);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+          int src, dst;
+          if (sscanf(item.c_str(), "%d:%d", &src, &dst) != 2) {
+            fprintf(stderr, "Invalid nodes %s\n", item.c_str());
+            return EXIT_FAILURE;
+          }
+          pairs.push_back(std::make_pair(src, dst));
+        }
+        break;
+      }
+      default:
+        fprintf(stderr,
+                "Usage: %s [-o FILE] [-m MB] [-r REPS] [-b BATCHES] "
+                "[-t THREADS] [-p SRC:DST,...]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  // the weights log every call at DEBUG
+  L->loglevel(bwmanager::LogLevel::INFO);
+
+  if (numa_available() < 0) {
+    LERROR("NUMA is not available");
+    return EXIT_FAILURE;
+  }
+  int nodes = numa_num_configured_nodes();
+  int last = numa_max_node();
+  bool single_node = nodes < 2;
+  if (pairs.empty()) {
+    pairs.push_back(std::make_pair(0, last));
+    if (!single_node) {
+      pairs.push_back(std::make_pair(last, 0));
+    }
+  }
+  int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads.empty()) {
+    for (int t = 1; t <= std::min(cpus, 8); t *= 2) {
+      threads.push_back(t);
+    }
+  }
+  std::vector<unsigned long> page_sizes = { (unsigned long) numa_pagesize() };
+  if (thp_available()) {
+    page_sizes.push_back(THP_SIZE);
+  } else {
+    LWARN("Transparent huge pages are disabled, 4K pages only");
+  }
+  if (single_node) {
+    LWARN("Single NUMA node, only the cost of the calls is measured");
+  }
+  unsigned long bytes = mb << 20;
+
+  FILE *f = fopen(output.c_str(), "w");
+  if (f == NULL) {
+    LERRORF("Failed to open %s: %s", output.c_str(), strerror(errno));
+    return EXIT_FAILURE;
+  }
+  struct utsname uts;
+  uname(&uts);
+  fprintf(f, "{\n  \"kernel\": \"%s\",\n  \"machine\": \"%s\",\n"
+          "  \"nodes\": %d,\n  \"single_node\": %s,\n  \"cpus\": %d,\n"
+          "  \"buffer_bytes\": %lu,\n  \"repetitions\": %d,\n",
+          uts.release, uts.machine, nodes, single_node ? "true" : "false",
+          cpus, bytes, reps);
+
+  // the placement, alone
+  fprintf(f, "  \"placement\": [\n    ");
+  BWMAN_WORKERS = 1;
+  BWMAN_WEIGHTS = { { 50, 1 }, { 50, 0 } };
+  sum_ww = 50;
+  sum_nww = 50;
+  fprintf(f, "%s,\n    ",
+          bench_weights("get_new_weights", get_new_weights, -50, 50).c_str());
+  BWMAN_WEIGHTS = { { 0, 1 }, { 100, 0 } };
+  fprintf(f, "%s,\n    ",
+          bench_weights("get_new_weights_v2", get_new_weights_v2, 0, 100)
+              .c_str());
+  fprintf(f, "%s\n  ],\n", bench_arrays(bytes / 4096 * 8).c_str());
+  LINFO("placement done");
+
+  // the migration, every configuration
+  fprintf(f, "  \"migration\": [");
+  const char *sep = "\n    ";
+  for (unsigned long page_size : page_sizes) {
+    char *raw;
+    char *buffer = alloc_buffer(bytes, page_size, raw);
+    for (auto &pair : pairs) {
+      for (int flags : { MPOL_MF_MOVE, MPOL_MF_MOVE_ALL }) {
+        for (long batch : batches) {
+          for (long t : threads) {
+            MigrationConfig c = { page_size, pair.first, pair.second, flags,
+                (unsigned long) batch, (int) t };
+            std::string row = bench_migration(buffer, bytes, c, reps);
+            LINFOF("%s", row.c_str());
+            fprintf(f, "%s%s", sep, row.c_str());
+            sep = ",\n    ";
+          }
+        }
+      }
+    }
+    munmap(raw, bytes + THP_SIZE);
+  }
+  fprintf(f, "\n  ]\n}\n");
+  fclose(f);
+  LINFOF("Results in %s", output.c_str());
+  return EXIT_SUCCESS;
+}
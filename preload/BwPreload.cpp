@@ -0,0 +1,456 @@
+/*
+ * BwPreload.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * LD_PRELOAD library registering the memory of an unmodified BE with the
+ * manager (no MySharedMemory handoff needed)
+ *
+ *   LD_PRELOAD=libbwpreload.so <BE>
+ *
+ * The anonymous mmap()s and the malloc()s of at least BWMAN_MIN_SEGMENT
+ * bytes (1 MiB by default) are registered in the segment queue of the
+ * manager, munmap(), mremap(), free() and realloc() unregister them. The
+ * ranges are tracked locally as well so that they are registered again
+ * with a manager started (or restarted) later.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include "include/SegmentQueue.hpp"
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+#define DEFAULT_MIN_SEGMENT (1UL << 20)
+#define MAX_MAPPINGS 4096
+#define MAX_CHUNKS 4096  // power of 2
+#define ATTACH_PERIOD 1  // how often to look for a (new) manager (s)
+
+// a registered range
+struct Range {
+  uint64_t start;
+  uint64_t length;
+};
+
+// a registered malloc() chunk, ptr 0 is free and 1 a tombstone
+struct Chunk {
+  uintptr_t ptr;
+  Range range;
+};
+
+static uint64_t min_segment = DEFAULT_MIN_SEGMENT;
+static uint64_t page_size = 4096;
+static bool verbose = false;
+
+static SegmentQueue *queue = NULL;
+static ino_t queue_inode = 0;
+static time_t last_attach = 0;
+static pid_t pid = 0;
+
+// the tables of registered ranges, one lock for both
+static std::atomic_flag table_lock = ATOMIC_FLAG_INIT;
+static Range mappings[MAX_MAPPINGS];
+static unsigned num_mappings = 0;
+static Chunk chunks[MAX_CHUNKS];
+static std::atomic<unsigned> num_chunks(0);
+
+// the hooks are not reentrant (shm_open, fprintf)
+static __thread int in_hook __attribute__((tls_model("initial-exec")));
+
+static void lock_table() {
+  while (table_lock.test_and_set(std::memory_order_acquire)) {
+  }
+}
+
+static void unlock_table() {
+  table_lock.clear(std::memory_order_release);
+}
+
+/*
+ * The manager
+ */
+
+// register every range, the queue is new
+static void resync() {
+  lock_table();
+  for (unsigned i = 0; i < num_mappings; i++) {
+    segment_queue_push(queue, SEGMENT_REGISTER, pid, mappings[i].start,
+                       mappings[i].length, segment_queue_generation(queue));
+  }
+  for (unsigned i = 0; i < MAX_CHUNKS; i++) {
+    if (chunks[i].ptr > 1) {
+      segment_queue_push(queue, SEGMENT_REGISTER, pid, chunks[i].range.start,
+                         chunks[i].range.length,
+                         segment_queue_generation(queue));
+    }
+  }
+  unlock_table();
+}
+
+/*
+ * (Re)attach to the queue of the manager at most every ATTACH_PERIOD, a
+ * manager started later creates a new queue (new inode)
+ */
+static void attach() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec - last_attach < ATTACH_PERIOD && last_attach != 0) {
+    return;
+  }
+  last_attach = now.tv_sec;
+
+  struct stat st;
+  if (stat("/dev/shm/" SEGMENT_QUEUE_NAME, &st) != 0) {
+    return;
+  }
+  if (queue != NULL && st.st_ino == queue_inode) {
+    return;
+  }
+  SegmentQueue *q = segment_queue_attach();
+  if (q == NULL) {
+    return;
+  }
+  if (queue != NULL) {
+    munmap(queue, sizeof(SegmentQueue));
+  }
+  queue = q;
+  queue_inode = st.st_ino;
+  if (verbose) {
+    fprintf(stderr, "bwpreload: %d attached to the manager\n", pid);
+  }
+  resync();
+}
+
+// the generation of an event, 0 without a manager
+static uint64_t generation() {
+  attach();
+  return queue ? segment_queue_generation(queue) : 0;
+}
+
+static void push(segment_event_type type, uint64_t start, uint64_t length,
+                 uint64_t gen) {
+  if (queue != NULL && gen != 0) {
+    segment_queue_push(queue, type, pid, start, length, gen);
+  }
+}
+
+/*
+ * The tables
+ */
+
+// the pages of a mapping
+static Range mapping_range(uint64_t start, uint64_t length) {
+  Range range = { start, (length + page_size - 1) & ~(page_size - 1) };
+  return range;
+}
+
+// the whole pages of a chunk
+static Range page_range(uint64_t start, uint64_t length) {
+  uint64_t begin = (start + page_size - 1) & ~(page_size - 1);
+  uint64_t end = (start + length) & ~(page_size - 1);
+  Range range = { begin, end > begin ? end - begin : 0 };
+  return range;
+}
+
+static void add_mapping(Range range) {
+  lock_table();
+  if (num_mappings < MAX_MAPPINGS) {
+    mappings[num_mappings++] = range;
+  }
+  unlock_table();
+}
+
+// cut [start, start + length) out of the mappings
+// returns true if it overlapped any
+static bool remove_mapping(uint64_t start, uint64_t length) {
+  uint64_t end = start + length;
+  bool found = false;
+
+  lock_table();
+  for (unsigned i = 0; i < num_mappings;) {
+    Range &m = mappings[i];
+    uint64_t m_end = m.start + m.length;
+    if (m_end <= start || m.start >= end) {
+      i++;
+      continue;
+    }
+    found = true;
+    if (m.start < start && m_end > end && num_mappings < MAX_MAPPINGS) {
+      // split
+      mappings[num_mappings++] = { end, m_end - end };
+      m.length = start - m.start;
+      i++;
+    } else if (m.start < start) {
+      m.length = start - m.start;
+      i++;
+    } else if (m_end > end) {
+      m.length = m_end - end;
+      m.start = end;
+      i++;
+    } else {
+      mappings[i] = mappings[--num_mappings];
+    }
+  }
+  unlock_table();
+  return found;
+}
+
+static unsigned chunk_slot(uintptr_t ptr) {
+  return (ptr >> 4) * 0x9E3779B97F4A7C15ULL >> 52 & (MAX_CHUNKS - 1);
+}
+
+static bool add_chunk(void *ptr, Range range) {
+  uintptr_t key = (uintptr_t) ptr;
+  lock_table();
+  for (unsigned i = 0, slot = chunk_slot(key); i < MAX_CHUNKS;
+      i++, slot = (slot + 1) & (MAX_CHUNKS - 1)) {
+    if (chunks[slot].ptr <= 1) {
+      chunks[slot].ptr = key;
+      chunks[slot].range = range;
+      num_chunks++;
+      unlock_table();
+      return true;
+    }
+  }
+  unlock_table();
+  return false;
+}
+
+static bool remove_chunk(void *ptr, Range *range) {
+  uintptr_t key = (uintptr_t) ptr;
+  lock_table();
+  for (unsigned i = 0, slot = chunk_slot(key); i < MAX_CHUNKS;
+      i++, slot = (slot + 1) & (MAX_CHUNKS - 1)) {
+    if (chunks[slot].ptr == 0) {
+      break;
+    }
+    if (chunks[slot].ptr == key) {
+      *range = chunks[slot].range;
+      chunks[slot].ptr = 1;
+      num_chunks--;
+      unlock_table();
+      return true;
+    }
+  }
+  unlock_table();
+  return false;
+}
+
+/*
+ * The hooks
+ */
+
+static bool trackable_mapping(size_t length, int prot, int flags) {
+  // skip the files, the reservations and the stacks
+  return length >= min_segment && (flags & MAP_ANONYMOUS) && prot != PROT_NONE
+      && !(flags & MAP_STACK);
+}
+
+static void mapped(void *addr, size_t length) {
+  Range range = mapping_range((uint64_t) addr, length);
+  add_mapping(range);
+  push(SEGMENT_REGISTER, range.start, range.length, generation());
+}
+
+// before the range is unmapped
+static uint64_t unmapping(void *addr, size_t length) {
+  Range range = mapping_range((uint64_t) addr, length);
+  if (range.length == 0 || num_mappings == 0
+      || !remove_mapping(range.start, range.length)) {
+    return 0;
+  }
+  return generation();
+}
+
+static void allocated(void *ptr, size_t size) {
+  if (ptr == NULL || size < min_segment) {
+    return;
+  }
+  Range range = page_range((uint64_t) ptr, size);
+  if (range.length != 0 && add_chunk(ptr, range)) {
+    push(SEGMENT_REGISTER, range.start, range.length, generation());
+  }
+}
+
+// before the chunk is freed
+static void freeing(void *ptr) {
+  Range range;
+  if (ptr == NULL || num_chunks.load(std::memory_order_relaxed) == 0
+      || malloc_usable_size(ptr) < min_segment || !remove_chunk(ptr, &range)) {
+    return;
+  }
+  push(SEGMENT_UNREGISTER, range.start, range.length, generation());
+}
+
+extern "C" {
+
+void* mmap(void *addr, size_t length, int prot, int flags, int fd,
+           off_t offset) {
+  void *p = (void*) syscall(SYS_mmap, addr, length, prot, flags, fd, offset);
+  if (p != MAP_FAILED && !in_hook && trackable_mapping(length, prot, flags)) {
+    in_hook++;
+    mapped(p, length);
+    in_hook--;
+  }
+  return p;
+}
+
+void* mmap64(void *addr, size_t length, int prot, int flags, int fd,
+             off64_t offset) {
+  return mmap(addr, length, prot, flags, fd, offset);
+}
+
+int munmap(void *addr, size_t length) {
+  uint64_t gen = 0;
+  if (!in_hook) {
+    in_hook++;
+    gen = unmapping(addr, length);
+    in_hook--;
+  }
+  int ret = syscall(SYS_munmap, addr, length);
+  if (gen != 0) {
+    Range range = mapping_range((uint64_t) addr, length);
+    push(SEGMENT_UNREGISTER, range.start, range.length, gen);
+  }
+  return ret;
+}
+
+void* mremap(void *old_address, size_t old_size, size_t new_size, int flags,
+             ...) {
+  void *new_address = NULL;
+  if (flags & MREMAP_FIXED) {
+    va_list ap;
+    va_start(ap, flags);
+    new_address = va_arg(ap, void*);
+    va_end(ap);
+  }
+
+  uint64_t gen = 0;
+  if (!in_hook) {
+    in_hook++;
+    gen = unmapping(old_address, old_size);
+    in_hook--;
+  }
+  void *p = (void*) syscall(SYS_mremap, old_address, old_size, new_size, flags,
+                            new_address);
+  if (gen != 0) {
+    Range range = mapping_range((uint64_t) old_address, old_size);
+    push(SEGMENT_UNREGISTER, range.start, range.length, gen);
+    in_hook++;
+    if (p != MAP_FAILED) {
+      mapped(p, new_size);
+    } else {
+      mapped(old_address, old_size);
+    }
+    in_hook--;
+  }
+  return p;
+}
+
+void* malloc(size_t size) {
+  void *p = __libc_malloc(size);
+  if (!in_hook && size >= min_segment) {
+    in_hook++;
+    allocated(p, size);
+    in_hook--;
+  }
+  return p;
+}
+
+void* calloc(size_t nmemb, size_t size) {
+  void *p = __libc_calloc(nmemb, size);
+  if (!in_hook && size != 0 && nmemb >= min_segment / size) {
+    in_hook++;
+    allocated(p, nmemb * size);
+    in_hook--;
+  }
+  return p;
+}
+
+void* realloc(void *ptr, size_t size) {
+  if (!in_hook) {
+    in_hook++;
+    freeing(ptr);
+    in_hook--;
+  }
+  void *p = __libc_realloc(ptr, size);
+  if (!in_hook) {
+    in_hook++;
+    if (p != NULL) {
+      allocated(p, size);
+    } else if (size != 0) {
+      // failed, ptr is still allocated
+      allocated(ptr, malloc_usable_size(ptr));
+    }
+    in_hook--;
+  }
+  return p;
+}
+
+void free(void *ptr) {
+  if (!in_hook) {
+    in_hook++;
+    freeing(ptr);
+    in_hook--;
+  }
+  __libc_free(ptr);
+}
+
+}
+
+/*
+ * Setup and teardown
+ */
+
+static void after_fork() {
+  // the child owns copies of the ranges, register them under its pid
+  pid = getpid();
+  queue = NULL;
+  queue_inode = 0;
+  last_attach = 0;
+  table_lock.clear();
+  in_hook++;
+  attach();
+  in_hook--;
+}
+
+__attribute__((constructor))
+static void initialize_preload() {
+  in_hook++;
+  pid = getpid();
+  page_size = sysconf(_SC_PAGESIZE);
+  const char *env = getenv("BWMAN_MIN_SEGMENT");
+  if (env != NULL) {
+    min_segment = std::max(strtoull(env, NULL, 0), (unsigned long long) 1);
+  }
+  verbose = getenv("BWMAN_PRELOAD_VERBOSE") != NULL;
+  pthread_atfork(NULL, NULL, after_fork);
+  attach();
+  in_hook--;
+}
+
+__attribute__((destructor))
+static void finalize_preload() {
+  in_hook++;
+  if (queue != NULL) {
+    push(SEGMENT_EXIT, 0, 0, segment_queue_generation(queue));
+  }
+  in_hook--;
+}
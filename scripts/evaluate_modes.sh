@@ -0,0 +1,221 @@
+#!/bin/bash
+#
+# This script compares the controller modes (BWMAN_MODE) on one fixed
+# scenario and reports, for every mode, the SLO violation rate, the time to
+# converge, the BE throughput, the migration volume and the CPU time of the
+# controller in one table
+#
+# Scenarios:
+#   sim:     the simulated plant (PLANT=3), reproducible (SIM_SEED)
+#   standin: the built-in workloads on this machine, bwlcservice as the HP
+#            and bwantagonist as the BE (needs MBA, pqos and likwid); pin
+#            them with HP_CPUS, BE_CPUS and BWMAN_CPUS (taskset lists)
+#
+# Time to converge: from the start to the last action (MBA, ratio, LLC)
+# before HOLD seconds without actions, "-" if the run never settled.
+# BE throughput: relative to the unthrottled BE (sim) or GB/s of the
+# antagonist (standin). Migration volume: % of the BE pages moved (sim) or
+# MB moved (standin, from the metrics endpoint).
+#
+# Example usage:
+# scripts/evaluate_modes.sh -b build -s sim -d 120
+# HP_CPUS=0-3 BE_CPUS=4-7 BWMAN_CPUS=8 scripts/evaluate_modes.sh -b build \
+#   -s standin -d 60 -- -d 0,4
+#
+# The arguments after -- are passed to BwManager. Every run leaves its logs
+# and time series in the output directory, the table is also written to
+# results.tsv there.
+
+usage() {
+  echo "Usage: $0 [-b BUILD_DIR] [-s sim|standin] [-d SEC] [-m MODES]" \
+    "[-o OUT_DIR] [-t SLO] [-r RATIO] [-w WEIGHTS] [-H HOLD] [-- ARGS]"
+  exit 1
+}
+
+build_dir="build"
+scenario="sim"
+duration=120
+modes="0 1 2 3 4"
+out_dir="evaluation"
+target_slo=1000
+remote_ratio=50
+weights=""
+hold=10
+
+while getopts "b:s:d:m:o:t:r:w:H:h" opt; do
+  case $opt in
+    b) build_dir=$OPTARG ;;
+    s) scenario=$OPTARG ;;
+    d) duration=$OPTARG ;;
+    m) modes=$OPTARG ;;
+    o) out_dir=$OPTARG ;;
+    t) target_slo=$OPTARG ;;
+    r) remote_ratio=$OPTARG ;;
+    w) weights=$OPTARG ;;
+    H) hold=$OPTARG ;;
+    *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ "$1" == "--" ] && shift
+extra_args=("$@")
+
+mode_names=("abc-numa" "pm-only" "mba-only" "linux-default" "mba-10" "test"
+  "abc-numa-model" "pid" "abc-numa-multi" "bwap")
+
+bwman="$build_dir/BwManager"
+for binary in "$bwman" "$build_dir/bwtsdump"; do
+  [ -x "$binary" ] || { echo "$binary not found, build it first"; exit 1; }
+done
+if [ "$scenario" == "standin" ]; then
+  for binary in "$build_dir/bwlcservice" "$build_dir/bwantagonist"; do
+    [ -x "$binary" ] || { echo "$binary not found, build it first"; exit 1; }
+  done
+elif [ "$scenario" != "sim" ]; then
+  usage
+fi
+
+mkdir -p "$out_dir"
+out_dir=$(cd "$out_dir" && pwd)
+build_dir=$(cd "$build_dir" && pwd)
+bwman="$build_dir/BwManager"
+
+# all the pages on the worker node 0 by default
+if [ -z "$weights" ]; then
+  weights="$out_dir/weights.txt"
+  printf "100,0\n0,1\n" > "$weights"
+fi
+
+# run a command pinned to the cpus (if any)
+pinned() {
+  local cpus=$1
+  shift
+  if [ -n "$cpus" ]; then
+    taskset -c "$cpus" "$@"
+  else
+    "$@"
+  fi
+}
+
+# strip the colors of the logger
+plain() {
+  sed 's/\x1b\[[0-9;]*m//g' "$1"
+}
+
+# the CPU time (user + sys, sec) of the children in the output of times
+cpu_seconds() {
+  awk 'NR == 2 {
+    total = 0
+    for (i = 1; i <= 2; i++) {
+      split($i, t, /[ms]/)
+      total += t[1] * 60 + t[2]
+    }
+    printf "%.2f", total
+  }' "$1"
+}
+
+# the time to converge (sec) from the time series
+converge_seconds() {
+  "$build_dir/bwtsdump" "$1" | awk -v hold="$hold" '
+    NR == 2 { start = $1; last = $1 }
+    NR > 1 {
+      end = $1
+      if (converged == "" && $3 ~ /^apply_/) {
+        if ($1 - last >= hold * 1e9) {
+          converged = last
+        }
+        last = $1
+      }
+    }
+    END {
+      if (converged == "" && end - last >= hold * 1e9) {
+        converged = last
+      }
+      if (NR < 2 || converged == "") {
+        print "-"
+      } else {
+        printf "%.1f", (converged - start) / 1e9
+      }
+    }'
+}
+
+# the SLO violations (%) of the latency samples in the time series
+sample_violations() {
+  "$build_dir/bwtsdump" -s "$1" | awk '
+    NR > 1 && $10 > 0 { n++; if ($10 > $9) v++ }
+    END { if (n == 0) print "-"; else printf "%.2f", 100 * v / n }'
+}
+
+# a counter of the metrics endpoint of the manager
+scrape() {
+  local port=$1 metric=$2
+  { exec 3<>"/dev/tcp/127.0.0.1/$port"; } 2> /dev/null || return
+  printf "GET /metrics HTTP/1.0\r\n\r\n" >&3
+  awk -v m="$metric" '$1 == m { print $2 }' <&3
+  exec 3<&-
+}
+
+run_sim() {
+  local mode=$1 run=$2
+  (
+    "$bwman" -m "$mode" -r "$remote_ratio" -t "$target_slo" -w "$weights" \
+      --PLANT 3 --SIM_DURATION "$duration" --SIM_PHASES 1.0,0.3,0.8 \
+      --SIM_SEED 1 --METRICS_PORT 0 --TIMESERIES "$run.bin" \
+      "${extra_args[@]}" > "$run.log" 2>&1
+    times > "$run.times"
+  )
+  violations=$(plain "$run.log" | sed -n 's/.*SLO violated: \([0-9.]*\)%.*/\1/p')
+  be=$(plain "$run.log" | sed -n 's/.*BE throughput: \([0-9.]*\).*/\1/p')
+  migrated=$(plain "$run.log" |
+    sed -n 's/.*(\([0-9]*\)% of the BE pages moved).*/\1%/p')
+}
+
+run_standin() {
+  local mode=$1 run=$2 port=1234 metrics_port=9191
+  # the same workloads for every mode, started anew
+  pinned "$HP_CPUS" "$build_dir/bwlcservice" -p $port \
+    -d $((duration + 20)) > "$run.hp.log" 2>&1 &
+  local hp=$!
+  sleep 2
+  pinned "$BE_CPUS" "$build_dir/bwantagonist" -c 20,10 \
+    -d $((duration + 10)) > "$run.be.log" 2>&1 &
+  local be_pid=$!
+  (
+    pinned "$BWMAN_CPUS" "$bwman" -m "$mode" -r "$remote_ratio" \
+      -t "$target_slo" -w "$weights" -s 127.0.0.1 -p $port \
+      --METRICS_PORT $metrics_port --TIMESERIES "$run.bin" \
+      "${extra_args[@]}" > "$run.log" 2>&1 &
+    echo $! > "$run.pid"
+    wait $!
+    times > "$run.times"
+  ) &
+  local wrapper=$!
+  sleep "$duration"
+  local bytes
+  bytes=$(scrape $metrics_port bwman_migrated_bytes_total)
+  kill -INT "$(cat "$run.pid")" 2> /dev/null
+  wait $wrapper
+  wait $be_pid
+  kill $hp 2> /dev/null
+  wait $hp
+  violations=$(sample_violations "$run.bin")
+  be=$(plain "$run.be.log" |
+    sed -n 's/.*Total: .* s, \([0-9.]*\) GB\/s.*/\1/p')
+  migrated=$(awk -v b="${bytes:-0}" 'BEGIN { printf "%.0fMB", b / 1048576 }')
+}
+
+table="$out_dir/results.tsv"
+printf "mode\tname\tviolations_%%\tconverge_s\tbe_throughput\tmigrated\tcpu_s\n" \
+  > "$table"
+for mode in $modes; do
+  run="$out_dir/mode$mode"
+  rm -f "$run.bin"
+  echo "Running mode $mode (${mode_names[$mode]}) on the $scenario scenario"
+  violations="" be="" migrated=""
+  "run_$scenario" "$mode" "$run"
+  printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\n" "$mode" "${mode_names[$mode]}" \
+    "${violations:--}" "$(converge_seconds "$run.bin")" "${be:--}" \
+    "${migrated:--}" "$(cpu_seconds "$run.times")" >> "$table"
+done
+
+column -t -s $'\t' "$table" 2> /dev/null || cat "$table"
@@ -0,0 +1,115 @@
+/*
+ * Actuator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Actuator.hpp"
+
+#include <time.h>
+
+#include <map>
+#include <tuple>
+
+#include "include/Logger.hpp"
+#include "include/Plant.hpp"
+#include "include/Profiler.hpp"
+#include "include/Timeline.hpp"
+
+/*
+ * Per (resource, socket, cos) state: the value in the hardware and the
+ * value requested during the current control period
+ */
+struct ActuatorState {
+  int applied = -1;
+  int pending = -1;
+};
+
+static std::map<std::tuple<int, unsigned, unsigned>, ActuatorState> states;
+
+static Histogram actuation_hist;
+static unsigned long num_requests = 0;
+static unsigned long num_writes = 0;
+static unsigned long num_dropped = 0;
+
+static const char *resource_names[] = { "MBA", "LLC" };
+static const char *write_names[] = { "MBA write", "LLC write" };
+
+void actuator_request(actuator_resource res, unsigned socket_id,
+                      unsigned cos_value, int value) {
+  ActuatorState &state = states[std::make_tuple(res, socket_id, cos_value)];
+  num_requests++;
+  if (state.pending != -1 && state.pending != state.applied) {
+    LDEBUGF("SKT%u: %s COS%u => %d coalesced into %d", socket_id,
+            resource_names[res], cos_value, state.pending, value);
+  }
+  state.pending = value;
+}
+
+int actuator_commit() {
+  int writes = 0;
+  struct timespec start, stop;
+
+  for (auto &it : states) {
+    ActuatorState &state = it.second;
+    if (state.pending == -1) {
+      continue;
+    }
+    int res = std::get<0>(it.first);
+    unsigned socket_id = std::get<1>(it.first);
+    unsigned cos_value = std::get<2>(it.first);
+
+    if (state.pending == state.applied) {
+      LDEBUGF("SKT%u: %s COS%u => %d already applied, dropping", socket_id,
+              resource_names[res], cos_value, state.pending);
+      num_dropped++;
+      state.pending = -1;
+      continue;
+    }
+
+    TimelineSpan span("actuation", write_names[res], { { "socket", socket_id },
+        { "cos", cos_value }, { "value", state.pending } });
+    ProfileScope scope(PROF_ACTUATION);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ret = plant->write((actuator_resource) res, socket_id, cos_value,
+                           state.pending);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (ret < 0) {
+      LINFO("Allocation configuration error!");
+      exit(EXIT_FAILURE);
+    }
+    actuation_hist.add(
+        (stop.tv_sec - start.tv_sec) * 1000000000UL
+            + (stop.tv_nsec - start.tv_nsec));
+
+    state.applied = state.pending;
+    state.pending = -1;
+    num_writes++;
+    writes++;
+  }
+
+  return writes;
+}
+
+int actuator_get(actuator_resource res, unsigned socket_id,
+                 unsigned cos_value) {
+  auto it = states.find(std::make_tuple(res, socket_id, cos_value));
+  if (it == states.end()) {
+    return -1;
+  }
+  return it->second.applied;
+}
+
+void actuator_invalidate() {
+  states.clear();
+}
+
+const Histogram& get_actuation_histogram() {
+  return actuation_hist;
+}
+
+void actuator_print_stats() {
+  LINFOF("Actuator: %lu requests, %lu hardware writes, %lu no-op writes dropped",
+         num_requests, num_writes, num_dropped);
+  actuation_hist.print("Actuation latency", "ns");
+}
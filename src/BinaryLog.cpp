@@ -0,0 +1,176 @@
+/*
+ * BinaryLog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/BinaryLog.hpp"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace bwmanager {
+
+const char *loglevel_colors[] = { "\033[37m",         // trace: white
+    "\033[36m",         // debug: cyan
+    "\033[32m",         // info: green
+    "\033[43m\033[1m",  // warn: yellow bold
+    "\033[31m\033[1m",  // error: red bold
+    "\033[1m\033[41m",  // fatal: bold on red
+    "\033[m"            // off: none
+    };
+
+const char *loglevel_names[] = { "TRACE", "DEBUG", "INFO", "WARN",
+    "ERROR", "FATAL", "OFF" };
+
+// the arguments of a record, in order
+class LogArgReader {
+ public:
+  LogArgReader(const LogRecord &r)
+      : _r(r),
+        _arg(0),
+        _offset(0) {
+  }
+
+  bool next(log_arg_type *type, int64_t *i, uint64_t *u, double *d,
+            std::string *s) {
+    if (_arg == _r.nargs) {
+      return false;
+    }
+    *type = (log_arg_type) _r.types[_arg++];
+    if (*type == LOG_ARG_STRING) {
+      // a string read as a number (e.g., %d) is 0
+      *i = 0;
+      *u = 0;
+      *d = 0;
+      uint16_t len;
+      memcpy(&len, _r.payload + _offset, sizeof(len));
+      s->assign(_r.payload + _offset + sizeof(len), len);
+      _offset += sizeof(len) + len;
+      return true;
+    }
+    uint64_t raw;
+    memcpy(&raw, _r.payload + _offset, sizeof(raw));
+    _offset += sizeof(raw);
+    memcpy(i, &raw, sizeof(raw));
+    memcpy(d, &raw, sizeof(raw));
+    *u = raw;
+    return true;
+  }
+
+ private:
+  const LogRecord &_r;
+  int _arg;
+  size_t _offset;
+};
+
+std::string log_format(const char *fmt, const LogRecord &r) {
+  LogArgReader args(r);
+  std::string out;
+  char buf[256];
+
+  for (const char *p = fmt; *p != '\0'; p++) {
+    if (*p != '%') {
+      out += *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      out += '%';
+      p++;
+      continue;
+    }
+    // %[flags][width][.precision][length]conversion, the length is ours
+    std::string spec = "%";
+    const char *q = p + 1;
+    while (*q != '\0' && strchr("-+ #0123456789.", *q) != NULL) {
+      spec += *q++;
+    }
+    while (*q != '\0' && strchr("hlLqjzt", *q) != NULL) {
+      q++;
+    }
+    char conversion = *q;
+    if (conversion == '\0') {
+      break;
+    }
+    p = q;
+
+    log_arg_type type;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+    std::string s;
+    if (!args.next(&type, &i, &u, &d, &s)) {
+      out += "<?>";
+      continue;
+    }
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        snprintf(buf, sizeof(buf), (spec + "lld").c_str(),
+                 type == LOG_ARG_DOUBLE ? (long long) d : (long long) i);
+        break;
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+        snprintf(buf, sizeof(buf), (spec + "ll" + conversion).c_str(),
+                 type == LOG_ARG_DOUBLE ?
+                     (unsigned long long) d : (unsigned long long) u);
+        break;
+      case 'c':
+        snprintf(buf, sizeof(buf), (spec + "c").c_str(), (int) i);
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        snprintf(buf, sizeof(buf), (spec + conversion).c_str(),
+                 type == LOG_ARG_DOUBLE ? d :
+                 type == LOG_ARG_INT ? (double) i : (double) u);
+        break;
+      case 's':
+        if (type != LOG_ARG_STRING) {
+          s = type == LOG_ARG_DOUBLE ? std::to_string(d) : std::to_string(i);
+        }
+        snprintf(buf, sizeof(buf), (spec + "s").c_str(), s.c_str());
+        break;
+      case 'p':
+        snprintf(buf, sizeof(buf), (spec + "p").c_str(), (void*) u);
+        break;
+      default:
+        snprintf(buf, sizeof(buf), "<%%%c?>", conversion);
+        break;
+    }
+    out += buf;
+  }
+  if (r.truncated) {
+    out += " [truncated]";
+  }
+  return out;
+}
+
+std::string log_format_line(const LogSite &site, const LogRecord &r, int pid,
+                            bool color) {
+  char prefix[256];
+  int level = site.level < 0 || site.level > 6 ? 6 : site.level;
+  if (color) {
+    snprintf(prefix, sizeof(prefix),
+             "\033[2m%05" PRIu64 ".%09" PRIu64 " \033[4%dm%6d\033[m %s%5s\033[m "
+             "\033[2m%22s:%-4d %-28s\033[m ",
+             r.time / 1000000000, r.time % 1000000000, pid % 8, pid,
+             loglevel_colors[level], loglevel_names[level], site.file,
+             site.line, site.function);
+  } else {
+    snprintf(prefix, sizeof(prefix),
+             "%05" PRIu64 ".%09" PRIu64 " %6d %5s %22s:%-4d %-28s ",
+             r.time / 1000000000, r.time % 1000000000, pid,
+             loglevel_names[level], site.file, site.line, site.function);
+  }
+  return prefix + log_format(site.fmt, r);
+}
+
+}
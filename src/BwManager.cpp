@@ -1,7 +1,10 @@
 #include "include/BwManager.hpp"
 
+#include <sched.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <boost/program_options.hpp>
 #include <cmath>
 #include <csignal>
@@ -10,11 +13,19 @@
 #include <sstream>
 #include <string>
 
+#include "include/Checkpoint.hpp"
+#include "include/ControlServer.hpp"
 #include "include/Logger.hpp"
 #include "include/MbaHandler.hpp"
+#include "include/Metrics.hpp"
 #include "include/MySharedMemory.hpp"
 #include "include/PagePlacement.hpp"
 #include "include/PerformanceCounters.hpp"
+#include "include/Plant.hpp"
+#include "include/SegmentRegistry.hpp"
+#include "include/Tenants.hpp"
+#include "include/TimeSeries.hpp"
+#include "include/Timeline.hpp"
 #include "include/Utilities.hpp"
 
 // number of workers
@@ -48,6 +59,8 @@ std::string monitored_cores_s;
 std::string weights;
 std::string strConfig = "";
 double target_slo;
+// TARGET_SLO was given, not to be overridden by a checkpoint
+bool target_slo_given = false;
 //TODO: make this dynamic
 //target_slo of xapian in ms
 double target_slo_xapian = 5;
@@ -56,8 +69,64 @@ int port;
 
 int current_remote_ratio;
 int optimal_mba = 100;
+int optimal_llc_ways = 0;
+int llc_control = 1;
+double pid_kp;
+double pid_ki;
+double pid_kd;
+double pid_setpoint;
+int pid_period;
+double bwap_step;
+double bwap_rate;
+double bwap_min_move;
+int bwap_max_iter;
+std::string bwap_weights_out;
 double delta_hp;  // operational region of the controller (5%) - HP
 double delta_be;  // operational region of the controller (5%) - BE
+// settle detection after an action
+useconds_t settle_period;
+useconds_t settle_dead_time;
+useconds_t settle_max_wait;
+size_t settle_window;
+useconds_t latency_window;
+// measure the MBA -> bandwidth response at startup
+int mba_calibration = 0;
+// priorities of the BEs, "pid:priority,..."
+std::string be_priorities;
+// 0=hardware, 1=trace replay (open-loop), 2=plant fitted to a trace,
+// 3=simulated
+int plant_mode = 0;
+std::string trace_record_file;
+std::string trace_replay_file;
+// the simulated plant
+int sim_duration;
+std::string sim_phases;
+int sim_phase_length;
+std::string sim_table;
+int sim_seed;
+// discover the BE segments from /proc instead of waiting for the BEs
+std::string be_pids;
+std::string be_cgroup;
+unsigned long min_segment_size;
+unsigned long min_segment_rss;
+int discovery_period;
+// group allowed to register in the segment queue
+std::string segment_queue_group;
+// runtime control
+std::string control_socket;
+// warm restart
+std::string checkpoint_file_name;
+int checkpoint_period;
+// asynchronous logging
+int log_async;
+std::string log_binary_file;
+// time series of the samples and actions
+std::string timeseries_file;
+int timeseries_max_chunks;
+// telemetry
+int metrics_port;
+std::string timeline_file;
+int timeline_max_events;
 
 void read_config(int argc, const char *argv[]) {
   try {
@@ -68,7 +137,8 @@ void read_config(int argc, const char *argv[]) {
         "name of the configuration file")(
         "BWMAN_MODE,m", value<int>(&bwman_mode_value)->default_value(0),
         "bwman mode value, 0=abc-numa, 1=pm-only, 2=mba-only, 3=linux-default, "
-        "4=mba-10, 5=test")(
+        "4=mba-10, 5=test, 6=abc-numa-model, 7=pid, 8=abc-numa-multi, "
+        "9=bwap")(
         "BWMAN_WEIGHTS,w",
         value<std::string>(&weights)->default_value(
             "/home/dgureya/numa-bw-manager/weights/weights_1w.txt"),
@@ -87,11 +157,133 @@ void read_config(int argc, const char *argv[]) {
                                 value<double>(&delta_hp)->default_value(0.5),
                                 "HP operation region")(
         "DELTA_BE,b", value<double>(&delta_be)->default_value(0.001),
-        "BE operation region");
+        "BE operation region")(
+        "MBA_CALIBRATION,k", value<int>(&mba_calibration)->default_value(0),
+        "measure the MBA levels at startup from the manager core and drop "
+        "those without effect, 0=off (the nominal levels), 1=on")(
+        "LLC_CONTROL,l", value<int>(&llc_control)->default_value(1),
+        "shrink the BE LLC share (L3 CAT) before MBA, 0=off, 1=on")(
+        "PID_KP", value<double>(&pid_kp)->default_value(100),
+        "PID mode: proportional gain (MBA % per unit of slack)")(
+        "PID_KI", value<double>(&pid_ki)->default_value(50),
+        "PID mode: integral gain (MBA % per unit of slack per sec)")(
+        "PID_KD", value<double>(&pid_kd)->default_value(0),
+        "PID mode: derivative gain (MBA % per unit of slack per 1/sec)")(
+        "PID_SETPOINT", value<double>(&pid_setpoint)->default_value(0.1),
+        "PID mode: target HP slack")(
+        "PID_PERIOD", value<int>(&pid_period)->default_value(200),
+        "PID mode: control period (ms)")(
+        "BWAP_STEP", value<double>(&bwap_step)->default_value(7),
+        "bwap mode: % of the pages a probe moves to a node, and the largest "
+        "move of a weight per iteration")(
+        "BWAP_RATE", value<double>(&bwap_rate)->default_value(1000),
+        "bwap mode: % a weight moves per unit of relative stall rate change "
+        "per % of the pages")(
+        "BWAP_MIN_MOVE", value<double>(&bwap_min_move)->default_value(0.5),
+        "bwap mode: converged when no weight moves by this % or more")(
+        "BWAP_MAX_ITER", value<int>(&bwap_max_iter)->default_value(20),
+        "bwap mode: most iterations of the gradient descent")(
+        "BWAP_WEIGHTS_OUT",
+        value<std::string>(&bwap_weights_out)->default_value(""),
+        "bwap mode: write the tuned weights to this file, in the format of "
+        "BWMAN_WEIGHTS (empty: none)")(
+        "SETTLE_PERIOD",
+        value<useconds_t>(&settle_period)->default_value(20000),
+        "settle detection: sampling period (usec)")(
+        "SETTLE_DEAD_TIME",
+        value<useconds_t>(&settle_dead_time)->default_value(100000),
+        "settle detection: time for an action to take effect (usec), raised to "
+        "LATENCY_WINDOW")(
+        "SETTLE_MAX_WAIT",
+        value<useconds_t>(&settle_max_wait)->default_value(3000000),
+        "settle detection: longest wait after an action (usec)")(
+        "SETTLE_WINDOW", value<size_t>(&settle_window)->default_value(10),
+        "settle detection: samples that must stay within the noise")(
+        "LATENCY_WINDOW",
+        value<useconds_t>(&latency_window)->default_value(1000000),
+        "sliding window of the HP p99 at the latency sources (usec), 0 for "
+        "sources without one")(
+        "BE_PRIORITIES", value<std::string>(&be_priorities)->default_value(""),
+        "priorities of the BEs (throttled last: highest), e.g. 1234:1,5678:0")(
+        "PLANT", value<int>(&plant_mode)->default_value(0),
+        "plant, 0=hardware, 1=trace replay (open-loop), 2=plant fitted to a "
+        "trace, 3=simulated")(
+        "TRACE_RECORD",
+        value<std::string>(&trace_record_file)->default_value(""),
+        "record every sample and action to this trace file")(
+        "TRACE_REPLAY",
+        value<std::string>(&trace_replay_file)->default_value(""),
+        "trace file to replay (PLANT=1,2)")(
+        "SIM_DURATION", value<int>(&sim_duration)->default_value(600),
+        "simulated plant: duration (sec)")(
+        "SIM_PHASES", value<std::string>(&sim_phases)->default_value("1.0"),
+        "simulated plant: memory intensity of the BE phases (0-1), e.g. "
+        "1.0,0.3")(
+        "SIM_PHASE_LENGTH", value<int>(&sim_phase_length)->default_value(60),
+        "simulated plant: length of a BE phase (sec)")(
+        "SIM_TABLE", value<std::string>(&sim_table)->default_value(""),
+        "simulated plant: BE throughput per MBA level (rows) and remote "
+        "ratio (columns), as built by test/mba_logs_processor.py")(
+        "SIM_SEED", value<int>(&sim_seed)->default_value(1),
+        "simulated plant: seed of the noise")(
+        "BE_PIDS", value<std::string>(&be_pids)->default_value(""),
+        "discover the segments of these BE processes from /proc, e.g. "
+        "1234,5678")(
+        "BE_CGROUP", value<std::string>(&be_cgroup)->default_value(""),
+        "discover the segments of the processes of this cgroup from /proc, "
+        "e.g. /sys/fs/cgroup/be")(
+        "MIN_SEGMENT_SIZE",
+        value<unsigned long>(&min_segment_size)->default_value(1 << 20),
+        "discovery: smallest mapping to manage (bytes)")(
+        "MIN_SEGMENT_RSS",
+        value<unsigned long>(&min_segment_rss)->default_value(0),
+        "discovery: smallest resident size of a new mapping (bytes)")(
+        "DISCOVERY_PERIOD", value<int>(&discovery_period)->default_value(1000),
+        "discovery: rescan period (ms)")(
+        "SEGMENT_QUEUE_GROUP",
+        value<std::string>(&segment_queue_group)->default_value(""),
+        "group whose BEs may register in the segment queue (empty: only the "
+        "user of the manager)")(
+        "CONTROL_SOCKET",
+        value<std::string>(&control_socket)->default_value(""),
+        "Unix socket of the runtime control, e.g. /tmp/bwman.sock (empty: "
+        "none)")(
+        "CHECKPOINT",
+        value<std::string>(&checkpoint_file_name)->default_value(""),
+        "checkpoint file to resume from and save to (empty: none)")(
+        "CHECKPOINT_PERIOD", value<int>(&checkpoint_period)->default_value(1000),
+        "checkpoint period (ms)")(
+        "LOG_ASYNC", value<int>(&log_async)->default_value(1),
+        "log from a background thread (0: print every message right away)")(
+        "LOG_BINARY", value<std::string>(&log_binary_file)->default_value(""),
+        "write the log records raw to this file, to render with bwlogdecode")(
+        "TIMESERIES",
+        value<std::string>(&timeseries_file)->default_value(
+            "bwman_timeseries.bin"),
+        "record the samples and actions to this file, to read with bwtsdump, "
+        "the previous one is kept as <file>.1 (empty: none)")(
+        "TIMESERIES_MAX_CHUNKS",
+        value<int>(&timeseries_max_chunks)->default_value(0),
+        "keep only the last chunks of 4096 rows of the time series, at least "
+        "2 (0: all)")(
+        "METRICS_PORT", value<int>(&metrics_port)->default_value(0),
+        "serve the metrics on http://127.0.0.1:<port>/metrics, e.g. 9191 (0: "
+        "none)")(
+        "TIMELINE", value<std::string>(&timeline_file)->default_value(""),
+        "write a timeline of the actions to this file, in the Chrome trace "
+        "format (empty: none)")(
+        "TIMELINE_MAX_EVENTS",
+        value<int>(&timeline_max_events)->default_value(1000000),
+        "events per timeline file, the previous one is kept as <file>.1");
 
     variables_map vm;
     store(parse_command_line(argc, argv, generalOptions), vm);
     notify(vm);
+    target_slo_given = !vm["TARGET_SLO"].defaulted();
+
+    if (log_async || !log_binary_file.empty()) {
+      L->start_async(log_binary_file);
+    }
 
     if (vm.count("help")) {
       std::cout << generalOptions << '\n';
@@ -108,6 +300,56 @@ void read_config(int argc, const char *argv[]) {
       LINFOF("DELTA_HP: %.2lf", delta_hp);
       LINFOF("DELTA_BE: %.4lf", delta_be);
       LINFOF("TARGET_SLO_XPN: %.0lf", target_slo_xapian);
+      LINFOF("SETTLE: every %u ms, dead time %u ms, window %zu, at most "
+             "%u ms, latency window %u ms", settle_period / 1000,
+             settle_dead_time / 1000, settle_window, settle_max_wait / 1000,
+             latency_window / 1000);
+      if (std::max(settle_dead_time, latency_window)
+          + settle_window * settle_period >= settle_max_wait) {
+        LWARNF("SETTLE_MAX_WAIT %u ms is too short to ever settle",
+               settle_max_wait / 1000);
+      }
+      LINFOF("MBA_CALIBRATION: %d", mba_calibration);
+      LINFOF("LLC_CONTROL: %d", llc_control);
+      if (!be_priorities.empty()) {
+        LINFOF("BE_PRIORITIES: %s", be_priorities.c_str());
+      }
+      if (!be_pids.empty() || !be_cgroup.empty()) {
+        LINFOF("BE_PIDS: %s, BE_CGROUP: %s",
+               be_pids.empty() ? "-" : be_pids.c_str(),
+               be_cgroup.empty() ? "-" : be_cgroup.c_str());
+        LINFOF("MIN_SEGMENT_SIZE: %lu, MIN_SEGMENT_RSS: %lu, "
+               "DISCOVERY_PERIOD: %d", min_segment_size, min_segment_rss,
+               discovery_period);
+      }
+      LINFOF("CONTROL_SOCKET: %s",
+             control_socket.empty() ? "-" : control_socket.c_str());
+      if (!checkpoint_file_name.empty()) {
+        LINFOF("CHECKPOINT: %s every %d ms", checkpoint_file_name.c_str(),
+               checkpoint_period);
+      }
+      LINFOF("PLANT: %d", plant_mode);
+      if (!trace_record_file.empty()) {
+        LINFOF("TRACE_RECORD: %s", trace_record_file.c_str());
+      }
+      if (plant_mode == 1 || plant_mode == 2) {
+        LINFOF("TRACE_REPLAY: %s", trace_replay_file.c_str());
+      }
+      if (plant_mode == 3) {
+        LINFOF("SIM: %d sec, phases %s of %d sec, table %s, seed %d",
+               sim_duration, sim_phases.c_str(), sim_phase_length,
+               sim_table.empty() ? "-" : sim_table.c_str(), sim_seed);
+      }
+      if (bwman_mode_value == 7) {
+        LINFOF("PID: kp %.2lf, ki %.2lf, kd %.2lf, setpoint %.2lf, period %d ms",
+               pid_kp, pid_ki, pid_kd, pid_setpoint, pid_period);
+      }
+      if (bwman_mode_value == 9) {
+        LINFOF("BWAP: step %.1lf, rate %.0lf, min move %.2lf, %d iterations, "
+               "weights to %s", bwap_step, bwap_rate, bwap_min_move,
+               bwap_max_iter,
+               bwap_weights_out.empty() ? "-" : bwap_weights_out.c_str());
+      }
     }
   } catch (const error &ex) {
     std::cerr << ex.what() << '\n';
@@ -179,8 +421,20 @@ void read_config(int argc, const char *argv[]) {
   /* WEIGHTS = getenv("BWMAN_WEIGHTS") != nullptr;
    if (WEIGHTS) {
    weights = getenv("BWMAN_WEIGHTS");*/
-  // read the weights
-  read_weights(weights);
+  // read the weights; the bwap mode tunes its own online and only needs
+  // them for the modes it may switch to: without a file, all the pages on
+  // the worker node. The same weights whatever mode the manager starts in,
+  // so that a switch into the bwap mode and back is like a cold start.
+  if (bwman_mode_value == 9 && access(weights.c_str(), R_OK) != 0) {
+    LINFOF("No weights file %s, all the pages on node 0 for the other modes",
+           weights.c_str());
+    for (int i = 0; i < MAX_NODES; i++) {
+      BWMAN_WEIGHTS.push_back(make_pair(i == 0 ? 100 : 0, i));
+    }
+    sort(BWMAN_WEIGHTS.begin(), BWMAN_WEIGHTS.end());
+  } else {
+    read_weights(weights);
+  }
   /*} else {
    LDEBUG(
    "Sorry, Weights have not been provided! e.g. "
@@ -190,6 +444,14 @@ void read_config(int argc, const char *argv[]) {
 }
 
 void start_bw_manager() {
+  if (!plant_is_hardware()) {
+    // no latency sources, measurement thread or BE segments to set up
+    LINFOF("Running on the %s plant", plant->name());
+    initialize_stall_rates();
+    initialize_be_processes(mem_segments);
+    run_mode();
+    return;
+  }
   // first make sure the sliding window has been set
   double cl = get_percentile_latency();
   double cl_xpn = get_percentile_latency_xpn();
@@ -210,11 +472,22 @@ void start_bw_manager() {
   // second start the measurements thread
   spawn_measurement_thread();
   LINFO("Measurements thread has been spawned!");
+  // operators can retune from now on
+  start_control_server();
+  start_metrics_server();
+  // resume from the checkpoint of a previous run: its segments first
+  open_checkpoint();
   // third read the memory segments to be moved
   // if (bwman_mode_value != 3) {
   get_memory_segments();
   //}
+  // then its operating point
+  restore_checkpoint();
 
+  run_mode();
+}
+
+static void run_mode_once() {
   switch (bwman_mode_value) {
     case 0:
       LINFO("Running the abc-numa mode!")
@@ -246,6 +519,26 @@ void start_bw_manager() {
       ;
       bw_manager_test();
       break;
+    case 6:
+      LINFO("Running the abc-numa-model mode!")
+      ;
+      abc_numa_model();
+      break;
+    case 7:
+      LINFO("Running the pid mode!")
+      ;
+      pid_mba();
+      break;
+    case 8:
+      LINFO("Running the abc-numa-multi mode!")
+      ;
+      abc_numa_multi();
+      break;
+    case 9:
+      LINFO("Running the bwap mode!")
+      ;
+      bwap_tune();
+      break;
     default:
       LINFO("Invalid mode!")
       ;
@@ -254,6 +547,17 @@ void start_bw_manager() {
   }
 }
 
+void run_mode() {
+  run_mode_once();
+  // the modes return on a mode switch (runtime control)
+  int mode;
+  while (control_take_mode(&mode)) {
+    LINFOF("Switching from mode %d to mode %d", bwman_mode_value, mode);
+    bwman_mode_value = mode;
+    run_mode_once();
+  }
+}
+
 int main(int argc, const char *argv[]) {
   // register signal SIGINT and signal handler
   // and also a terminate handler incase we terminate midway
@@ -262,6 +566,7 @@ int main(int argc, const char *argv[]) {
 
   // parse and display the configuration
   read_config(argc, argv);
+  open_timeseries();
 
   /* if (BWMAN_WORKERS == MAX_NODES) {
    LINFOF("No. of workers equals MAX_NODES (%d==%d)! Exiting", BWMAN_WORKERS,
@@ -274,8 +579,23 @@ int main(int argc, const char *argv[]) {
   // get_sum_nww_ww(BWMAN_WORKERS);
   // initialize likwid
   // initialize_likwid();
-  // initialize mba
-  initialize_mba();
+  if (plant_is_hardware()) {
+    // initialize mba
+    initialize_mba();
+    // calibrate the valid MBA levels on the core the manager is running on
+    calibrate_mba_levels(mba_calibration ? sched_getcpu() : -1);
+    // the BEs can register their segments from now on
+    open_segment_registry();
+  }
+  // the replay plants load the platform (MBA levels, L3 ways) from the trace
+  initialize_plant();
+  // on the clock of the plant
+  open_timeline();
+  optimal_mba = get_max_mba();
+  optimal_llc_ways = get_max_llc_ways();
+  if (optimal_llc_ways == 0) {
+    llc_control = 0;
+  }
 
   is_initialized = true;
   LDEBUG("Initialized");
@@ -283,7 +603,12 @@ int main(int argc, const char *argv[]) {
   start_bw_manager();
 
   // Destroy the shared memory be4 exiting!
+  close_checkpoint();
   destroy_shared_memory();
+  close_segment_registry();
+  stop_control_server();
+  finalize_plant();
+  close_timeseries();
 
   // stop all the counters
   // stop_all_counters();
@@ -0,0 +1,104 @@
+/*
+ * ChangeDetector.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/ChangeDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "include/Logger.hpp"
+
+/////////////////////////////////////////////
+// provide this in a config
+double cusum_k = 1.0;        // drift allowance (std devs)
+double cusum_h = 10.0;       // decision threshold (std devs)
+size_t cusum_warmup = 50;    // samples to learn the baseline (1 sec)
+double cusum_min_rel_std = 0.05;
+////////////////////////////////////////////
+
+static std::vector<ChangeDetector> detectors;
+
+ChangeDetector::ChangeDetector(double k, double h, size_t warmup,
+                               double min_rel_std)
+    : _k(k),
+      _h(h),
+      _warmup(warmup),
+      _min_rel_std(min_rel_std),
+      n(0),
+      _mean(0),
+      m2(0),
+      g_pos(0),
+      g_neg(0) {
+}
+
+void ChangeDetector::rearm() {
+  n = 0;
+  _mean = 0;
+  m2 = 0;
+  g_pos = 0;
+  g_neg = 0;
+}
+
+bool ChangeDetector::update(double x) {
+  if (std::isnan(x) || std::isinf(x)) {
+    return false;
+  }
+
+  // learn the baseline
+  if (n < _warmup) {
+    n++;
+    double delta = x - _mean;
+    _mean += delta / n;
+    m2 += delta * (x - _mean);
+    return false;
+  }
+
+  double std = std::sqrt(m2 / (n - 1));
+  std = std::max(std, _min_rel_std * std::fabs(_mean));
+  if (std == 0) {
+    return false;
+  }
+
+  double z = (x - _mean) / std;
+  g_pos = std::max(0.0, g_pos + z - _k);
+  g_neg = std::max(0.0, g_neg - z - _k);
+
+  if (g_pos > _h || g_neg > _h) {
+    LDEBUGF("CUSUM change: baseline %.10lf, sample %.10lf, g+ %.2lf, g- %.2lf",
+            _mean, x, g_pos, g_neg);
+    rearm();
+    return true;
+  }
+  return false;
+}
+
+bool detect_phase_change(const std::vector<double> &sample) {
+  bool changed = false;
+
+  if (detectors.size() != sample.size()) {
+    detectors.assign(
+        sample.size(),
+        ChangeDetector(cusum_k, cusum_h, cusum_warmup, cusum_min_rel_std));
+  }
+  for (size_t i = 0; i < sample.size(); i++) {
+    if (detectors.at(i).update(sample.at(i))) {
+      LINFOF("Phase change detected in series %lu", i);
+      changed = true;
+    }
+  }
+  // a change in one series shifts the others too, start all over
+  if (changed) {
+    rearm_phase_detection();
+  }
+
+  return changed;
+}
+
+void rearm_phase_detection() {
+  for (size_t i = 0; i < detectors.size(); i++) {
+    detectors.at(i).rearm();
+  }
+}
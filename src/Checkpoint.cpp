@@ -0,0 +1,398 @@
+/*
+ * Checkpoint.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Checkpoint.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+#include "include/PagePlacement.hpp"
+#include "include/PerformanceModel.hpp"
+#include "include/SegmentRegistry.hpp"
+#include "include/SettleDetector.hpp"
+#include "include/Tenants.hpp"
+#include "include/Utilities.hpp"
+
+#define CHECKPOINT_MAGIC 0x31305450434b4d42ULL  // "BMKCPT01"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_MAX_BES 64
+#define CHECKPOINT_MAX_SEGMENTS 4096
+#define CHECKPOINT_MAX_GRID 32
+// pages sampled to check the placement, and the tolerance (% points)
+#define PLACEMENT_SAMPLES 4096
+#define PLACEMENT_TOLERANCE 10
+
+extern PerformanceModel perf_model;
+
+struct checkpoint_be {
+  int32_t pid;
+  int32_t ratio;
+  int32_t mba;
+  uint32_t cos;
+};
+
+struct checkpoint_segment {
+  int32_t pid;
+  uint64_t pid_start_time;  // tells the BE from a process that reused its pid
+  uint64_t start;
+  uint64_t length;
+};
+
+struct checkpoint_cell {
+  int32_t count;
+  double slack;
+  double be_perf;
+};
+
+struct checkpoint_state {
+  uint64_t checksum;  // of everything below
+  uint64_t sequence;
+  int64_t saved_at;  // CLOCK_REALTIME (sec)
+  int32_t mode;
+  int32_t remote_ratio;
+  int32_t mba;
+  int32_t llc_ways;
+  double target_slo;
+  double target_slo_xapian;
+  double settle_estimate[SETTLE_MAX_ACTIONS];
+  uint32_t num_bes;
+  checkpoint_be bes[CHECKPOINT_MAX_BES];
+  uint32_t num_segments;
+  checkpoint_segment segments[CHECKPOINT_MAX_SEGMENTS];
+  uint32_t num_ratios;
+  uint32_t num_mbas;
+  int32_t ratios[CHECKPOINT_MAX_GRID];
+  int32_t mbas[CHECKPOINT_MAX_GRID];
+  checkpoint_cell cells[CHECKPOINT_MAX_GRID * CHECKPOINT_MAX_GRID];
+};
+
+struct checkpoint_file {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t size;
+  std::atomic<uint64_t> sequence;  // of the last complete state
+  checkpoint_state states[2];      // written in turn
+};
+
+static checkpoint_file *file = NULL;
+static checkpoint_state loaded;
+static bool has_loaded = false;
+static uint64_t sequence = 0;
+static struct timespec last_save;
+
+static uint64_t get_checksum(const checkpoint_state *state) {
+  // FNV-1a
+  const unsigned char *p = (const unsigned char*) state + sizeof(uint64_t);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = sizeof(uint64_t); i < sizeof(checkpoint_state); i++) {
+    hash = (hash ^ *p++) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static bool is_valid(const checkpoint_state *state) {
+  return state->sequence != 0 && state->checksum == get_checksum(state);
+}
+
+/*
+ * Start time of a process (clock ticks after boot, field 22 of
+ * /proc/<pid>/stat), 0 if it does not exist
+ */
+static uint64_t get_pid_start_time(pid_t pid) {
+  std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+  std::string line;
+  if (!std::getline(stat, line)) {
+    return 0;
+  }
+  // the command (field 2) may hold spaces and parentheses
+  size_t end = line.rfind(')');
+  if (end == std::string::npos) {
+    return 0;
+  }
+  std::istringstream fields(line.substr(end + 1));
+  std::string field;
+  // fields 3 to 21
+  for (int i = 3; i < 22; i++) {
+    fields >> field;
+  }
+  uint64_t start_time = 0;
+  fields >> start_time;
+  return start_time;
+}
+
+// the segments of the BEs still alive, the pid not reused since the save
+static std::vector<MySharedMemory> get_live_segments(
+    const checkpoint_state &state) {
+  std::vector<MySharedMemory> segments;
+  for (uint32_t i = 0; i < state.num_segments; i++) {
+    const checkpoint_segment &s = state.segments[i];
+    uint64_t start_time = get_pid_start_time(s.pid);
+    if (start_time != 0 && start_time == s.pid_start_time) {
+      segments.push_back(
+          MySharedMemory((void*) s.start, s.length, s.pid));
+    }
+  }
+  return segments;
+}
+
+bool open_checkpoint() {
+  if (checkpoint_file_name.empty()) {
+    return false;
+  }
+  int fd = open(checkpoint_file_name.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd < 0) {
+    LWARNF("Unable to open the checkpoint %s (%s)",
+           checkpoint_file_name.c_str(), strerror(errno));
+    return false;
+  }
+  // a file of another layout is started afresh
+  struct checkpoint_file header;
+  bool fresh = pread(fd, &header, offsetof(checkpoint_file, sequence), 0)
+      != (ssize_t) offsetof(checkpoint_file, sequence)
+      || header.magic != CHECKPOINT_MAGIC
+      || header.version != CHECKPOINT_VERSION
+      || header.size != sizeof(checkpoint_file);
+  if (fresh && ftruncate(fd, 0) != 0) {
+    LWARNF("Unable to reset the checkpoint (%s)", strerror(errno));
+  }
+  if (ftruncate(fd, sizeof(checkpoint_file)) != 0) {
+    LWARNF("Unable to size the checkpoint (%s)", strerror(errno));
+    close(fd);
+    return false;
+  }
+  void *p = mmap(NULL, sizeof(checkpoint_file), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    LWARNF("Unable to map the checkpoint (%s)", strerror(errno));
+    return false;
+  }
+  file = (checkpoint_file*) p;
+  clock_gettime(CLOCK_MONOTONIC, &last_save);
+
+  if (fresh) {
+    file->magic = CHECKPOINT_MAGIC;
+    file->version = CHECKPOINT_VERSION;
+    file->size = sizeof(checkpoint_file);
+    file->sequence = 0;
+    LINFOF("New checkpoint %s", checkpoint_file_name.c_str());
+    return false;
+  }
+
+  // the last complete state, or the one before
+  uint64_t seq = file->sequence;
+  const checkpoint_state *state = &file->states[seq & 1];
+  if (!is_valid(state) || state->sequence != seq) {
+    state = &file->states[(seq + 1) & 1];
+    if (!is_valid(state)) {
+      LWARN("No valid state in the checkpoint, cold start");
+      return false;
+    }
+  }
+  memcpy(&loaded, state, sizeof(checkpoint_state));
+  sequence = loaded.sequence;
+  has_loaded = true;
+
+  std::vector<MySharedMemory> segments = get_live_segments(loaded);
+  register_segments(segments);
+  LINFOF("Checkpoint of %ld sec ago: mode %d, ratio %d, mba %d, "
+         "%lu of %u segments alive", (long) (time(NULL) - loaded.saved_at),
+         loaded.mode, loaded.remote_ratio, loaded.mba, segments.size(),
+         loaded.num_segments);
+  return true;
+}
+
+// the model and the settle estimates do not depend on the placement
+static void restore_learning() {
+  for (int i = 0; i < SETTLE_MAX_ACTIONS; i++) {
+    set_settle_estimate((settle_action) i, loaded.settle_estimate[i]);
+  }
+
+  if (loaded.mode != bwman_mode_value || loaded.num_ratios == 0) {
+    return;
+  }
+  std::vector<int> ratios(loaded.ratios, loaded.ratios + loaded.num_ratios);
+  std::vector<int> mbas(loaded.mbas, loaded.mbas + loaded.num_mbas);
+  if (mbas != get_mba_levels()) {
+    LINFO("The MBA levels changed, the performance table is not resumed");
+    return;
+  }
+  std::vector<PerformanceModel::Cell> cells;
+  for (uint32_t i = 0; i < loaded.num_ratios * loaded.num_mbas; i++) {
+    PerformanceModel::Cell cell = { loaded.cells[i].count,
+        loaded.cells[i].slack, loaded.cells[i].be_perf };
+    cells.push_back(cell);
+  }
+  perf_model.reset(ratios, mbas);
+  perf_model.set_cells(cells);
+  LINFOF("Resumed the performance table (%d observations)",
+         perf_model.observations());
+}
+
+// does the live placement still match the saved ratio?
+static bool check_placement(const std::vector<MySharedMemory> &segments,
+                            int ratio) {
+  double live = get_remote_ratio(segments, PLACEMENT_SAMPLES);
+  if (live < 0) {
+    // nothing resident yet, nothing to contradict
+    return true;
+  }
+  if (std::fabs(live - ratio) > PLACEMENT_TOLERANCE) {
+    LINFOF("Live remote ratio %.1lf, saved %d", live, ratio);
+    return false;
+  }
+  return true;
+}
+
+bool restore_checkpoint() {
+  if (!has_loaded) {
+    return false;
+  }
+  restore_learning();
+
+  if (loaded.mode != bwman_mode_value) {
+    LINFOF("Checkpoint of mode %d, cold start of mode %d", loaded.mode,
+           bwman_mode_value);
+    return false;
+  }
+  if (!check_placement(mem_segments, loaded.remote_ratio)) {
+    LINFO("The placement changed since the checkpoint, cold start");
+    return false;
+  }
+
+  current_remote_ratio = loaded.remote_ratio;
+  optimal_mba = loaded.mba;
+  apply_mba(optimal_mba);
+  if (llc_control && loaded.llc_ways > 0) {
+    optimal_llc_ways = loaded.llc_ways;
+    apply_llc(optimal_llc_ways);
+  }
+  // an SLO given on the command line wins over the saved one
+  if (!target_slo_given) {
+    target_slo = loaded.target_slo;
+    target_slo_xapian = loaded.target_slo_xapian;
+  }
+
+  for (uint32_t i = 0; i < loaded.num_bes; i++) {
+    const checkpoint_be &saved = loaded.bes[i];
+    for (BeProcess &be : be_processes) {
+      if (be.pid != saved.pid) {
+        continue;
+      }
+      if (check_placement(be.segments, saved.ratio)) {
+        be.ratio = saved.ratio;
+      }
+      set_be_mba(be, saved.mba);
+    }
+  }
+  actuator_commit();
+  LINFOF("Resumed at ratio %d, mba %d, llc ways %d", current_remote_ratio,
+         optimal_mba, optimal_llc_ways);
+  return true;
+}
+
+void save_checkpoint() {
+  if (file == NULL) {
+    return;
+  }
+  checkpoint_state *state = &file->states[(sequence + 1) & 1];
+
+  state->sequence = 0;  // incomplete
+  state->saved_at = time(NULL);
+  state->mode = bwman_mode_value;
+  state->remote_ratio = current_remote_ratio;
+  state->mba = optimal_mba;
+  state->llc_ways = optimal_llc_ways;
+  state->target_slo = target_slo;
+  state->target_slo_xapian = target_slo_xapian;
+  for (int i = 0; i < SETTLE_MAX_ACTIONS; i++) {
+    state->settle_estimate[i] = get_settle_estimate((settle_action) i);
+  }
+
+  state->num_bes = std::min(be_processes.size(),
+                            (size_t) CHECKPOINT_MAX_BES);
+  for (uint32_t i = 0; i < state->num_bes; i++) {
+    const BeProcess &be = be_processes.at(i);
+    state->bes[i] = { be.pid, be.ratio, be.mba, be.cos };
+  }
+
+  state->num_segments = std::min(mem_segments.size(),
+                                 (size_t) CHECKPOINT_MAX_SEGMENTS);
+  // the start time of a BE does not change, read /proc once per BE
+  pid_t last_pid = -1;
+  uint64_t start_time = 0;
+  for (uint32_t i = 0; i < state->num_segments; i++) {
+    const MySharedMemory &s = mem_segments.at(i);
+    if (s.processID != last_pid) {
+      last_pid = s.processID;
+      start_time = get_pid_start_time(last_pid);
+    }
+    state->segments[i] = { s.processID, start_time,
+        (uint64_t) s.pageAlignedStartAddress, s.pageAlignedLength };
+  }
+
+  const std::vector<int> &ratios = perf_model.get_ratios();
+  const std::vector<int> &mbas = perf_model.get_mbas();
+  if (ratios.size() <= CHECKPOINT_MAX_GRID && mbas.size() <= CHECKPOINT_MAX_GRID) {
+    state->num_ratios = ratios.size();
+    state->num_mbas = mbas.size();
+    std::copy(ratios.begin(), ratios.end(), state->ratios);
+    std::copy(mbas.begin(), mbas.end(), state->mbas);
+    const std::vector<PerformanceModel::Cell> &cells = perf_model.get_cells();
+    for (size_t i = 0; i < cells.size(); i++) {
+      state->cells[i] = { cells.at(i).count, cells.at(i).slack,
+          cells.at(i).be_perf };
+    }
+  } else {
+    state->num_ratios = state->num_mbas = 0;
+  }
+
+  state->sequence = ++sequence;
+  state->checksum = get_checksum(state);
+  // publish the complete state
+  file->sequence.store(sequence, std::memory_order_release);
+  msync(file, sizeof(checkpoint_file), MS_ASYNC);
+}
+
+void checkpoint_if_due() {
+  if (file == NULL) {
+    return;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if ((now.tv_sec - last_save.tv_sec) * 1000
+      + (now.tv_nsec - last_save.tv_nsec) / 1000000 < checkpoint_period) {
+    return;
+  }
+  last_save = now;
+  save_checkpoint();
+}
+
+void close_checkpoint() {
+  if (file == NULL) {
+    return;
+  }
+  save_checkpoint();
+  munmap(file, sizeof(checkpoint_file));
+  file = NULL;
+}
@@ -0,0 +1,257 @@
+/*
+ * ControlServer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/ControlServer.hpp"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+#include "include/Metrics.hpp"
+#include "include/Plant.hpp"
+#include "include/Tenants.hpp"
+#include "include/Utilities.hpp"
+
+using boost::asio::local::stream_protocol;
+
+#define MAX_MODE 9
+#define BWAP_MODE 9
+
+extern useconds_t sleeptime;
+
+// the requests for the controller thread
+static std::mutex requests_mutex;
+static std::vector<std::function<void()>> requests;
+static std::atomic<bool> paused(false);
+static std::atomic<int> requested_mode(-1);
+static bool started = false;
+
+static void queue_request(std::function<void()> request) {
+  std::lock_guard<std::mutex> lock(requests_mutex);
+  requests.push_back(request);
+}
+
+// from the snapshot of the last iteration, the socket thread does not
+// touch the state of the controller
+static std::string get_state() {
+  MetricsSnapshot s;
+  metrics_read_snapshot(&s);
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "mode=%d paused=%d slo=%.2lf slo_xapian=%.2lf latency=%.2lf "
+           "latency_xapian=%.2lf slack=%.3lf ratio=%d mba=%d llc_ways=%d "
+           "period_ms=%u segments=%" PRIu64 " bes=%" PRIu64,
+           s.mode, s.paused, s.target_slo[0], s.target_slo[1], s.latency[0],
+           s.latency[1], s.slack[0], s.remote_ratio, s.mba, s.llc_ways,
+           s.period_ms, s.segments, s.bes_total);
+  return buf;
+}
+
+static void force_ratio(int ratio) {
+  LINFOF("Control: forcing the remote ratio to %d", ratio);
+  plant->place_pages(ratio);
+  current_remote_ratio = ratio;
+  for (BeProcess &be : be_processes) {
+    be.ratio = ratio;
+  }
+}
+
+static void force_mba(int mba_value) {
+  LINFOF("Control: forcing MBA to %d", mba_value);
+  if (be_processes.empty()) {
+    apply_mba(mba_value);
+  }
+  for (BeProcess &be : be_processes) {
+    set_be_mba(be, mba_value);
+  }
+  actuator_commit();
+  optimal_mba = mba_value;
+}
+
+static std::string handle_request(const std::string &line) {
+  std::istringstream in(line);
+  std::string command;
+  in >> command;
+
+  if (command == "state") {
+    return "ok " + get_state();
+  } else if (command == "slo") {
+    std::string source;
+    double target;
+    if (!(in >> source >> target) || target <= 0) {
+      return "error usage: slo <memcached|xapian> <target>";
+    }
+    if (source == "memcached") {
+      queue_request([target]() {
+        LINFOF("Control: memcached SLO target %.2lf", target);
+        target_slo = target;
+      });
+    } else if (source == "xapian") {
+      queue_request([target]() {
+        LINFOF("Control: xapian SLO target %.2lf", target);
+        target_slo_xapian = target;
+      });
+    } else {
+      return "error unknown source " + source;
+    }
+  } else if (command == "mode") {
+    int mode;
+    if (!(in >> mode) || mode < 0 || mode > MAX_MODE) {
+      return "error usage: mode <0-9>";
+    }
+    if (mode == BWAP_MODE && !bwap_ready()) {
+      return "error the bwap mode needs the stall rate counters (likwid)";
+    }
+    requested_mode = mode;
+  } else if (command == "ratio") {
+    int ratio;
+    if (!(in >> ratio) || ratio < 0 || ratio > 100) {
+      return "error usage: ratio <0-100>";
+    }
+    queue_request([ratio]() {
+      force_ratio(ratio);
+    });
+  } else if (command == "mba") {
+    int mba_value;
+    if (!(in >> mba_value) || mba_value < get_min_mba()
+        || mba_value > get_max_mba()) {
+      return "error usage: mba <" + std::to_string(get_min_mba()) + "-"
+          + std::to_string(get_max_mba()) + ">";
+    }
+    // the closest valid level below
+    mba_value = get_prev_mba(mba_value + 1);
+    queue_request([mba_value]() {
+      force_mba(mba_value);
+    });
+    return "ok mba=" + std::to_string(mba_value);
+  } else if (command == "period") {
+    int period;
+    if (!(in >> period) || period <= 0) {
+      return "error usage: period <ms>";
+    }
+    queue_request([period]() {
+      LINFOF("Control: monitoring period %d ms", period);
+      sleeptime = period * 1000;
+      pid_period = period;
+    });
+  } else if (command == "pause") {
+    LINFO("Control: pausing the controller");
+    paused = true;
+  } else if (command == "resume") {
+    LINFO("Control: resuming the controller");
+    paused = false;
+  } else {
+    return "error unknown request " + command;
+  }
+  return "ok";
+}
+
+// one connection at a time, the operators are few
+static void control_server(std::string path) {
+  try {
+    boost::asio::io_service io_service;
+    stream_protocol::acceptor acceptor(io_service);
+    acceptor.open();
+    // owner only, from the moment bind() creates the socket
+    boost::system::error_code bind_error;
+    mode_t mask = umask(0177);
+    acceptor.bind(stream_protocol::endpoint(path), bind_error);
+    umask(mask);
+    if (bind_error) {
+      throw boost::system::system_error(bind_error);
+    }
+    acceptor.listen();
+    LINFOF("Control socket %s is open", path.c_str());
+
+    for (;;) {
+      stream_protocol::socket socket(io_service);
+      acceptor.accept(socket);
+      boost::asio::streambuf buf;
+      boost::system::error_code error;
+      for (;;) {
+        boost::asio::read_until(socket, buf, '\n', error);
+        if (error) {
+          break;
+        }
+        std::istream is(&buf);
+        std::string line;
+        getline(is, line);
+        if (line.empty()) {
+          continue;
+        }
+        std::string response = handle_request(line) + "\n";
+        boost::asio::write(socket, boost::asio::buffer(response), error);
+        if (error) {
+          break;
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    LWARNF("Control socket %s: %s", path.c_str(), e.what());
+  }
+}
+
+void start_control_server() {
+  if (control_socket.empty()) {
+    return;
+  }
+  // a stale socket of a previous run
+  unlink(control_socket.c_str());
+  std::thread t(control_server, control_socket);
+  // do not wait it to finish
+  t.detach();
+  started = true;
+}
+
+void stop_control_server() {
+  if (started) {
+    unlink(control_socket.c_str());
+    started = false;
+  }
+}
+
+void control_apply_requests() {
+  std::vector<std::function<void()>> pending;
+  {
+    std::lock_guard<std::mutex> lock(requests_mutex);
+    pending.swap(requests);
+  }
+  for (auto &request : pending) {
+    request();
+  }
+}
+
+bool control_paused() {
+  return paused;
+}
+
+bool control_mode_requested() {
+  return requested_mode >= 0;
+}
+
+bool control_take_mode(int *mode) {
+  int m = requested_mode.exchange(-1);
+  if (m < 0) {
+    return false;
+  }
+  *mode = m;
+  return true;
+}
@@ -0,0 +1,262 @@
+/*
+ * Interleave.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Interleave.hpp"
+
+#include <errno.h>
+#include <math.h>
+#include <numaif.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+
+// temporary vector of weights initialized to zero
+std::vector<std::pair<double, int>> BWMAN_WEIGHTS_temp(MAX_NODES,
+                                                       std::make_pair(0, 0));
+
+int check_sum(std::vector<std::pair<double, int>> n) {
+  double sum = 0;
+  int i = 0;
+
+  for (i = 0; i < MAX_NODES; i++) {
+    sum += n.at(i).first;
+  }
+  return std::lround(sum);
+}
+
+// Calculate the new weights with respect to the new ratio (not considering
+// sum_ww & sum_nww)!
+void get_new_weights_v2(double s) {
+  int i = 0;
+  double sum = 0;
+
+  for (i = 0; i < MAX_NODES; i++) {
+    switch (BWMAN_WORKERS) {
+      case 1:
+        // workers: 0
+        if (BWMAN_WEIGHTS.at(i).second == 0) {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(BWMAN_WEIGHTS.at(i).first - s);
+
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        } else {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(s);
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        }
+        break;
+      default:
+        LINFOF("Sorry, %d Worker nodes is not supported at the moment!\n",
+               BWMAN_WORKERS)
+        ;
+        exit(-1);
+    }
+  }
+
+  // sort the vector in ascending order just incase it gets unordered
+  sort(BWMAN_WEIGHTS_temp.begin(), BWMAN_WEIGHTS_temp.end());
+
+  // at every placement, not on stdout
+  std::string weights;
+  for (i = 0; i < MAX_NODES; i++) {
+    char weight[32];
+    snprintf(weight, sizeof(weight), "\t%d : %.2f",
+             BWMAN_WEIGHTS_temp.at(i).second, BWMAN_WEIGHTS_temp.at(i).first);
+    weights += weight;
+  }
+  LDEBUGF("New Weights (sum %.2f):%s", sum, weights.c_str());
+
+  if ((check_sum(BWMAN_WEIGHTS_temp)) != 100) {
+    printf("**Sum of New weights must be equal to 100, sum=%d!**\n",
+           check_sum(BWMAN_WEIGHTS_temp));
+    exit(-1);
+  }
+}
+
+// Calculate the new weights with respect to the new ratio!
+void get_new_weights(double s) {
+  int i = 0;
+  double new_s = 0;
+  new_s = sum_ww + s;
+  double sum = 0;
+
+  for (i = 0; i < MAX_NODES; i++) {
+    switch (BWMAN_WORKERS) {
+      case 1:
+        // workers: 0
+        if (BWMAN_WEIGHTS.at(i).second == 0) {
+          if (sum_ww == 0) {
+            BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+            BWMAN_WEIGHTS_temp.at(i).first = round(s);
+          } else {
+            BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+            BWMAN_WEIGHTS_temp.at(i).first = round(
+                (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
+          }
+
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        } else {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        }
+        break;
+      case 2:
+        // workers: 0, 1
+        if (BWMAN_WEIGHTS.at(i).second == 0
+            || BWMAN_WEIGHTS.at(i).second == 1) {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        } else {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        }
+        break;
+      case 3:
+        // workers: 1,2,3
+        if (BWMAN_WEIGHTS.at(i).second == 1 || BWMAN_WEIGHTS.at(i).second == 2
+            || BWMAN_WEIGHTS.at(i).second == 3) {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        } else {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        }
+        break;
+      case 4:
+        // workers: 0,1,2,3
+        if (BWMAN_WEIGHTS.at(i).second == 0 || BWMAN_WEIGHTS.at(i).second == 1
+            || BWMAN_WEIGHTS.at(i).second == 2
+            || BWMAN_WEIGHTS.at(i).second == 3) {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        } else {
+          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
+          BWMAN_WEIGHTS_temp.at(i).first = round(
+              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
+          sum += BWMAN_WEIGHTS_temp.at(i).first;
+        }
+        break;
+      default:
+        LINFOF("Sorry, %d Worker nodes is not supported at the moment!\n",
+               BWMAN_WORKERS)
+        ;
+        exit(-1);
+    }
+  }
+
+  // sort the vector in ascending order just incase it gets unordered
+  sort(BWMAN_WEIGHTS_temp.begin(), BWMAN_WEIGHTS_temp.end());
+
+  /*printf("%.2f\n", sum);
+
+   printf("New Weights: \t");
+   for (i = 0; i < MAX_NODES; i++) {
+   printf("%d : %.2f\t", BWMAN_WEIGHTS_temp.at(i).second,
+   BWMAN_WEIGHTS_temp.at(i).first);
+   }
+   printf("\n");*/
+
+  if ((check_sum(BWMAN_WEIGHTS_temp)) != 100) {
+    printf("**Sum of New weights must be equal to 100, sum=%d!**\n",
+           check_sum(BWMAN_WEIGHTS_temp));
+    exit(-1);
+  }
+
+  /*printf(
+   "===========================================================================\n");*/
+}
+
+
+void build_page_array(void *start, unsigned long page_count, int pagesize,
+                      void **addr) {
+  char *pages = (char*) start;
+  for (unsigned long i = 0; i < page_count; i++) {
+    addr[i] = pages + i * pagesize;
+  }
+}
+
+// set the page distribution using a weighted version
+void build_node_array(const std::vector<std::pair<double, int>> &weights,
+                      unsigned long page_count, int *nodes) {
+  // incase the last page is not initialized
+  std::fill(nodes, nodes + page_count, 0);
+
+  double i_p;    // interleaved_pages
+  double w = 0;  // weight that has already been allocated among the nodes that
+                 // can still receive pages
+  int a = weights.size();  // number of nodes which can still receive pages
+  long i_k = 0;            // lower_bound for the pages
+  long r_pages = 0;        // remaining pages
+
+  // create a vector of node id's
+  std::vector<int> node_ids;
+  for (size_t i = 0; i < weights.size(); i++) {
+    node_ids.push_back(weights.at(i).second);
+  }
+
+  for (size_t i = 0; i < weights.size(); i++) {
+    double b = weights.at(i).first - w;
+    i_p = a * (b / 100) * page_count;
+
+    r_pages = page_count - i_k;
+    if (i_p > r_pages) {
+      i_p = r_pages;
+    }
+
+    if (i_k == (long) page_count) {
+      break;
+    }
+
+    if (i_p != 0) {
+      long upper_bound = i_k + i_p;
+      for (long j = i_k; j < upper_bound; j++) {
+        nodes[j] = node_ids[j % a];
+      }
+    }
+
+    node_ids.erase(node_ids.begin());
+    a--;
+    w = weights.at(i).first;
+    i_k += i_p;
+  }
+}
+
+long move_pages_batched(pid_t pid, unsigned long page_count, void **addr,
+                        const int *nodes, int *status, unsigned long batch,
+                        int flags) {
+  if (batch == 0) {
+    batch = page_count;
+  }
+  long not_moved = 0;
+  for (unsigned long i = 0; i < page_count; i += batch) {
+    long rc = move_pages(pid, std::min(batch, page_count - i), addr + i,
+                         nodes == NULL ? NULL : nodes + i, status + i, flags);
+    // ENOENT: nothing to move in this batch
+    if (rc < 0 && errno != ENOENT) {
+      return rc;
+    }
+    if (rc > 0) {
+      not_moved += rc;
+    }
+  }
+  return not_moved;
+}
@@ -6,6 +6,133 @@
  */
 #include "include/Logger.hpp"
 
+#include <sys/syscall.h>
+
+#include <algorithm>
+
 bwmanager::Logger Logger;
 bwmanager::Logger *L = &Logger;
 
+namespace bwmanager {
+
+static void stop_async_at_exit() {
+  L->stop_async();
+}
+
+void Logger::start_async(const std::string &binary_file) {
+  if (_async) {
+    return;
+  }
+  if (!binary_file.empty()) {
+    _binary = fopen(binary_file.c_str(), "w");
+    if (_binary == NULL) {
+      error(LFMT "Failed to open the binary log %s: %s", __FILENAME__,
+            __LINE__, __FUNCTION__, binary_file.c_str(), strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    BinaryLogHeader header = { BINARY_LOG_MAGIC, BINARY_LOG_VERSION, getpid() };
+    fwrite(&header, sizeof(header), 1, _binary);
+  }
+  _async = true;
+  _thread = std::thread(&Logger::run, this);
+  atexit(stop_async_at_exit);
+}
+
+void Logger::stop_async() {
+  if (!_async) {
+    return;
+  }
+  _async = false;
+  _thread.join();
+  flush();
+  if (_binary != NULL) {
+    fclose(_binary);
+    _binary = NULL;
+  }
+}
+
+const LogSite *Logger::register_site(LogLevel lvl, const char *fmt,
+                                     const char *file, int line,
+                                     const char *function) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  LogSite *site = new LogSite { lvl, fmt, file, line, function,
+      (uint32_t) _sites.size() };
+  _sites.push_back(site);
+  _sites_written.push_back(false);
+  return site;
+}
+
+LogRing *Logger::new_ring() {
+  LogRing *ring = new LogRing();
+  ring->tid = syscall(SYS_gettid);
+  std::lock_guard<std::mutex> lock(_mutex);
+  _rings.push_back(ring);
+  return ring;
+}
+
+void Logger::write_binary_site(const LogSite &site) {
+  BinaryLogSite entry = { site.id, site.level, site.line,
+      (uint16_t) strlen(site.fmt), (uint16_t) strlen(site.file),
+      (uint16_t) strlen(site.function), 0 };
+  uint32_t type = LOG_ENTRY_SITE;
+  fwrite(&type, sizeof(type), 1, _binary);
+  fwrite(&entry, sizeof(entry), 1, _binary);
+  fwrite(site.fmt, 1, entry.fmt_len, _binary);
+  fwrite(site.file, 1, entry.file_len, _binary);
+  fwrite(site.function, 1, entry.function_len, _binary);
+}
+
+void Logger::flush() {
+  uint64_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // the pending records of all threads, in time order
+    std::vector<LogRecord> records;
+    for (LogRing *ring : _rings) {
+      uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+      for (; tail != head; tail++) {
+        records.push_back(ring->records[tail % LOG_RING_SIZE]);
+      }
+      ring->tail.store(tail, std::memory_order_release);
+      dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const LogRecord &a, const LogRecord &b) {
+                       return a.time < b.time;
+                     });
+
+    int pid = getpid();
+    for (const LogRecord &r : records) {
+      const LogSite &site = *_sites[r.site];
+      if (_binary != NULL) {
+        if (!_sites_written[r.site]) {
+          write_binary_site(site);
+          _sites_written[r.site] = true;
+        }
+        uint32_t type = LOG_ENTRY_RECORD;
+        fwrite(&type, sizeof(type), 1, _binary);
+        fwrite(&r, sizeof(r), 1, _binary);
+      } else {
+        printf("%s\n", log_format_line(site, r, pid, true).c_str());
+      }
+    }
+    if (_binary != NULL) {
+      fflush(_binary);
+    }
+    fflush(stdout);
+  }
+  if (dropped > 0) {
+    log(LogLevel::WARN, LFMT "%" PRIu64 " log records dropped (full ring)",
+        __FILENAME__, __LINE__, __FUNCTION__, dropped);
+  }
+}
+
+void Logger::run() {
+  while (_async) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    flush();
+  }
+}
+
+}
@@ -1,10 +1,12 @@
 #include "include/MbaHandler.hpp"
 
 #include <fcntl.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "include/Logger.hpp"
@@ -37,6 +39,32 @@ const struct pqos_cap *p_cap = NULL;
 unsigned mba_id_count, *p_mba_ids = NULL;
 int ret;
 
+/**
+ * Valid MBA levels of the platform (ascending) and the bandwidth (MB/s)
+ * measured at each of them by the calibration kernel (0 = not calibrated)
+ */
+static std::vector<int> mba_levels;
+static std::vector<double> mba_bandwidth;
+// classes of service with MBA (COS0 is the default class)
+static unsigned num_mba_classes = 2;
+
+/**
+ * Calibration parameters: the buffer must be larger than the LLC, every
+ * level is streamed for calib_duration_ns and levels that do not gain at
+ * least calib_min_gain over the previous level are dropped
+ */
+static const size_t calib_buffer_size = 256UL << 20;
+static const long calib_duration_ns = 200000000;
+static const double calib_min_gain = 0.03;
+static volatile double calib_sink;
+
+/**
+ * L3 CAT capability, num_llc_ways is 0 if L3 CAT is not supported
+ */
+static unsigned num_llc_ways = 0;
+static const unsigned min_llc_ways = 2;
+unsigned l3cat_id_count, *p_l3cat_ids = NULL;
+
 void initialize_mba() {
   memset(&cfg, 0, sizeof(cfg));
   cfg.fd_log = STDOUT_FILENO;
@@ -61,6 +89,272 @@ void initialize_mba() {
   }
 
   LINFO("Success initializing PQoS library!");
+
+  discover_mba_levels();
+  discover_l3ca();
+}
+
+bool discover_l3ca() {
+  const struct pqos_capability *cap_l3ca = NULL;
+
+  if (p_cap == NULL
+      || pqos_cap_get_type(p_cap, PQOS_CAP_TYPE_L3CA, &cap_l3ca)
+          != PQOS_RETVAL_OK) {
+    LINFO("L3 CAT is not supported, LLC allocation disabled");
+    num_llc_ways = 0;
+    return false;
+  }
+  p_l3cat_ids = pqos_cpu_get_l3cat_ids(p_cpu, &l3cat_id_count);
+  if (p_l3cat_ids == NULL) {
+    LINFO("Error retrieving L3 CAT ID information!");
+    num_llc_ways = 0;
+    return false;
+  }
+
+  num_llc_ways = cap_l3ca->u.l3ca->num_ways;
+  LINFOF("L3 CAT capability: %u ways, %u classes, way size %u bytes",
+         num_llc_ways, cap_l3ca->u.l3ca->num_classes,
+         cap_l3ca->u.l3ca->way_size);
+  return true;
+}
+
+int set_l3ca_allocation(const unsigned socket_id, const unsigned cos_value,
+                        const unsigned ways) {
+  struct pqos_l3ca l3ca;
+
+  if (num_llc_ways == 0) {
+    LINFO("L3 CAT is not supported!");
+    return -1;
+  }
+
+  memset(&l3ca, 0, sizeof(l3ca));
+  l3ca.class_id = cos_value;
+  l3ca.cdp = 0;
+  l3ca.u.ways_mask = (ways >= 64) ? ~0ULL : ((1ULL << ways) - 1);
+
+  ret = pqos_l3ca_set(socket_id, 1, &l3ca);
+  if (ret != PQOS_RETVAL_OK) {
+    LINFO("Failed to set L3 CAT!");
+    return -1;
+  }
+  LINFOF("SKT%u: L3CA COS%u => %u ways, mask 0x%" PRIx64, socket_id, cos_value,
+         ways, (uint64_t) l3ca.u.ways_mask);
+
+  return 1;
+}
+
+int get_min_llc_ways() {
+  return num_llc_ways < min_llc_ways ? num_llc_ways : min_llc_ways;
+}
+
+int get_max_llc_ways() {
+  return num_llc_ways;
+}
+
+void set_llc_ways(unsigned ways) {
+  num_llc_ways = ways;
+}
+
+static int read_resctrl_value(const char *path) {
+  int value = -1;
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+    return -1;
+  if (fscanf(f, "%d", &value) != 1)
+    value = -1;
+  fclose(f);
+  return value;
+}
+
+void discover_mba_levels() {
+  unsigned min_mba = 0, step = 0, max_mba = 100;
+  const struct pqos_capability *cap_mba = NULL;
+
+  if (p_cap != NULL
+      && pqos_cap_get_type(p_cap, PQOS_CAP_TYPE_MBA, &cap_mba)
+          == PQOS_RETVAL_OK) {
+    step = cap_mba->u.mba->throttle_step;
+    max_mba = cap_mba->u.mba->throttle_max;
+    min_mba = step;
+    num_mba_classes = cap_mba->u.mba->num_classes;
+    LINFOF("pqos MBA capability: throttle_step %u%%, throttle_max %u%%, "
+           "linear %d, %u classes", step, max_mba, cap_mba->u.mba->is_linear,
+           num_mba_classes);
+  } else {
+    int gran = read_resctrl_value("/sys/fs/resctrl/info/MB/bandwidth_gran");
+    int min = read_resctrl_value("/sys/fs/resctrl/info/MB/min_bandwidth");
+    int closids = read_resctrl_value("/sys/fs/resctrl/info/MB/num_closids");
+    if (closids > 0)
+      num_mba_classes = closids;
+    if (gran > 0 && min > 0) {
+      step = gran;
+      min_mba = min;
+      LINFOF("resctrl MBA info: bandwidth_gran %u%%, min_bandwidth %u%%", step,
+             min_mba);
+    }
+  }
+
+  if (step == 0) {
+    LWARN("Unable to discover the MBA granularity, assuming steps of 10%");
+    step = 10;
+    min_mba = 10;
+  }
+  if (max_mba == 0 || max_mba > 100)
+    max_mba = 100;
+
+  mba_levels.clear();
+  for (unsigned level = min_mba; level < max_mba; level += step) {
+    mba_levels.push_back(level);
+  }
+  mba_levels.push_back(max_mba);
+  mba_bandwidth.assign(mba_levels.size(), 0);
+
+  LINFOF("Valid MBA levels: %lu (%d%% - %d%%, step %u%%)", mba_levels.size(),
+         get_min_mba(), get_max_mba(), step);
+}
+
+// stream through the buffer for calib_duration_ns and return MB/s
+static double stream_bandwidth(double *a, const double *b, size_t n) {
+  struct timespec start, now;
+  long elapsed;
+  double bytes = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  do {
+    for (size_t i = 0; i < n; i++) {
+      a[i] = b[i] + 1.0;
+    }
+    bytes += 2.0 * n * sizeof(double);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - start.tv_sec) * 1000000000L
+        + (now.tv_nsec - start.tv_nsec);
+  } while (elapsed < calib_duration_ns);
+  calib_sink = a[n / 2];
+
+  return bytes / ((double) elapsed / 1e9) / 1e6;
+}
+
+void calibrate_mba_levels(int core) {
+  unsigned old_cos = 0;
+  cpu_set_t old_mask, mask;
+
+  if (core < 0) {
+    LINFO("MBA calibration disabled, using the nominal MBA levels");
+    return;
+  }
+
+  // run the kernel on the given core, associated with the BE class (COS1)
+  sched_getaffinity(0, sizeof(old_mask), &old_mask);
+  CPU_ZERO(&mask);
+  CPU_SET(core, &mask);
+  if (sched_setaffinity(0, sizeof(mask), &mask) != 0
+      || pqos_alloc_assoc_get(core, &old_cos) != PQOS_RETVAL_OK
+      || pqos_alloc_assoc_set(core, 1) != PQOS_RETVAL_OK) {
+    LWARNF("Unable to associate core %d with COS1, skipping MBA calibration",
+           core);
+    sched_setaffinity(0, sizeof(old_mask), &old_mask);
+    return;
+  }
+
+  size_t n = calib_buffer_size / 2 / sizeof(double);
+  double *a = (double *) malloc(n * sizeof(double));
+  double *b = (double *) malloc(n * sizeof(double));
+  if (a == NULL || b == NULL) {
+    LINFO("Unable to allocate memory");
+    exit(EXIT_FAILURE);
+  }
+  memset(a, 0, n * sizeof(double));
+  memset(b, 0, n * sizeof(double));
+
+  LINFOF("Calibrating %lu MBA levels on core %d", mba_levels.size(), core);
+  for (size_t i = 0; i < mba_levels.size(); i++) {
+    set_mba_parameters(1, mba_levels.at(i));
+    set_mba_allocation(0);
+    mba_bandwidth.at(i) = stream_bandwidth(a, b, n);
+    LINFOF("MBA %3d%% => %.0lf MB/s", mba_levels.at(i), mba_bandwidth.at(i));
+  }
+
+  // leave the BE class unthrottled and restore the calibration core
+  set_mba_parameters(1, get_max_mba());
+  set_mba_allocation(0);
+  pqos_alloc_assoc_set(core, old_cos);
+  sched_setaffinity(0, sizeof(old_mask), &old_mask);
+  free(a);
+  free(b);
+
+  // keep only the levels that actually change the bandwidth (always keep the
+  // maximum level, so that MBA can be released completely)
+  std::vector<int> levels;
+  std::vector<double> bandwidth;
+  for (size_t i = 0; i < mba_levels.size(); i++) {
+    if (levels.empty() || i == mba_levels.size() - 1
+        || mba_bandwidth.at(i) > bandwidth.back() * (1 + calib_min_gain)) {
+      levels.push_back(mba_levels.at(i));
+      bandwidth.push_back(mba_bandwidth.at(i));
+    } else {
+      LINFOF("Dropping MBA level %d%% (%.0lf MB/s, no gain over %d%%)",
+             mba_levels.at(i), mba_bandwidth.at(i), levels.back());
+    }
+  }
+  mba_levels = levels;
+  mba_bandwidth = bandwidth;
+}
+
+const std::vector<int>& get_mba_levels() {
+  return mba_levels;
+}
+
+/*
+ * Bandwidth of the highest valid level not above mba_value, or the level
+ * itself when the calibration did not run (a proportional estimate)
+ */
+double get_mba_bandwidth(int mba_value) {
+  double bw = 0;
+  int level = get_min_mba();
+  for (size_t i = 0; i < mba_levels.size(); i++) {
+    if (mba_levels.at(i) <= mba_value) {
+      bw = mba_bandwidth.at(i);
+      level = mba_levels.at(i);
+    }
+  }
+  return bw > 0 ? bw : level;
+}
+
+void set_mba_levels(const std::vector<int> &levels,
+                    const std::vector<double> &bandwidth) {
+  mba_levels = levels;
+  mba_bandwidth = bandwidth;
+  mba_bandwidth.resize(mba_levels.size(), 0);
+}
+
+int get_num_mba_classes() {
+  return num_mba_classes;
+}
+
+int get_min_mba() {
+  return mba_levels.empty() ? 10 : mba_levels.front();
+}
+
+int get_max_mba() {
+  return mba_levels.empty() ? 100 : mba_levels.back();
+}
+
+// the next valid level above mba_value (or the maximum level)
+int get_next_mba(int mba_value) {
+  for (size_t i = 0; i < mba_levels.size(); i++) {
+    if (mba_levels.at(i) > mba_value)
+      return mba_levels.at(i);
+  }
+  return get_max_mba();
+}
+
+// the previous valid level below mba_value (or the minimum level)
+int get_prev_mba(int mba_value) {
+  for (size_t i = mba_levels.size(); i > 0; i--) {
+    if (mba_levels.at(i - 1) < mba_value)
+      return mba_levels.at(i - 1);
+  }
+  return get_min_mba();
 }
 
 int set_mba_allocation(const unsigned socket_id) {
@@ -83,9 +377,12 @@ void set_mba_parameters(const unsigned cos_value, const uint64_t mba_value) {
 }
 
 void reset_mba() {
-  /*set mba back to 100 i.e. default before quitting*/
-  set_mba_parameters(1, 100);
+  /*set mba back to the maximum i.e. default before quitting*/
+  set_mba_parameters(1, get_max_mba());
   ret = set_mba_allocation(0);
+  /*give the whole LLC back to the BE class*/
+  if (num_llc_ways != 0)
+    set_l3ca_allocation(0, 1, num_llc_ways);
   /* reset and deallocate all the resources */
   ret = pqos_fini();
   if (ret != PQOS_RETVAL_OK) {
@@ -95,4 +392,6 @@ void reset_mba() {
   }
   if (p_mba_ids != NULL)
     free(p_mba_ids);
+  if (p_l3cat_ids != NULL)
+    free(p_l3cat_ids);
 }
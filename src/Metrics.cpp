@@ -0,0 +1,399 @@
+/*
+ * Metrics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Metrics.hpp"
+
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/ControlServer.hpp"
+#include "include/Histogram.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+#include "include/Profiler.hpp"
+#include "include/Tenants.hpp"
+#include "include/Utilities.hpp"
+
+using boost::asio::ip::tcp;
+
+// time a client has to send its request and read the response (ms)
+#define REQUEST_TIMEOUT_MS 2000
+// largest request headers
+#define MAX_REQUEST_SIZE 8192
+
+extern double current_latency;
+extern double current_latency_xpn;
+extern double slack;
+extern double slack_xpn;
+extern int violations_counter_f;
+extern int violations_counter_t;
+extern int vlts_cnt_f;
+extern int vlts_cnt_t;
+
+extern useconds_t sleeptime;
+
+static std::atomic<uint32_t> snapshot_seq(0);
+static MetricsSnapshot snapshot;
+
+static std::atomic<uint64_t> migrated_pages(0);
+static std::atomic<uint64_t> migrated_bytes(0);
+static std::atomic<uint64_t> migrations(0);
+static std::atomic<double> migration_pages_per_sec(0);
+static std::atomic<double> migration_bytes_per_sec(0);
+
+static const char *sources[] = { "memcached", "xapian" };
+
+void metrics_publish() {
+  uint32_t seq = snapshot_seq.load(std::memory_order_relaxed);
+  snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  MetricsSnapshot &s = snapshot;
+  s.mode = bwman_mode_value;
+  s.paused = control_paused();
+  s.target_slo[0] = target_slo;
+  s.target_slo[1] = target_slo_xapian;
+  s.latency[0] = current_latency;
+  s.latency[1] = current_latency_xpn;
+  s.slack[0] = slack;
+  s.slack[1] = slack_xpn;
+  s.violations_slack[0] = violations_counter_f;
+  s.violations_slack[1] = vlts_cnt_f;
+  s.violations_target[0] = violations_counter_t;
+  s.violations_target[1] = vlts_cnt_t;
+  s.remote_ratio = current_remote_ratio;
+  s.mba = optimal_mba;
+  s.llc_ways = optimal_llc_ways;
+  s.period_ms = sleeptime / 1000;
+  s.segments = mem_segments.size();
+  s.num_cos = std::min(get_num_mba_classes(), METRICS_MAX_COS);
+  for (int cos = 0; cos < s.num_cos; cos++) {
+    s.cos_mba[cos] = actuator_get(ACT_MBA, 0, cos);
+  }
+  s.bes_total = be_processes.size();
+  s.num_bes = std::min((int) be_processes.size(), METRICS_MAX_BES);
+  for (int i = 0; i < s.num_bes; i++) {
+    const BeProcess &be = be_processes[i];
+    s.bes[i] = {be.pid, (int32_t) be.cos, be.mba, be.ratio, be.bandwidth,
+      be.local_bandwidth};
+  }
+  s.iterations++;
+
+  snapshot_seq.store(seq + 2, std::memory_order_release);
+}
+
+void metrics_record_migration(uint64_t pages, uint64_t bytes, uint64_t nsec) {
+  migrated_pages += pages;
+  migrated_bytes += bytes;
+  migrations++;
+  if (nsec != 0) {
+    migration_pages_per_sec = pages * 1e9 / nsec;
+    migration_bytes_per_sec = bytes * 1e9 / nsec;
+  }
+}
+
+void metrics_read_snapshot(MetricsSnapshot *s) {
+  for (;;) {
+    uint32_t seq = snapshot_seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    memcpy(s, &snapshot, sizeof(*s));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (snapshot_seq.load(std::memory_order_relaxed) == seq) {
+      return;
+    }
+  }
+}
+
+static void header(std::string &out, const char *name, const char *type,
+                   const char *help) {
+  out += std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " "
+      + type + "\n";
+}
+
+static void sample(std::string &out, const char *name, const char *labels,
+                   double value) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s%s %.10g\n", name, labels, value);
+  out += buf;
+}
+
+// the samples of a histogram of nsec, in seconds, with more labels (e.g.
+// "section=\"iteration\",") before le
+static void histogram_samples(std::string &out, const char *name,
+                              const char *more_labels, const Histogram &h) {
+  char labels[128];
+  int last = 0;
+  for (int i = 0; i < Histogram::NUM_BUCKETS; i++) {
+    if (h.bucket(i) != 0) {
+      last = i;
+    }
+  }
+  uint64_t cumulative = 0;
+  for (int i = 0; i <= last; i++) {
+    cumulative += h.bucket(i);
+    snprintf(labels, sizeof(labels), "{%sle=\"%.9g\"}", more_labels,
+             Histogram::bucket_bound(i) / 1e9);
+    sample(out, (std::string(name) + "_bucket").c_str(), labels, cumulative);
+  }
+  uint64_t count = h.count();
+  snprintf(labels, sizeof(labels), "{%sle=\"+Inf\"}", more_labels);
+  sample(out, (std::string(name) + "_bucket").c_str(), labels,
+         std::max(count, cumulative));
+  // the other labels without the trailing comma
+  std::string rest(more_labels);
+  if (!rest.empty()) {
+    rest = "{" + rest.substr(0, rest.size() - 1) + "}";
+  }
+  sample(out, (std::string(name) + "_sum").c_str(), rest.c_str(),
+         h.sum() / 1e9);
+  sample(out, (std::string(name) + "_count").c_str(), rest.c_str(),
+         std::max(count, cumulative));
+}
+
+// a histogram of nsec, in seconds
+static void histogram(std::string &out, const char *name, const char *help,
+                      const Histogram &h) {
+  header(out, name, "histogram", help);
+  histogram_samples(out, name, "", h);
+}
+
+static std::string render_metrics() {
+  MetricsSnapshot s;
+  metrics_read_snapshot(&s);
+  std::string out;
+  char labels[128];
+
+  header(out, "bwman_mode", "gauge", "Controller mode (BWMAN_MODE)");
+  sample(out, "bwman_mode", "", s.mode);
+  header(out, "bwman_paused", "gauge", "1 if the controller is paused");
+  sample(out, "bwman_paused", "", s.paused);
+  header(out, "bwman_iterations_total", "counter",
+         "Iterations of the control loop");
+  sample(out, "bwman_iterations_total", "", s.iterations);
+
+  header(out, "bwman_latency_p99", "gauge",
+         "p99 latency of the LC source (memcached: us, xapian: ms)");
+  for (int i = 0; i < 2; i++) {
+    snprintf(labels, sizeof(labels), "{source=\"%s\"}", sources[i]);
+    sample(out, "bwman_latency_p99", labels, s.latency[i]);
+  }
+  header(out, "bwman_slo_target", "gauge",
+         "SLO target of the LC source (same unit as the latency)");
+  for (int i = 0; i < 2; i++) {
+    snprintf(labels, sizeof(labels), "{source=\"%s\"}", sources[i]);
+    sample(out, "bwman_slo_target", labels, s.target_slo[i]);
+  }
+  header(out, "bwman_slack", "gauge",
+         "Slack of the LC source, (target - latency) / target");
+  for (int i = 0; i < 2; i++) {
+    snprintf(labels, sizeof(labels), "{source=\"%s\"}", sources[i]);
+    sample(out, "bwman_slack", labels, s.slack[i]);
+  }
+  header(out, "bwman_slo_violations_total", "counter",
+         "Samples with the slack below its margin (kind=slack) or the "
+         "latency above the target (kind=target)");
+  for (int i = 0; i < 2; i++) {
+    snprintf(labels, sizeof(labels), "{source=\"%s\",kind=\"slack\"}",
+             sources[i]);
+    sample(out, "bwman_slo_violations_total", labels, s.violations_slack[i]);
+    snprintf(labels, sizeof(labels), "{source=\"%s\",kind=\"target\"}",
+             sources[i]);
+    sample(out, "bwman_slo_violations_total", labels, s.violations_target[i]);
+  }
+
+  header(out, "bwman_mba_level", "gauge",
+         "MBA level applied to a class of service (%)");
+  for (int cos = 0; cos < s.num_cos; cos++) {
+    if (s.cos_mba[cos] != -1) {
+      snprintf(labels, sizeof(labels), "{socket=\"0\",cos=\"%d\"}", cos);
+      sample(out, "bwman_mba_level", labels, s.cos_mba[cos]);
+    }
+  }
+  header(out, "bwman_target_mba_level", "gauge",
+         "MBA level chosen by the controller (%)");
+  sample(out, "bwman_target_mba_level", "", s.mba);
+  header(out, "bwman_llc_ways", "gauge", "L3 ways of the BE class");
+  sample(out, "bwman_llc_ways", "", s.llc_ways);
+  header(out, "bwman_remote_ratio", "gauge",
+         "Share of the BE pages placed off the HP node (%)");
+  sample(out, "bwman_remote_ratio", "", s.remote_ratio);
+
+  header(out, "bwman_be_remote_ratio", "gauge",
+         "Share of the pages of a BE placed off the HP node (%)");
+  for (int i = 0; i < s.num_bes; i++) {
+    snprintf(labels, sizeof(labels), "{pid=\"%d\",cos=\"%d\"}", s.bes[i].pid,
+             s.bes[i].cos);
+    sample(out, "bwman_be_remote_ratio", labels, s.bes[i].ratio);
+  }
+  header(out, "bwman_be_mba_level", "gauge", "MBA level of a BE (%)");
+  for (int i = 0; i < s.num_bes; i++) {
+    snprintf(labels, sizeof(labels), "{pid=\"%d\",cos=\"%d\"}", s.bes[i].pid,
+             s.bes[i].cos);
+    sample(out, "bwman_be_mba_level", labels, s.bes[i].mba);
+  }
+  header(out, "bwman_be_bandwidth_bytes", "gauge",
+         "Memory bandwidth of a BE (bytes/s), total and to the HP node");
+  for (int i = 0; i < s.num_bes; i++) {
+    snprintf(labels, sizeof(labels), "{pid=\"%d\",to=\"all\"}", s.bes[i].pid);
+    sample(out, "bwman_be_bandwidth_bytes", labels, s.bes[i].bandwidth * 1e6);
+    snprintf(labels, sizeof(labels), "{pid=\"%d\",to=\"hp\"}", s.bes[i].pid);
+    sample(out, "bwman_be_bandwidth_bytes", labels,
+           s.bes[i].local_bandwidth * 1e6);
+  }
+
+  header(out, "bwman_migrations_total", "counter", "Page placements");
+  sample(out, "bwman_migrations_total", "", migrations);
+  header(out, "bwman_migrated_pages_total", "counter",
+         "Pages passed to move_pages");
+  sample(out, "bwman_migrated_pages_total", "", migrated_pages);
+  header(out, "bwman_migrated_bytes_total", "counter",
+         "Bytes passed to move_pages");
+  sample(out, "bwman_migrated_bytes_total", "", migrated_bytes);
+  header(out, "bwman_migration_pages_per_second", "gauge",
+         "Pages per second of the last page placement");
+  sample(out, "bwman_migration_pages_per_second", "", migration_pages_per_sec);
+  header(out, "bwman_migration_bytes_per_second", "gauge",
+         "Bytes per second of the last page placement");
+  sample(out, "bwman_migration_bytes_per_second", "", migration_bytes_per_sec);
+
+  histogram(out, "bwman_actuation_latency_seconds",
+            "Time of a hardware write (MBA, LLC)",
+            get_actuation_histogram());
+  histogram(out, "bwman_loop_iteration_seconds",
+            "Time between two iterations of the control loop",
+            profile_stats(PROF_ITERATION).wall);
+
+  header(out, "bwman_cpu_seconds_total", "counter",
+         "CPU time of the manager (user + sys)");
+  sample(out, "bwman_cpu_seconds_total", "", profile_process_cpu() / 1e9);
+  header(out, "bwman_profile_wall_seconds", "histogram",
+         "Wall time of a section of the controller");
+  for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+    snprintf(labels, sizeof(labels), "section=\"%s\",",
+             profile_section_name((profile_section) i));
+    histogram_samples(out, "bwman_profile_wall_seconds", labels,
+                      profile_stats((profile_section) i).wall);
+  }
+  header(out, "bwman_profile_cpu_seconds", "histogram",
+         "CPU time of the thread that ran a section of the controller");
+  for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+    snprintf(labels, sizeof(labels), "section=\"%s\",",
+             profile_section_name((profile_section) i));
+    histogram_samples(out, "bwman_profile_cpu_seconds", labels,
+                      profile_stats((profile_section) i).cpu);
+  }
+  return out;
+}
+
+// wait until the socket is ready for events, false past the deadline
+static bool wait_ready(tcp::socket &socket, short events,
+                       std::chrono::steady_clock::time_point deadline) {
+  long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+  if (remaining <= 0) {
+    return false;
+  }
+  struct pollfd pfd = { socket.native_handle(), events, 0 };
+  return poll(&pfd, 1, remaining) == 1;
+}
+
+// one request per connection, GET /metrics only; a client has
+// REQUEST_TIMEOUT_MS to send it and take the response, a stalled one does
+// not hold the server
+static void serve(tcp::socket &socket) {
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now()
+          + std::chrono::milliseconds(REQUEST_TIMEOUT_MS);
+  boost::system::error_code error;
+  socket.non_blocking(true, error);
+  if (error) {
+    return;
+  }
+
+  std::string request;
+  while (request.find("\r\n\r\n") == std::string::npos) {
+    if (request.size() > MAX_REQUEST_SIZE
+        || !wait_ready(socket, POLLIN, deadline)) {
+      return;
+    }
+    char chunk[1024];
+    size_t n = socket.read_some(boost::asio::buffer(chunk), error);
+    if (error && error != boost::asio::error::would_block) {
+      return;
+    }
+    request.append(chunk, n);
+  }
+  std::istringstream is(request);
+  std::string method, path;
+  is >> method >> path;
+
+  std::string status = "200 OK";
+  std::string body;
+  if (method != "GET") {
+    status = "405 Method Not Allowed";
+  } else if (path == "/metrics") {
+    body = render_metrics();
+  } else {
+    status = "404 Not Found";
+  }
+  std::string response = "HTTP/1.1 " + status
+      + "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+      + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+  size_t sent = 0;
+  while (sent < response.size()) {
+    if (!wait_ready(socket, POLLOUT, deadline)) {
+      return;
+    }
+    sent += socket.write_some(
+        boost::asio::buffer(response.data() + sent, response.size() - sent),
+        error);
+    if (error && error != boost::asio::error::would_block) {
+      return;
+    }
+  }
+}
+
+static void metrics_server(int tcp_port) {
+  try {
+    boost::asio::io_service io_service;
+    tcp::acceptor acceptor(
+        io_service,
+        tcp::endpoint(boost::asio::ip::address_v4::loopback(), tcp_port));
+    LINFOF("Metrics on http://127.0.0.1:%d/metrics", tcp_port);
+
+    for (;;) {
+      tcp::socket socket(io_service);
+      acceptor.accept(socket);
+      serve(socket);
+    }
+  } catch (std::exception &e) {
+    LWARNF("Metrics port %d: %s", tcp_port, e.what());
+  }
+}
+
+void start_metrics_server() {
+  if (metrics_port == 0) {
+    return;
+  }
+  std::thread t(metrics_server, metrics_port);
+  // do not wait it to finish
+  t.detach();
+}
@@ -7,185 +7,18 @@
 
 #include "include/PagePlacement.hpp"
 
+#include <algorithm>
 #include <numeric>  //vector sum
 
 #include "include/BwManager.hpp"
 #include "include/Logger.hpp"
+#include "include/Metrics.hpp"
+#include "include/Profiler.hpp"
+#include "include/Timeline.hpp"
 
 static int pagesize;
 // bool weight_initialized = false;
 
-// temporary vector of weights initialized to zero
-std::vector<std::pair<double, int>> BWMAN_WEIGHTS_temp(MAX_NODES,
-                                                       std::make_pair(0, 0));
-
-int check_sum(std::vector<std::pair<double, int>> n) {
-  double sum = 0;
-  int i = 0;
-
-  for (i = 0; i < MAX_NODES; i++) {
-    sum += n.at(i).first;
-  }
-  return std::lround(sum);
-}
-
-// Calculate the new weights with respect to the new ratio (not considering
-// sum_ww & sum_nww)!
-void get_new_weights_v2(double s) {
-  int i = 0;
-  double sum = 0;
-
-  for (i = 0; i < MAX_NODES; i++) {
-    switch (BWMAN_WORKERS) {
-      case 1:
-        // workers: 0
-        if (BWMAN_WEIGHTS.at(i).second == 0) {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(BWMAN_WEIGHTS.at(i).first - s);
-
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        } else {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(s);
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        }
-        break;
-      default:
-        LINFOF("Sorry, %d Worker nodes is not supported at the moment!\n",
-               BWMAN_WORKERS)
-        ;
-        exit(-1);
-    }
-  }
-
-  // sort the vector in ascending order just incase it gets unordered
-  sort(BWMAN_WEIGHTS_temp.begin(), BWMAN_WEIGHTS_temp.end());
-
-  printf("%.2f\n", sum);
-
-  printf("New Weights: \t");
-  for (i = 0; i < MAX_NODES; i++) {
-    printf("%d : %.2f\t", BWMAN_WEIGHTS_temp.at(i).second,
-           BWMAN_WEIGHTS_temp.at(i).first);
-  }
-  printf("\n");
-
-  if ((check_sum(BWMAN_WEIGHTS_temp)) != 100) {
-    printf("**Sum of New weights must be equal to 100, sum=%d!**\n",
-           check_sum(BWMAN_WEIGHTS_temp));
-    exit(-1);
-  }
-
-  printf(
-      "========================================================================"
-      "===\n");
-}
-
-// Calculate the new weights with respect to the new ratio!
-void get_new_weights(double s) {
-  int i = 0;
-  double new_s = 0;
-  new_s = sum_ww + s;
-  double sum = 0;
-
-  for (i = 0; i < MAX_NODES; i++) {
-    switch (BWMAN_WORKERS) {
-      case 1:
-        // workers: 0
-        if (BWMAN_WEIGHTS.at(i).second == 0) {
-          if (sum_ww == 0) {
-            BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-            BWMAN_WEIGHTS_temp.at(i).first = round(s);
-          } else {
-            BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-            BWMAN_WEIGHTS_temp.at(i).first = round(
-                (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
-          }
-
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        } else {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        }
-        break;
-      case 2:
-        // workers: 0, 1
-        if (BWMAN_WEIGHTS.at(i).second == 0
-            || BWMAN_WEIGHTS.at(i).second == 1) {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        } else {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        }
-        break;
-      case 3:
-        // workers: 1,2,3
-        if (BWMAN_WEIGHTS.at(i).second == 1 || BWMAN_WEIGHTS.at(i).second == 2
-            || BWMAN_WEIGHTS.at(i).second == 3) {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        } else {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        }
-        break;
-      case 4:
-        // workers: 0,1,2,3
-        if (BWMAN_WEIGHTS.at(i).second == 0 || BWMAN_WEIGHTS.at(i).second == 1
-            || BWMAN_WEIGHTS.at(i).second == 2
-            || BWMAN_WEIGHTS.at(i).second == 3) {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_ww * new_s) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        } else {
-          BWMAN_WEIGHTS_temp.at(i).second = BWMAN_WEIGHTS.at(i).second;
-          BWMAN_WEIGHTS_temp.at(i).first = round(
-              (BWMAN_WEIGHTS.at(i).first / sum_nww * (100 - new_s)) * 10) / 10;
-          sum += BWMAN_WEIGHTS_temp.at(i).first;
-        }
-        break;
-      default:
-        LINFOF("Sorry, %d Worker nodes is not supported at the moment!\n",
-               BWMAN_WORKERS)
-        ;
-        exit(-1);
-    }
-  }
-
-  // sort the vector in ascending order just incase it gets unordered
-  sort(BWMAN_WEIGHTS_temp.begin(), BWMAN_WEIGHTS_temp.end());
-
-  /*printf("%.2f\n", sum);
-
-   printf("New Weights: \t");
-   for (i = 0; i < MAX_NODES; i++) {
-   printf("%d : %.2f\t", BWMAN_WEIGHTS_temp.at(i).second,
-   BWMAN_WEIGHTS_temp.at(i).first);
-   }
-   printf("\n");*/
-
-  if ((check_sum(BWMAN_WEIGHTS_temp)) != 100) {
-    printf("**Sum of New weights must be equal to 100, sum=%d!**\n",
-           check_sum(BWMAN_WEIGHTS_temp));
-    exit(-1);
-  }
-
-  /*printf(
-   "===========================================================================\n");*/
-}
-
 // debugging function
 void get_node_mappings(int page_count, int *nodes) {
   // Test weights are reflected on the node mappings!
@@ -225,18 +58,49 @@ void get_node_mappings(int page_count, int *nodes) {
   printf("Total Weight: %.2f\n", sum);
 }
 
-void place_all_pages(std::vector<MySharedMemory> mem_segments, double r) {
-  // get_new_weights(r);
-  get_new_weights_v2(r);
+// the pages of every segment interleaved by the weights (ascending)
+static void place_segments(const std::vector<MySharedMemory> &mem_segments,
+                           const std::vector<std::pair<double, int>> &weights) {
+  struct timespec start, stop;
+  uint64_t bytes = 0;
+  for (const MySharedMemory &segment : mem_segments) {
+    bytes += segment.pageAlignedLength;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
 #pragma omp parallel for
   for (size_t i = 0; i < mem_segments.size(); i++) {
+    TimelineSpan span("placement", "move_pages", { { "pid", mem_segments.at(i)
+        .processID }, { "pages", mem_segments.at(i).pageAlignedLength
+        / numa_pagesize() } });
+    ProfileScope scope(PROF_MIGRATION);
     move_pages_remote(mem_segments.at(i).processID,
                       mem_segments.at(i).pageAlignedStartAddress,
-                      mem_segments.at(i).pageAlignedLength, r);
+                      mem_segments.at(i).pageAlignedLength, weights);
   }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  metrics_record_migration(
+      bytes / numa_pagesize(), bytes,
+      (stop.tv_sec - start.tv_sec) * 1000000000ULL + stop.tv_nsec
+          - start.tv_nsec);
+}
+
+void place_all_pages(std::vector<MySharedMemory> mem_segments, double r) {
+  // get_new_weights(r);
+  get_new_weights_v2(r);
+  place_segments(mem_segments, BWMAN_WEIGHTS_temp);
   // weight_initialized = false;
 }
 
+void place_all_pages(std::vector<MySharedMemory> mem_segments,
+                     const std::vector<double> &weights) {
+  std::vector<std::pair<double, int>> by_node;
+  for (size_t i = 0; i < weights.size(); i++) {
+    by_node.push_back(std::make_pair(weights[i], (int) i));
+  }
+  std::sort(by_node.begin(), by_node.end());
+  place_segments(mem_segments, by_node);
+}
+
 // initial page placement with weighted interleave
 /*void place_all_pages(std::vector<MySharedMemory> mem_segments) {
  for (size_t i = 0; i < mem_segments.size(); i++) {
@@ -333,13 +197,9 @@ void place_all_pages(std::vector<MySharedMemory> mem_segments, double r) {
 
 // initial page placement with weighted interleave
 void move_pages_remote(pid_t pid, void *start, unsigned long len,
-                       double remote_ratio) {
+                       const std::vector<std::pair<double, int>> &weights) {
   pagesize = numa_pagesize();
 
-  char *pages;
-
-  int i, j, rc;
-
   void **addr;
   int *status;
   int *nodes;
@@ -355,82 +215,14 @@ void move_pages_remote(pid_t pid, void *start, unsigned long len,
     exit(1);
   }
 
-  pages = (char *) start;
-
   // uniform distribution memory allocation (using the bwap style format)
-  // first set the page addresses, openmp for faster processing
-  //#pragma omp parallel for firstprivate(pages,pagesize)
-  for (i = 0; i < page_count; i++) {
-    addr[i] = pages + i * pagesize;
-    nodes[i] = 0;  // incase the last page is not initialized
-  }
-
-  // set the page distribution using a weighted version
-  double i_p;    // interleaved_pages
-  double w = 0;  // weight that has already been allocated among the nodes that
-                 // can still receive pages
-  int a = MAX_NODES;  // number of nodes which can still receive pages
-  int i_k = 0;        // lower_bound for the pages
-  int r_pages = 0;    // remaining pages
-  int my_node;        // the node of a page
-
-  // create a vector of node id's
-  std::vector<int> node_ids;
-  for (i = 0; i < MAX_NODES; i++) {
-    node_ids.push_back(BWMAN_WEIGHTS_temp.at(i).second);
-  }
-
-  for (i = 0; i < MAX_NODES; i++) {
-    double b = BWMAN_WEIGHTS_temp.at(i).first - w;
-    i_p = a * (b / 100) * page_count;
-
-    r_pages = page_count - i_k;
-    if (i_p > r_pages) {
-      i_p = r_pages;
-    }
-
-    /*for (int k = 0; k < a; k++) {
-     printf("node id: %d\t", node_ids.at(k));
-     }
-     printf("\n");
-
-     printf("i: %d b: %.2f i_p: %.2f i_k: %d end: %d a: %d r_pages: %d\n", i, b,
-     i_p, i_k, (i_k + (int) i_p), a, r_pages);*/
-
-    if (i_k == page_count) {
-      break;
-    }
-
-    if (i_p != 0) {
-      int upper_bound = i_k + i_p;
-      //#pragma omp parallel for firstprivate(my_node,a)
-      for (j = i_k; j < upper_bound; j++) {
-        my_node = j % a;
-        nodes[j] = node_ids.at(my_node);
-      }
-    }
-
-    node_ids.erase(node_ids.begin());
-    a--;
-    w = BWMAN_WEIGHTS_temp.at(i).first;
-    i_k += i_p;
-  }
-
-  /*for (i = 0; i < page_count; i++) {
-   printf("%d: %d\n", i, nodes[i]);
-   }*/
-
-  /*for (i = 0; i < page_count; i++) {
-   if (nodes[i] < 0 || nodes[i] > MAX_NODES) {
-   printf("Page %d node %d", i, nodes[i]);
-   exit(1);
-   }
-   }*/
+  build_page_array(start, page_count, pagesize, addr);
+  build_node_array(weights, page_count, nodes);
 
   // get_node_mappings(page_count, nodes);
-  rc = move_pages(pid, page_count, addr, nodes, status, MPOL_MF_MOVE_ALL);
-  //rc = numa_move_pages(pid, page_count, addr, nodes, status, MPOL_MF_MOVE_ALL);
-  if (rc < 0 && errno != ENOENT) {
+  long rc = move_pages_batched(pid, page_count, addr, nodes, status, 0,
+                               MPOL_MF_MOVE_ALL);
+  if (rc < 0) {
     perror("move_pages");
     // exit(EXIT_FAILURE);
     std::terminate();
@@ -440,3 +232,49 @@ void move_pages_remote(pid_t pid, void *start, unsigned long len,
   free(status);
   free(nodes);
 }
+
+// where the pages are, queried with move_pages (no nodes, no move)
+double get_remote_ratio(const std::vector<MySharedMemory> &mem_segments,
+                        int max_samples) {
+  pagesize = numa_pagesize();
+
+  unsigned long total_pages = 0;
+  for (size_t i = 0; i < mem_segments.size(); i++) {
+    total_pages += mem_segments.at(i).pageAlignedLength / pagesize;
+  }
+  if (total_pages == 0) {
+    return -1;
+  }
+  // every stride-th page of every segment
+  unsigned long stride = std::max(total_pages / max_samples, 1UL);
+
+  long resident = 0, remote = 0;
+  for (size_t i = 0; i < mem_segments.size(); i++) {
+    const MySharedMemory &segment = mem_segments.at(i);
+    std::vector<void*> addr;
+    for (unsigned long p = 0; p < segment.pageAlignedLength / pagesize;
+        p += stride) {
+      addr.push_back((char*) segment.pageAlignedStartAddress + p * pagesize);
+    }
+    if (addr.empty()) {
+      continue;
+    }
+    std::vector<int> status(addr.size());
+    if (move_pages(segment.processID, addr.size(), addr.data(), NULL,
+                   status.data(), 0) < 0) {
+      continue;
+    }
+    for (size_t j = 0; j < status.size(); j++) {
+      // not resident (-ENOENT) or gone
+      if (status.at(j) < 0) {
+        continue;
+      }
+      resident++;
+      // only a single worker node is supported (see get_new_weights_v2)
+      if (status.at(j) != 0) {
+        remote++;
+      }
+    }
+  }
+  return resident == 0 ? -1 : 100.0 * remote / resident;
+}
@@ -6,7 +6,12 @@
  */
 #include "include/PerformanceCounters.hpp"
 
-static bool initiatialized = false;
+#include <atomic>
+
+#include "include/Plant.hpp"
+
+// set last, read by the controller while the control socket sets it up
+static std::atomic<bool> initiatialized(false);
 
 /*
  * A function that uses the likwid library to measure the stall rates
@@ -79,15 +84,18 @@ void stop_counters() {
   }
 }
 
-void initialize_likwid() {
+/*
+ * false if the counters cannot be set up (everything undone, may be called
+ * again), the manager keeps running without the stall rates
+ */
+bool initialize_likwid() {
   if (!initiatialized) {
     // perfmon_setVerbosity(3);
     // Load the topology module and print some values.
     err = topology_init();
     if (err < 0) {
-      LDEBUG("Failed to initialize LIKWID's topology module\n");
-      // return 1;
-      exit(-1);
+      LWARN("Failed to initialize LIKWID's topology module");
+      return false;
     }
     // CpuInfo_t contains global information like name, CPU family, ...
     // CpuInfo_t info = get_cpuInfo();
@@ -117,16 +125,20 @@ void initialize_likwid() {
     // for now only monitor one CPU
     cpus = (int *) malloc(active_cpus * sizeof(int));
 
-    if (!cpus)
-      exit(-1);  // return 1;
+    if (!cpus) {
+      topology_finalize();
+      return false;
+    }
 
     // set the monitoring core
     for (int i = 0; i < active_cpus; i++) {
       // check if the specified core is valid!
       if (BWMAN_CORES.at(i) >= ncpus) {
-        LINFOF("%d is an invalid CPU, valid cpus: 0-%d", BWMAN_CORES.at(i),
+        LWARNF("%d is an invalid CPU, valid cpus: 0-%d", BWMAN_CORES.at(i),
                ncpus - 1);
-        exit(EXIT_FAILURE);
+        free(cpus);
+        topology_finalize();
+        return false;
       }
       cpus[i] = BWMAN_CORES.at(i);
       // cpus[i] = topo->threadPool[i].apicId;
@@ -140,10 +152,10 @@ void initialize_likwid() {
     // err = perfmon_init(topo->numHWThreads, cpus);
     err = perfmon_init(active_cpus, cpus);
     if (err < 0) {
-      LDEBUG("Failed to initialize LIKWID's performance monitoring module\n");
+      LWARN("Failed to initialize LIKWID's performance monitoring module");
+      free(cpus);
       topology_finalize();
-      // return 1;
-      exit(-1);
+      return false;
     }
 
     /*
@@ -167,38 +179,52 @@ void initialize_likwid() {
       LINFOF("Setting up events %s for %s\n", amd_estr, info->short_name);
       gid = perfmon_addEventSet(amd_estr);
     } else {
-      LINFO("Unsupported Architecture at the moment\n");
-      exit(-1);
+      LWARN("Unsupported Architecture at the moment");
+      gid = -1;
     }
 
     if (gid < 0) {
-      LDEBUGF(
-          "Failed to add event string %s to LIKWID's performance monitoring " "module\n",
-          intel_estr);
+      LWARNF(
+          "Failed to add event string %s to LIKWID's performance monitoring " "module",
+          info->isIntel ? intel_estr : amd_estr);
       perfmon_finalize();
+      free(cpus);
       topology_finalize();
-      // return 1;
-      exit(-1);
+      return false;
     }
 
     // Setup the eventset identified by group ID (gid).
     err = perfmon_setupCounters(gid);
     if (err < 0) {
-      LDEBUGF(
-          "Failed to setup group %d in LIKWID's performance monitoring " "module\n",
+      LWARNF(
+          "Failed to setup group %d in LIKWID's performance monitoring " "module",
           gid);
       perfmon_finalize();
+      free(cpus);
       topology_finalize();
-      // return 1;
-      exit(-1);
+      return false;
     }
 
-    // Start all counters in the previously set up event set.
-    start_counters();
+    // Start all counters in the previously set up event set, not through
+    // start_counters(), which gives up on the manager
+    err = perfmon_startCounters();
+    if (err < 0) {
+      LWARNF("Failed to start counters for group %d for thread %d", gid,
+             (-1 * err) - 1);
+      perfmon_finalize();
+      free(cpus);
+      topology_finalize();
+      return false;
+    }
 
     initiatialized = true;
     // printf("Setting up Likwid statistics for the first time\n");
   }
+  return true;
+}
+
+bool likwid_initialized() {
+  return initiatialized;
 }
 
 std::vector<double> get_stall_rate() {
@@ -298,17 +324,17 @@ std::vector<double> get_average_stall_rate(int num_measurements,
   std::vector<double> stall_rate;
 
   // throw away a measurement, just because
-  get_stall_rate();
-  usleep(usec_between_measurements);
+  plant->stall_rate();
+  plant->sleep(usec_between_measurements);
 
   // do N measurements, T usec apart
   int j, i;
   for (i = 0; i < num_measurements; i++) {
-    stall_rate = get_stall_rate();
+    stall_rate = plant->stall_rate();
     for (j = 0; j < active_cpus; j++) {
       measurements.at(j).at(i) = stall_rate.at(j);
     }
-    usleep(usec_between_measurements);
+    plant->sleep(usec_between_measurements);
   }
 
   // for debugging purposes!!
@@ -352,26 +378,3 @@ std::vector<double> get_average_stall_rate(int num_measurements,
   // return the average stall rate in a vector
   return average_stall_rate;
 }
-
-#if defined(__unix__) || defined(__linux__)
-// System-specific definitions for Linux
-
-// read time stamp counter
-inline uint64_t readtsc(void) {
-  uint32_t lo, hi;
-  __asm __volatile__("rdtsc" : "=a"(lo), "=d"(hi) : :);
-  return lo | (uint64_t) hi << 32;
-}
-
-// read performance monitor counter
-inline uint64_t readpmc(int32_t n) {
-  uint32_t lo, hi;
-  __asm __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(n) :);
-  return lo | (uint64_t) hi << 32;
-}
-
-#else  // not Linux
-
-#error We only support Linux
-
-#endif
@@ -0,0 +1,284 @@
+/*
+ * PerformanceModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/PerformanceModel.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "include/Logger.hpp"
+
+/////////////////////////////////////////////
+// provide this in a config
+double model_alpha = 0.3;       // EWMA weight of a new observation
+double model_kappa = 0.5;       // exploration bonus of unobserved cells
+double model_sigma = 0.02;      // uncertainty per grid step away from data
+double model_prior = 1.0;       // weight of the prior slopes
+double model_migration = 0.05;  // cost of moving 100% of the pages
+// prior slopes over the whole grid: throttling the BE (lower MBA) and moving
+// its pages away (higher remote ratio) give slack to the HP, while the BE
+// throughput follows its MBA level
+double prior_slack_ratio = 0.3;
+double prior_slack_mba = -0.6;
+double prior_be_ratio = -0.2;  // relative to the mean BE throughput
+double prior_be_mba = 1.0;     // relative to the mean BE throughput
+////////////////////////////////////////////
+
+PerformanceModel perf_model;
+
+PerformanceModel::PerformanceModel() {
+  memset(slack_coeffs, 0, sizeof(slack_coeffs));
+  memset(be_coeffs, 0, sizeof(be_coeffs));
+}
+
+void PerformanceModel::reset(const std::vector<int> &r,
+                             const std::vector<int> &m) {
+  ratios = r;
+  mbas = m;
+  clear();
+}
+
+void PerformanceModel::clear() {
+  cells.assign(ratios.size() * mbas.size(), Cell { 0, 0, 0 });
+  memset(slack_coeffs, 0, sizeof(slack_coeffs));
+  memset(be_coeffs, 0, sizeof(be_coeffs));
+}
+
+void PerformanceModel::set_cells(const std::vector<Cell> &c) {
+  if (c.size() != cells.size()) {
+    LWARN("Performance table does not match the grid, ignoring it");
+    return;
+  }
+  cells = c;
+  refit();
+}
+
+int PerformanceModel::nearest(const std::vector<int> &v, int value) const {
+  int best = 0;
+  for (size_t i = 0; i < v.size(); i++) {
+    if (std::abs(v.at(i) - value) < std::abs(v.at(best) - value))
+      best = i;
+  }
+  return best;
+}
+
+int PerformanceModel::index(int ratio, int mba) const {
+  return nearest(ratios, ratio) * mbas.size() + nearest(mbas, mba);
+}
+
+// bilinear features of a cell, normalized to [0, 1]
+void PerformanceModel::features(size_t r, size_t m, double *x) const {
+  double nr = ratios.size() > 1 ? (double) r / (ratios.size() - 1) : 0;
+  double nm = mbas.size() > 1 ? (double) m / (mbas.size() - 1) : 0;
+  x[0] = 1;
+  x[1] = nr;
+  x[2] = nm;
+  x[3] = nr * nm;
+}
+
+double PerformanceModel::predict(const double *coeffs, size_t r,
+                                 size_t m) const {
+  double x[NUM_COEFFS];
+  double y = 0;
+  features(r, m, x);
+  for (int k = 0; k < NUM_COEFFS; k++) {
+    y += coeffs[k] * x[k];
+  }
+  return y;
+}
+
+void PerformanceModel::observe(int ratio, int mba, double slack,
+                               double be_perf) {
+  if (cells.empty() || std::isnan(slack) || std::isinf(slack)) {
+    return;
+  }
+  Cell &c = cells.at(index(ratio, mba));
+  if (c.count == 0) {
+    c.slack = slack;
+    c.be_perf = be_perf;
+  } else {
+    c.slack = (1 - model_alpha) * c.slack + model_alpha * slack;
+    c.be_perf = (1 - model_alpha) * c.be_perf + model_alpha * be_perf;
+  }
+  c.count++;
+  refit();
+}
+
+/*
+ * Weighted regression of the bilinear surrogate over the observed cells,
+ * regularized towards the prior slopes (so that a single observation already
+ * gives a usable model), solved with Gaussian elimination on the normal
+ * equations
+ */
+void PerformanceModel::refit() {
+  double a[NUM_COEFFS][NUM_COEFFS + 2];
+  double x[NUM_COEFFS];
+  double mean_be = 0;
+  int n = 0;
+
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (cells.at(i).count > 0) {
+      mean_be += cells.at(i).be_perf;
+      n++;
+    }
+  }
+  mean_be = n > 0 ? mean_be / n : 0;
+
+  double slack_prior[NUM_COEFFS] = { 0, prior_slack_ratio, prior_slack_mba, 0 };
+  double be_prior[NUM_COEFFS] = { 0, prior_be_ratio * mean_be, prior_be_mba
+      * mean_be, 0 };
+  memset(a, 0, sizeof(a));
+  for (int k = 0; k < NUM_COEFFS; k++) {
+    // the intercept is left to the data
+    double w = k == 0 ? 1e-6 : model_prior;
+    a[k][k] = w;
+    a[k][NUM_COEFFS] = w * slack_prior[k];
+    a[k][NUM_COEFFS + 1] = w * be_prior[k];
+  }
+  for (size_t r = 0; r < ratios.size(); r++) {
+    for (size_t m = 0; m < mbas.size(); m++) {
+      const Cell &c = cells.at(r * mbas.size() + m);
+      if (c.count == 0)
+        continue;
+      double w = std::log2(1.0 + c.count);
+      features(r, m, x);
+      for (int i = 0; i < NUM_COEFFS; i++) {
+        for (int j = 0; j < NUM_COEFFS; j++) {
+          a[i][j] += w * x[i] * x[j];
+        }
+        a[i][NUM_COEFFS] += w * x[i] * c.slack;
+        a[i][NUM_COEFFS + 1] += w * x[i] * c.be_perf;
+      }
+    }
+  }
+
+  for (int i = 0; i < NUM_COEFFS; i++) {
+    int pivot = i;
+    for (int j = i + 1; j < NUM_COEFFS; j++) {
+      if (std::fabs(a[j][i]) > std::fabs(a[pivot][i]))
+        pivot = j;
+    }
+    for (int k = 0; k < NUM_COEFFS + 2; k++) {
+      std::swap(a[i][k], a[pivot][k]);
+    }
+    for (int j = 0; j < NUM_COEFFS; j++) {
+      if (j == i || a[i][i] == 0)
+        continue;
+      double f = a[j][i] / a[i][i];
+      for (int k = i; k < NUM_COEFFS + 2; k++) {
+        a[j][k] -= f * a[i][k];
+      }
+    }
+  }
+  for (int i = 0; i < NUM_COEFFS; i++) {
+    slack_coeffs[i] = a[i][i] != 0 ? a[i][NUM_COEFFS] / a[i][i] : 0;
+    be_coeffs[i] = a[i][i] != 0 ? a[i][NUM_COEFFS + 1] / a[i][i] : 0;
+  }
+}
+
+double PerformanceModel::predict_slack(int ratio, int mba) const {
+  const Cell &c = cells.at(index(ratio, mba));
+  if (c.count > 0)
+    return c.slack;
+  return predict(slack_coeffs, nearest(ratios, ratio), nearest(mbas, mba));
+}
+
+double PerformanceModel::predict_be(int ratio, int mba) const {
+  const Cell &c = cells.at(index(ratio, mba));
+  if (c.count > 0)
+    return c.be_perf;
+  return predict(be_coeffs, nearest(ratios, ratio), nearest(mbas, mba));
+}
+
+// grid distance to the closest observed cell, scaled by model_sigma
+double PerformanceModel::uncertainty(int ratio, int mba) const {
+  int r0 = nearest(ratios, ratio);
+  int m0 = nearest(mbas, mba);
+  int best = std::numeric_limits<int>::max();
+  for (size_t r = 0; r < ratios.size(); r++) {
+    for (size_t m = 0; m < mbas.size(); m++) {
+      if (cells.at(r * mbas.size() + m).count > 0) {
+        best = std::min(best, std::abs((int) r - r0) + std::abs((int) m - m0));
+      }
+    }
+  }
+  if (best == std::numeric_limits<int>::max())
+    return 1.0;
+  return model_sigma * best;
+}
+
+int PerformanceModel::observations() const {
+  int n = 0;
+  for (size_t i = 0; i < cells.size(); i++) {
+    n += cells.at(i).count;
+  }
+  return n;
+}
+
+bool PerformanceModel::next_probe(int current_ratio, int current_mba,
+                                  double min_slack, int *ratio,
+                                  int *mba) const {
+  double max_be = 0;
+  for (size_t r = 0; r < ratios.size(); r++) {
+    for (size_t m = 0; m < mbas.size(); m++) {
+      max_be = std::max(max_be, std::fabs(predict_be(ratios.at(r), mbas.at(m))));
+    }
+  }
+  if (max_be == 0)
+    max_be = 1;
+
+  bool found = false;
+  double best_score = -std::numeric_limits<double>::infinity();
+  double safest_slack = -std::numeric_limits<double>::infinity();
+  int safest_ratio = current_ratio, safest_mba = current_mba;
+
+  for (size_t r = 0; r < ratios.size(); r++) {
+    for (size_t m = 0; m < mbas.size(); m++) {
+      int cr = ratios.at(r), cm = mbas.at(m);
+      double sigma = uncertainty(cr, cm);
+      // pessimistic about the SLO, optimistic about the BE throughput
+      double s = predict_slack(cr, cm) - sigma;
+      double score = predict_be(cr, cm) / max_be + model_kappa * sigma
+          - model_migration * std::abs(cr - current_ratio) / 100.0;
+
+      if (s > safest_slack) {
+        safest_slack = s;
+        safest_ratio = cr;
+        safest_mba = cm;
+      }
+      if (s >= min_slack && score > best_score) {
+        best_score = score;
+        *ratio = cr;
+        *mba = cm;
+        found = true;
+      }
+    }
+  }
+
+  // nothing is predicted to meet the SLOs, go to the safest configuration
+  if (!found) {
+    *ratio = safest_ratio;
+    *mba = safest_mba;
+  }
+
+  return !(ratios.at(nearest(ratios, *ratio))
+      == ratios.at(nearest(ratios, current_ratio))
+      && mbas.at(nearest(mbas, *mba)) == mbas.at(nearest(mbas, current_mba)));
+}
+
+void PerformanceModel::print() const {
+  LINFOF("Performance model: %d observations", observations());
+  for (size_t r = 0; r < ratios.size(); r++) {
+    for (size_t m = 0; m < mbas.size(); m++) {
+      const Cell &c = cells.at(r * mbas.size() + m);
+      if (c.count > 0) {
+        LINFOF("ratio %3d mba %3d: slack %6.2lf be %12.4lf (%d samples)",
+               ratios.at(r), mbas.at(m), c.slack, c.be_perf, c.count);
+      }
+    }
+  }
+}
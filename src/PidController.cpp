@@ -0,0 +1,60 @@
+/*
+ * PidController.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/PidController.hpp"
+
+#include <algorithm>
+
+// low-pass filter of the derivative term (0 = no filtering)
+static const double derivative_filter = 0.8;
+
+PidController::PidController(double kp, double ki, double kd, double out_min,
+                             double out_max)
+    : _kp(kp),
+      _ki(ki),
+      _kd(kd),
+      _out_min(out_min),
+      _out_max(out_max),
+      integral(out_max),
+      prev_measurement(0),
+      derivative(0),
+      first(true),
+      _output(out_max) {
+}
+
+void PidController::reset(double output) {
+  integral = std::min(std::max(output, _out_min), _out_max);
+  derivative = 0;
+  first = true;
+  _output = integral;
+}
+
+double PidController::update(double setpoint, double measurement, double dt) {
+  double error = measurement - setpoint;
+
+  if (first || dt <= 0) {
+    prev_measurement = measurement;
+    first = false;
+  } else {
+    double d = (measurement - prev_measurement) / dt;
+    derivative = derivative_filter * derivative + (1 - derivative_filter) * d;
+    prev_measurement = measurement;
+  }
+
+  double candidate = integral + _ki * error * dt;
+  double unsaturated = candidate + _kp * error + _kd * derivative;
+
+  // anti-windup: only integrate if it does not push a saturated output further
+  if (!((unsaturated > _out_max && error > 0)
+      || (unsaturated < _out_min && error < 0))) {
+    integral = std::min(std::max(candidate, _out_min), _out_max);
+  }
+
+  _output = std::min(std::max(integral + _kp * error + _kd * derivative,
+                              _out_min),
+                     _out_max);
+  return _output;
+}
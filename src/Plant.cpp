@@ -0,0 +1,335 @@
+/*
+ * Plant.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Plant.hpp"
+
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+#include "include/PagePlacement.hpp"
+#include "include/PerformanceCounters.hpp"
+#include "include/Profiler.hpp"
+#include "include/SegmentRegistry.hpp"
+#include "include/SettleDetector.hpp"
+#include "include/Simulator.hpp"
+#include "include/Timeline.hpp"
+#include "include/Trace.hpp"
+#include "include/TraceReplay.hpp"
+#include "include/Utilities.hpp"
+
+/////////////////////////////////////////////
+// provide this in a config
+useconds_t virtual_period = 20000;  // same as the measurement thread
+extern double slack_up;
+////////////////////////////////////////////
+
+Plant *plant = NULL;
+
+static HardwarePlant hardware_plant;
+
+/*
+ * HardwarePlant
+ */
+double HardwarePlant::latency() {
+  return get_sampled_percentile_latency();
+}
+
+double HardwarePlant::latency_xpn() {
+  return get_sampled_percentile_latency_xpn();
+}
+
+bool HardwarePlant::has_counters() {
+  return likwid_initialized();
+}
+
+std::vector<double> HardwarePlant::stall_rate() {
+  TimelineSpan span("sensor", "stall rate read");
+  ProfileScope scope(PROF_MEASUREMENT);
+  return get_stall_rate();
+}
+
+int HardwarePlant::write(actuator_resource res, unsigned socket_id,
+                         unsigned cos_value, int value) {
+  switch (res) {
+    case ACT_MBA:
+      set_mba_parameters(cos_value, value);
+      return set_mba_allocation(socket_id);
+    case ACT_LLC:
+      return set_l3ca_allocation(socket_id, cos_value, value);
+    default:
+      return -1;
+  }
+}
+
+void Plant::place_pages(int ratio) {
+  // the segments registered since the last placement
+  sync_segments();
+  TimelineSpan span("placement", "place pages", { { "ratio", ratio }, {
+      "segments", mem_segments.size() } });
+  place_pages(mem_segments, ratio);
+}
+
+// the share of the pages off the worker node (%)
+static int weights_ratio(const std::vector<double> &weights) {
+  return (int) lround(100 - weights.at(0));
+}
+
+void Plant::place_weights(const std::vector<MySharedMemory> &segments,
+                          const std::vector<double> &weights) {
+  place_pages(segments, weights_ratio(weights));
+}
+
+void Plant::place_weights(const std::vector<double> &weights) {
+  sync_segments();
+  TimelineSpan span("placement", "place weights", { { "ratio", weights_ratio(
+      weights) }, { "segments", mem_segments.size() } });
+  place_weights(mem_segments, weights);
+}
+
+void HardwarePlant::place_pages(const std::vector<MySharedMemory> &segments,
+                                int ratio) {
+  place_all_pages(segments, ratio);
+}
+
+void HardwarePlant::place_weights(const std::vector<MySharedMemory> &segments,
+                                  const std::vector<double> &weights) {
+  place_all_pages(segments, weights);
+}
+
+uint64_t HardwarePlant::now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+void HardwarePlant::sleep_until(uint64_t t) {
+  struct timespec ts;
+  ts.tv_sec = t / 1000000UL;
+  ts.tv_nsec = (t % 1000000UL) * 1000;
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/*
+ * RecordingPlant
+ */
+static uint64_t trace_start = 0;
+
+RecordingPlant::RecordingPlant(Plant *inner)
+    : _inner(inner) {
+  trace_header header = { };
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.num_cores = active_cpus;
+  header.target_slo = target_slo;
+  header.target_slo_xapian = target_slo_xapian;
+  header.remote_ratio = current_remote_ratio;
+  header.mba = get_max_mba();
+
+  if (!trace_open(trace_record_file, header)) {
+    exit(EXIT_FAILURE);
+  }
+  trace_start = _inner->now();
+
+  // the platform, to replay the trace on a machine without MBA/CAT
+  const std::vector<int> &levels = get_mba_levels();
+  for (size_t i = 0; i < levels.size(); i++) {
+    trace_write(0, TRACE_MBA_LEVEL, levels.at(i),
+                get_mba_bandwidth(levels.at(i)));
+  }
+  trace_write(0, TRACE_LLC_WAYS, 0, get_max_llc_ways());
+}
+
+double RecordingPlant::latency() {
+  double value = _inner->latency();
+  trace_write(now() - trace_start, TRACE_LATENCY, 0, value);
+  return value;
+}
+
+double RecordingPlant::latency_xpn() {
+  double value = _inner->latency_xpn();
+  trace_write(now() - trace_start, TRACE_LATENCY_XPN, 0, value);
+  return value;
+}
+
+bool RecordingPlant::has_counters() {
+  return _inner->has_counters();
+}
+
+std::vector<double> RecordingPlant::stall_rate() {
+  std::vector<double> values = _inner->stall_rate();
+  uint64_t t = now() - trace_start;
+  for (size_t i = 0; i < values.size(); i++) {
+    trace_write(t, TRACE_STALL_RATE, i, values.at(i));
+  }
+  return values;
+}
+
+int RecordingPlant::write(actuator_resource res, unsigned socket_id,
+                          unsigned cos_value, int value) {
+  int ret = _inner->write(res, socket_id, cos_value, value);
+  trace_write(now() - trace_start, res == ACT_MBA ? TRACE_MBA : TRACE_LLC,
+              TRACE_INDEX(socket_id, cos_value), value);
+  return ret;
+}
+
+void RecordingPlant::place_pages(const std::vector<MySharedMemory> &segments,
+                                 int ratio) {
+  _inner->place_pages(segments, ratio);
+  trace_write(now() - trace_start, TRACE_RATIO,
+              segments.empty() ? 0 : segments.front().processID, ratio);
+}
+
+void RecordingPlant::place_weights(const std::vector<MySharedMemory> &segments,
+                                   const std::vector<double> &weights) {
+  _inner->place_weights(segments, weights);
+  trace_write(now() - trace_start, TRACE_RATIO,
+              segments.empty() ? 0 : segments.front().processID,
+              weights_ratio(weights));
+}
+
+uint64_t RecordingPlant::now() {
+  return _inner->now();
+}
+
+void RecordingPlant::sleep_until(uint64_t t) {
+  _inner->sleep_until(t);
+}
+
+/*
+ * VirtualPlant
+ */
+VirtualPlant::VirtualPlant(uint64_t duration)
+    : _now(0),
+      _duration(duration),
+      _mba(get_max_mba()),
+      _llc_ways(get_max_llc_ways()),
+      _ratio(current_remote_ratio),
+      time_violated(0),
+      time_violated_xpn(0),
+      time_near(0),
+      be_work(0),
+      num_mba_writes(0),
+      num_llc_writes(0),
+      num_migrations(0),
+      migrated(0) {
+}
+
+int VirtualPlant::write(actuator_resource res, unsigned socket_id,
+                        unsigned cos_value, int value) {
+  // the BE runs in class 1 (in any class but the default with several BEs)
+  if (cos_value == 0) {
+    return 0;
+  }
+  switch (res) {
+    case ACT_MBA:
+      _mba = value;
+      num_mba_writes++;
+      return 0;
+    case ACT_LLC:
+      _llc_ways = value;
+      num_llc_writes++;
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+void VirtualPlant::place_pages(const std::vector<MySharedMemory> &segments,
+                               int ratio) {
+  num_migrations++;
+  migrated += std::abs(ratio - _ratio);
+  _ratio = ratio;
+}
+
+void VirtualPlant::sleep_until(uint64_t t) {
+  while (_now < t) {
+    uint64_t dt = std::min((uint64_t) virtual_period, t - _now);
+    _now += dt;
+    step(dt);
+    account(dt);
+    if (_now >= _duration) {
+      finish();
+    }
+  }
+}
+
+double VirtualPlant::be_throughput() {
+  return get_mba_bandwidth(_mba) / get_mba_bandwidth(get_max_mba());
+}
+
+void VirtualPlant::account(uint64_t dt) {
+  double lat = latency();
+  double lat_xpn = latency_xpn();
+  if (lat > target_slo) {
+    time_violated += dt;
+  }
+  if (lat_xpn > target_slo_xapian) {
+    time_violated_xpn += dt;
+  }
+  if ((target_slo - lat) / target_slo <= slack_up
+      || (lat_xpn > 0
+          && (target_slo_xapian - lat_xpn) / target_slo_xapian <= slack_up)) {
+    time_near += dt;
+  }
+  be_work += be_throughput() * dt;
+}
+
+void VirtualPlant::finish() {
+  double total = _now;
+  LINFO("======================================================");
+  LINFOF("Evaluation on the %s plant: %.1lf sec", name(), total / 1e6);
+  LINFOF("SLO violated: %.2lf%% of the time (xapian: %.2lf%%), slack below "
+         "%.2lf: %.2lf%% of the time", 100.0 * time_violated / total,
+         100.0 * time_violated_xpn / total, slack_up,
+         100.0 * time_near / total);
+  LINFOF("BE throughput: %.4lf", be_work / total);
+  LINFOF("Actions: %lu MBA writes, %lu LLC writes, %lu migrations "
+         "(%lu%% of the BE pages moved)", num_mba_writes, num_llc_writes,
+         num_migrations, migrated);
+  LINFO("======================================================");
+  actuator_print_stats();
+  settle_print_stats();
+  profile_print_summary();
+  finalize_plant();
+  exit(EXIT_SUCCESS);
+}
+
+void initialize_plant() {
+  switch (plant_mode) {
+    case 0:
+      plant = &hardware_plant;
+      break;
+    case 1:
+      plant = new TracePlant(trace_replay_file);
+      break;
+    case 2:
+      plant = new FittedPlant(trace_replay_file);
+      break;
+    case 3:
+      plant = new SimulatedPlant();
+      break;
+    default:
+      LINFOF("Invalid plant: %d", plant_mode);
+      exit(EXIT_FAILURE);
+  }
+  if (!trace_record_file.empty()) {
+    plant = new RecordingPlant(plant);
+  }
+}
+
+bool plant_is_hardware() {
+  return plant_mode == 0;
+}
+
+void finalize_plant() {
+  trace_close();
+}
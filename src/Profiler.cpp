@@ -0,0 +1,110 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Profiler.hpp"
+
+#include <inttypes.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "include/Logger.hpp"
+#include "include/PerformanceCounters.hpp"
+
+static ProfileStats stats[PROF_NUM_SECTIONS];
+
+static const char *section_names[] = { "iteration", "measurement",
+    "actuation", "migration" };
+
+static uint64_t clock_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const uint64_t process_start = clock_ns(CLOCK_MONOTONIC);
+
+// the previous iteration of the controller thread, 0 before the first
+static uint64_t last_wall = 0;
+static uint64_t last_cpu = 0;
+static uint64_t last_cycles = 0;
+
+const char* profile_section_name(profile_section section) {
+  return section_names[section];
+}
+
+const ProfileStats& profile_stats(profile_section section) {
+  return stats[section];
+}
+
+static void record(profile_section section, uint64_t wall, uint64_t cpu,
+                   uint64_t cycles) {
+  stats[section].wall.add(wall);
+  stats[section].cpu.add(cpu);
+  stats[section].cycles.add(cycles);
+}
+
+void profile_iteration() {
+  uint64_t wall = clock_ns(CLOCK_MONOTONIC);
+  uint64_t cpu = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  uint64_t cycles = readtsc();
+  if (last_wall != 0) {
+    record(PROF_ITERATION, wall - last_wall, cpu - last_cpu,
+           cycles - last_cycles);
+  }
+  last_wall = wall;
+  last_cpu = cpu;
+  last_cycles = cycles;
+}
+
+uint64_t profile_process_cpu() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+void profile_print_summary() {
+  uint64_t wall = clock_ns(CLOCK_MONOTONIC) - process_start;
+  uint64_t cpu = profile_process_cpu();
+  uint64_t section_wall = 0, section_cycles = 0;
+  for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+    section_wall += stats[i].wall.sum();
+    section_cycles += stats[i].cycles.sum();
+  }
+  LINFOF("Profile: %.3lf s of CPU in %.1lf s (%.2lf%% of a core), "
+         "TSC at %.2lf GHz", cpu / 1e9, wall / 1e9, 100.0 * cpu / wall,
+         section_wall == 0 ? 0.0 : (double) section_cycles / section_wall);
+  for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+    const ProfileStats &s = stats[i];
+    uint64_t count = s.wall.count();
+    if (count == 0) {
+      LINFOF("  %s: no samples", section_names[i]);
+      continue;
+    }
+    LINFOF("  %s: count %" PRIu64 ", wall mean %.1lf us (p99 <= %.1lf, "
+           "max %.1lf), CPU mean %.1lf us (p99 <= %.1lf, max %.1lf, %.2lf%% of the wall), "
+           "mean %" PRIu64 " cycles", section_names[i], count,
+           s.wall.sum() / 1e3 / count, s.wall.percentile(0.99) / 1e3,
+           s.wall.max() / 1e3, s.cpu.sum() / 1e3 / count,
+           s.cpu.percentile(0.99) / 1e3, s.cpu.max() / 1e3,
+           s.wall.sum() == 0 ? 0.0 : 100.0 * s.cpu.sum() / s.wall.sum(),
+           s.cycles.sum() / count);
+  }
+}
+
+ProfileScope::ProfileScope(profile_section section)
+    : _section(section),
+      _wall(clock_ns(CLOCK_MONOTONIC)),
+      _cpu(clock_ns(CLOCK_THREAD_CPUTIME_ID)),
+      _cycles(readtsc()) {
+}
+
+ProfileScope::~ProfileScope() {
+  uint64_t cycles = readtsc();
+  uint64_t cpu = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  uint64_t wall = clock_ns(CLOCK_MONOTONIC);
+  record(_section, wall - _wall, cpu - _cpu, cycles - _cycles);
+}
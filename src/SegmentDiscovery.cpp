@@ -0,0 +1,198 @@
+/*
+ * SegmentDiscovery.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/SegmentDiscovery.hpp"
+
+#include <time.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MySharedMemory.hpp"
+#include "include/SegmentRegistry.hpp"
+
+// pid -> start -> length
+typedef std::map<unsigned long, unsigned long> Mappings;
+static std::map<pid_t, Mappings> discovered;
+static std::set<pid_t> unreadable;
+static struct timespec last_scan;
+static bool scanned = false;
+
+bool discovery_enabled() {
+  return !be_pids.empty() || !be_cgroup.empty();
+}
+
+std::set<pid_t> get_be_pids() {
+  std::set<pid_t> pids;
+  std::stringstream ss(be_pids);
+  std::string tok;
+  while (getline(ss, tok, ',')) {
+    if (!tok.empty()) {
+      pids.insert(stoi(tok));
+    }
+  }
+  if (!be_cgroup.empty()) {
+    std::ifstream procs(be_cgroup + "/cgroup.procs");
+    if (!procs.is_open()) {
+      LWARNF("Unable to read the processes of cgroup %s", be_cgroup.c_str());
+    }
+    pid_t pid;
+    while (procs >> pid) {
+      pids.insert(pid);
+    }
+  }
+  return pids;
+}
+
+/*
+ * The candidate mappings of a process: private, writable, anonymous (or
+ * heap) and large enough
+ * returns false if the process is gone or its maps cannot be read
+ */
+static bool read_maps(pid_t pid, Mappings &mappings) {
+  std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+  if (!maps.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (getline(maps, line)) {
+    unsigned long start, end;
+    char perms[5];
+    int path = 0;
+    if (sscanf(line.c_str(), "%lx-%lx %4s %*s %*s %*s %n", &start, &end, perms,
+               &path) < 3) {
+      continue;
+    }
+    std::string name = path > 0 ? line.substr(path) : "";
+    if (perms[0] != 'r' || perms[1] != 'w' || perms[3] != 'p') {
+      continue;
+    }
+    if (!name.empty() && name != "[heap]" && name.compare(0, 6, "[anon:") != 0) {
+      continue;
+    }
+    if (end - start >= min_segment_size) {
+      mappings[start] = end - start;
+    }
+  }
+  return true;
+}
+
+// drop the new mappings that are not resident enough yet (from smaps)
+static void filter_rss(pid_t pid, Mappings &added) {
+  std::ifstream smaps("/proc/" + std::to_string(pid) + "/smaps");
+  std::string line;
+  auto current = added.end();
+  std::set<unsigned long> resident;
+
+  while (getline(smaps, line)) {
+    unsigned long start, end, rss;
+    if (sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2
+        && line.find('-') < line.find(' ')) {
+      current = added.find(start);
+    } else if (current != added.end()
+        && sscanf(line.c_str(), "Rss: %lu kB", &rss) == 1) {
+      if (rss * 1024 >= min_segment_rss) {
+        resident.insert(current->first);
+      }
+      current = added.end();
+    }
+  }
+  for (auto it = added.begin(); it != added.end();) {
+    it = resident.count(it->first) ? std::next(it) : added.erase(it);
+  }
+}
+
+static std::vector<MySharedMemory> to_segments(pid_t pid,
+                                               const Mappings &mappings) {
+  std::vector<MySharedMemory> segments;
+  for (const auto &m : mappings) {
+    segments.push_back(MySharedMemory((void*) m.first, m.second, pid));
+  }
+  return segments;
+}
+
+static void scan_process(pid_t pid) {
+  Mappings current;
+  if (!read_maps(pid, current)) {
+    if (!unreadable.count(pid)) {
+      LWARNF("Unable to read the mappings of BE %d (gone?)", pid);
+      unreadable.insert(pid);
+    }
+    if (discovered.erase(pid)) {
+      unregister_process(pid);
+    }
+    return;
+  }
+  unreadable.erase(pid);
+
+  // a mapping that changed (e.g., the heap grew) is removed and added
+  Mappings &known = discovered[pid];
+  Mappings removed, added;
+  for (const auto &m : known) {
+    auto it = current.find(m.first);
+    if (it == current.end() || it->second != m.second) {
+      removed.insert(m);
+    }
+  }
+  for (const auto &m : current) {
+    auto it = known.find(m.first);
+    if (it == known.end() || it->second != m.second) {
+      added.insert(m);
+    }
+  }
+  if (min_segment_rss > 0 && !added.empty()) {
+    filter_rss(pid, added);
+  }
+  if (removed.empty() && added.empty()) {
+    return;
+  }
+
+  for (const auto &m : removed) {
+    known.erase(m.first);
+  }
+  known.insert(added.begin(), added.end());
+  unregister_segments(to_segments(pid, removed));
+  register_segments(to_segments(pid, added));
+  LDEBUGF("BE %d: %lu mappings discovered, %lu removed", pid, added.size(),
+          removed.size());
+}
+
+void discover_segments() {
+  if (!discovery_enabled()) {
+    return;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (scanned
+      && (now.tv_sec - last_scan.tv_sec) * 1000
+          + (now.tv_nsec - last_scan.tv_nsec) / 1000000 < discovery_period) {
+    return;
+  }
+  last_scan = now;
+  scanned = true;
+
+  std::set<pid_t> pids = get_be_pids();
+  // the processes gone (or out of the cgroup)
+  for (auto it = discovered.begin(); it != discovered.end();) {
+    if (!pids.count(it->first)) {
+      LINFOF("BE %d is no longer discovered", it->first);
+      unregister_process(it->first);
+      it = discovered.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (pid_t pid : pids) {
+    scan_process(pid);
+  }
+}
@@ -0,0 +1,328 @@
+/*
+ * SegmentRegistry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/SegmentRegistry.hpp"
+
+#include <errno.h>
+#include <grp.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <map>
+#include <set>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/SegmentDiscovery.hpp"
+#include "include/SegmentQueue.hpp"
+#include "include/Tenants.hpp"
+#include "include/Utilities.hpp"
+
+// how often to look for the BEs that exited without unregistering (s)
+#define LIVENESS_PERIOD 1
+// how long a claimed slot may stay unpublished before it is skipped (s)
+#define UNPUBLISHED_TIMEOUT 1
+
+struct SegmentRange {
+  uint64_t length;
+  uint64_t generation;
+};
+
+// pid -> start -> range
+typedef std::map<uint64_t, SegmentRange> SegmentRanges;
+static std::map<pid_t, SegmentRanges> segment_table;
+
+static SegmentQueue *queue = NULL;
+static uint64_t last_dropped = 0;
+static uint64_t last_torn = 0;
+static bool table_changed = false;
+static struct timespec last_liveness;
+// the slot at the tail claimed by a producer but not published yet
+static bool unpublished = false;
+static uint64_t unpublished_pos;
+static struct timespec unpublished_since;
+
+static uint64_t page_size() {
+  static uint64_t size = sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+/*
+ * Cut [start, end) out of the ranges not newer than generation
+ * returns false if a newer range overlaps
+ */
+static bool cut_ranges(SegmentRanges &ranges, uint64_t start, uint64_t end,
+                       uint64_t generation) {
+  bool newer = false;
+  auto it = ranges.upper_bound(start);
+  if (it != ranges.begin()) {
+    --it;
+  }
+  while (it != ranges.end() && it->first < end) {
+    uint64_t range_start = it->first;
+    uint64_t range_end = range_start + it->second.length;
+    if (range_end <= start) {
+      ++it;
+      continue;
+    }
+    if (it->second.generation > generation) {
+      newer = true;
+      ++it;
+      continue;
+    }
+    SegmentRange range = it->second;
+    it = ranges.erase(it);
+    if (range_start < start) {
+      ranges[range_start] = { start - range_start, range.generation };
+    }
+    if (range_end > end) {
+      it = ranges.insert(it, { end, { range_end - end, range.generation } });
+      ++it;
+    }
+    table_changed = true;
+  }
+  return !newer;
+}
+
+static void apply_event(const SegmentEvent &event) {
+  uint64_t start = event.start & ~(page_size() - 1);
+  uint64_t end = (event.start + event.length + page_size() - 1)
+      & ~(page_size() - 1);
+
+  switch (event.type) {
+    case SEGMENT_REGISTER: {
+      if (end <= start) {
+        break;
+      }
+      SegmentRanges &ranges = segment_table[event.pid];
+      if (cut_ranges(ranges, start, end, event.generation)) {
+        ranges[start] = { end - start, event.generation };
+        table_changed = true;
+      } else {
+        LDEBUGF("Stale registration of %d: %#lx+%lu (generation %lu)",
+                event.pid, start, end - start, event.generation);
+      }
+      break;
+    }
+    case SEGMENT_UNREGISTER: {
+      auto it = segment_table.find(event.pid);
+      if (it != segment_table.end()) {
+        cut_ranges(it->second, start, end, event.generation);
+        if (it->second.empty()) {
+          segment_table.erase(it);
+        }
+      }
+      break;
+    }
+    case SEGMENT_EXIT: {
+      auto it = segment_table.find(event.pid);
+      if (it != segment_table.end()) {
+        cut_ranges(it->second, 0, UINT64_MAX, event.generation);
+        if (it->second.empty()) {
+          segment_table.erase(it);
+        }
+      }
+      break;
+    }
+    default:
+      LWARNF("Unknown segment event %u from %d", event.type, event.pid);
+      break;
+  }
+}
+
+// drop the processes that exited without telling
+static void check_liveness() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec - last_liveness.tv_sec < LIVENESS_PERIOD) {
+    return;
+  }
+  last_liveness = now;
+
+  for (auto it = segment_table.begin(); it != segment_table.end();) {
+    if (kill(it->first, 0) != 0 && errno == ESRCH) {
+      LINFOF("BE %d exited, dropping its %lu segments", it->first,
+             it->second.size());
+      it = segment_table.erase(it);
+      table_changed = true;
+    } else {
+      ++it;
+    }
+  }
+}
+
+void open_segment_registry() {
+  shm_unlink("/" SEGMENT_QUEUE_NAME);
+  int fd = shm_open("/" SEGMENT_QUEUE_NAME, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    LWARNF("Unable to create the segment queue (%s), "
+           "only the one-shot handoff is available", strerror(errno));
+    return;
+  }
+  // a registration makes the manager move the pages of that pid, only the
+  // user of the manager (and the group, if any) may register
+  if (!segment_queue_group.empty()) {
+    struct group *gr = getgrnam(segment_queue_group.c_str());
+    if (gr == NULL || fchown(fd, -1, gr->gr_gid) != 0
+        || fchmod(fd, 0660) != 0) {
+      LWARNF("Unable to give the segment queue to group %s, only the user of "
+             "the manager can register", segment_queue_group.c_str());
+    }
+  }
+  if (ftruncate(fd, sizeof(SegmentQueue)) != 0) {
+    LWARNF("Unable to size the segment queue (%s)", strerror(errno));
+    close(fd);
+    shm_unlink("/" SEGMENT_QUEUE_NAME);
+    return;
+  }
+  void *p = mmap(NULL, sizeof(SegmentQueue), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    LWARNF("Unable to map the segment queue (%s)", strerror(errno));
+    shm_unlink("/" SEGMENT_QUEUE_NAME);
+    return;
+  }
+  queue = (SegmentQueue*) p;
+  segment_queue_init(queue);
+  clock_gettime(CLOCK_MONOTONIC, &last_liveness);
+  LINFOF("Segment queue /dev/shm/%s is open (%d events)", SEGMENT_QUEUE_NAME,
+         SEGMENT_QUEUE_CAPACITY);
+}
+
+void close_segment_registry() {
+  if (queue == NULL) {
+    return;
+  }
+  munmap(queue, sizeof(SegmentQueue));
+  queue = NULL;
+  shm_unlink("/" SEGMENT_QUEUE_NAME);
+  LINFO("Segment queue has been destroyed!");
+}
+
+// the events of the manager itself are ordered with those of the queue
+static uint64_t next_generation() {
+  static uint64_t generation = 0;
+  return queue ? segment_queue_generation(queue) : ++generation;
+}
+
+static void apply_segments(segment_event_type type,
+                           const std::vector<MySharedMemory> &segments) {
+  for (const MySharedMemory &segment : segments) {
+    SegmentEvent event;
+    event.type = type;
+    event.pid = segment.processID;
+    event.start = (uint64_t) segment.pageAlignedStartAddress;
+    event.length = segment.pageAlignedLength;
+    event.generation = next_generation();
+    apply_event(event);
+  }
+}
+
+void register_segments(const std::vector<MySharedMemory> &segments) {
+  apply_segments(SEGMENT_REGISTER, segments);
+}
+
+void unregister_segments(const std::vector<MySharedMemory> &segments) {
+  apply_segments(SEGMENT_UNREGISTER, segments);
+}
+
+void unregister_process(pid_t pid) {
+  SegmentEvent event;
+  event.type = SEGMENT_EXIT;
+  event.pid = pid;
+  event.start = 0;
+  event.length = 0;
+  event.generation = next_generation();
+  apply_event(event);
+}
+
+// whether a claimed slot has stayed unpublished for too long (its producer
+// died between claiming and publishing it)
+static bool unpublished_timeout() {
+  uint64_t pos;
+  if (!segment_queue_unpublished(queue, &pos)) {
+    unpublished = false;
+    return false;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!unpublished || pos != unpublished_pos) {
+    unpublished = true;
+    unpublished_pos = pos;
+    unpublished_since = now;
+    return false;
+  }
+  return now.tv_sec - unpublished_since.tv_sec >= UNPUBLISHED_TIMEOUT;
+}
+
+bool sync_segments() {
+  discover_segments();
+  if (queue != NULL) {
+    // with discovery, only the BEs may register (the pid of an event is
+    // not authenticated)
+    bool filter = discovery_enabled();
+    std::set<pid_t> be = filter ? get_be_pids() : std::set<pid_t>();
+    SegmentEvent event;
+    for (;;) {
+      while (segment_queue_pop(queue, &event)) {
+        if (filter && !be.count(event.pid)) {
+          LWARNF("Dropping a segment event of %d, not a BE", event.pid);
+          continue;
+        }
+        apply_event(event);
+      }
+      if (!unpublished_timeout()) {
+        break;
+      }
+      LWARNF("Segment event %lu was never published, skipping it",
+             unpublished_pos);
+      segment_queue_skip(queue);
+      unpublished = false;
+    }
+    uint64_t dropped = queue->dropped.load(std::memory_order_relaxed);
+    if (dropped != last_dropped) {
+      LWARNF("%lu segment events were dropped (queue full or skipped), "
+             "the segment table may be incomplete", dropped - last_dropped);
+      last_dropped = dropped;
+    }
+    uint64_t torn = queue->torn.load(std::memory_order_relaxed);
+    if (torn != last_torn) {
+      LWARNF("%lu segment events were torn by a late producer and dropped, "
+             "the segment table may be incomplete", torn - last_torn);
+      last_torn = torn;
+    }
+  }
+  if (!segment_table.empty()) {
+    check_liveness();
+  }
+  if (!table_changed) {
+    return false;
+  }
+  table_changed = false;
+
+  // coalesce the adjacent ranges, fewer (larger) move_pages calls
+  mem_segments.clear();
+  for (const auto &process : segment_table) {
+    for (const auto &range : process.second) {
+      if (!mem_segments.empty() && mem_segments.back().processID == process.first
+          && (uint64_t) mem_segments.back().pageAlignedStartAddress
+              + mem_segments.back().pageAlignedLength == range.first) {
+        mem_segments.back().pageAlignedLength += range.second.length;
+        continue;
+      }
+      mem_segments.push_back(
+          MySharedMemory((void*) range.first, range.second.length,
+                         process.first));
+    }
+  }
+  update_be_segments(mem_segments);
+  LDEBUGF("Segment table: %lu segments of %lu BEs", mem_segments.size(),
+          segment_table.size());
+  return true;
+}
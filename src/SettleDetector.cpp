@@ -0,0 +1,199 @@
+/*
+ * SettleDetector.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/SettleDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/ChangeDetector.hpp"
+#include "include/Histogram.hpp"
+#include "include/Logger.hpp"
+#include "include/Plant.hpp"
+#include "include/Timeline.hpp"
+#include "include/Utilities.hpp"
+
+extern double noise_allowed;
+
+static const char *action_names[] = { "MBA", "LLC", "RATIO" };
+static const char *settle_span_names[] = { "settle MBA", "settle LLC",
+    "settle RATIO" };
+static Histogram settle_hist[SETTLE_MAX_ACTIONS];
+static double settle_estimate[SETTLE_MAX_ACTIONS];
+static unsigned long settle_timeouts[SETTLE_MAX_ACTIONS];
+// whether each HP source (memcached, xapian) has reported a latency
+static bool latency_seen[2];
+
+SettleDetector::SettleDetector(useconds_t period, useconds_t dead_time,
+                               useconds_t max_wait, size_t window,
+                               double tolerance)
+    : _period(period),
+      _dead_time(dead_time),
+      _max_wait(max_wait),
+      _window(window),
+      _tolerance(tolerance),
+      _state(IDLE),
+      _elapsed(0) {
+}
+
+void SettleDetector::start() {
+  _state = DEAD_TIME;
+  _elapsed = 0;
+  windows.clear();
+}
+
+SettleDetector::State SettleDetector::step(const std::vector<double> &sample) {
+  if (_state == IDLE || done()) {
+    return _state;
+  }
+
+  _elapsed += _period;
+  if (_elapsed >= _max_wait) {
+    return _state = TIMED_OUT;
+  }
+  if (_state == DEAD_TIME) {
+    if (_elapsed < _dead_time) {
+      return _state;
+    }
+    _state = WATCHING;
+  }
+
+  windows.resize(sample.size());
+  bool stable = true;
+  for (size_t i = 0; i < sample.size(); i++) {
+    windows.at(i).push_back(sample.at(i));
+    if (windows.at(i).size() > _window) {
+      windows.at(i).pop_front();
+    }
+    stable = stable && is_stable(windows.at(i));
+  }
+  if (stable) {
+    _state = SETTLED;
+  }
+
+  return _state;
+}
+
+/*
+ * A signal is stable if it spans less than the tolerance around its mean
+ * and the two halves of the window do not drift apart. The invalid samples
+ * (inf, nan) are left out, a signal without a valid sample in the window is
+ * unavailable (e.g., counters disabled) and does not hold us back.
+ */
+bool SettleDetector::is_stable(const std::deque<double> &w) const {
+  if (w.size() < _window) {
+    return false;
+  }
+
+  std::vector<double> valid;
+  for (double v : w) {
+    if (!std::isinf(v) && !std::isnan(v)) {
+      valid.push_back(v);
+    }
+  }
+  if (valid.empty()) {
+    return true;
+  }
+  if (valid.size() < 2) {
+    return false;
+  }
+
+  double sum = 0, first = 0, second = 0;
+  double lo = valid.front(), hi = valid.front();
+  for (size_t i = 0; i < valid.size(); i++) {
+    sum += valid.at(i);
+    lo = std::min(lo, valid.at(i));
+    hi = std::max(hi, valid.at(i));
+    if (i < valid.size() / 2) {
+      first += valid.at(i);
+    } else {
+      second += valid.at(i);
+    }
+  }
+
+  // a signal stuck at 0 has no data (e.g., no latency sample)
+  double mean = sum / valid.size();
+  if (mean == 0) {
+    return false;
+  }
+  first /= valid.size() / 2;
+  second /= valid.size() - valid.size() / 2;
+
+  return (hi - lo) / std::fabs(mean) <= _tolerance
+      && std::fabs(second - first) / std::fabs(mean) <= _tolerance / 2;
+}
+
+useconds_t wait_settle(settle_action action) {
+  // the p99 of the HP is taken over a sliding window, until a full window
+  // has passed since the action it still holds samples from before it and
+  // looks flat
+  useconds_t dead_time = std::max(settle_dead_time, latency_window);
+  SettleDetector detector(settle_period, dead_time, settle_max_wait,
+                          settle_window, noise_allowed);
+  std::vector<double> sample;
+
+  actuator_commit();
+  TimelineSpan span("settle", settle_span_names[action]);
+  detector.start();
+
+  uint64_t next = plant->now();
+  while (!detector.done()) {
+    next += settle_period;
+    plant->sleep_until(next);
+
+    // latency of every HP source, plus the stall rates if counters are on;
+    // a source that never reported a latency (not running) is unavailable
+    sample.clear();
+    double latency[2] = { get_latest_percentile_latency(),
+        get_latest_percentile_latency_xpn() };
+    for (int i = 0; i < 2; i++) {
+      latency_seen[i] = latency_seen[i] || latency[i] > 0;
+      sample.push_back(latency_seen[i] ? latency[i] : NAN);
+    }
+    if (plant->has_counters()) {
+      std::vector<double> sr = plant->stall_rate();
+      sample.insert(sample.end(), sr.begin(), sr.end());
+    }
+    detector.step(sample);
+  }
+
+  // the plant has moved because of us, not because of the workload
+  rearm_phase_detection();
+
+  useconds_t t = detector.elapsed();
+  span.arg("timed_out", detector.state() == SettleDetector::TIMED_OUT);
+  settle_hist[action].add(t);
+  settle_estimate[action] =
+      settle_estimate[action] == 0 ? t : 0.8 * settle_estimate[action] + 0.2 * t;
+  if (detector.state() == SettleDetector::TIMED_OUT) {
+    settle_timeouts[action]++;
+    LDEBUGF("%s action did not settle within %u ms", action_names[action],
+            settle_max_wait / 1000);
+  } else {
+    LDEBUGF("%s action settled in %u ms (estimate %.0lf ms)",
+            action_names[action], t / 1000, settle_estimate[action] / 1000);
+  }
+
+  return t;
+}
+
+double get_settle_estimate(settle_action action) {
+  return settle_estimate[action];
+}
+
+void set_settle_estimate(settle_action action, double estimate) {
+  settle_estimate[action] = estimate;
+}
+
+void settle_print_stats() {
+  for (int i = 0; i < SETTLE_MAX_ACTIONS; i++) {
+    LINFOF("%s settle time: estimate %.0lf us, %lu timeouts", action_names[i],
+           settle_estimate[i], settle_timeouts[i]);
+    settle_hist[i].print(action_names[i], "us");
+  }
+}
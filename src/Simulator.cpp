@@ -0,0 +1,252 @@
+/*
+ * Simulator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+
+/////////////////////////////////////////////
+// provide this in a config
+double sim_base_latency = 0.6;  // HP p99 without contention (x target)
+double sim_latency_gain = 1.0;
+double sim_saturation = 0.7;  // the latency diverges as it approaches 1/x
+double sim_remote_penalty = 0.3;  // BE slowdown with all its pages remote
+double sim_llc_sensitivity = 0.2;  // share of the interference due to the L3
+useconds_t sim_tau_mba = 50000;
+useconds_t sim_tau_llc = 300000;
+useconds_t sim_migration_cost = 20000;  // per % of the BE pages moved
+double sim_migration_traffic = 0.3;
+double sim_noise = 0.03;
+double sim_noise_correlation = 0.9;
+unsigned sim_llc_ways = 11;
+////////////////////////////////////////////
+
+// index and weight of x between two points of a sorted axis
+static size_t interpolate(const std::vector<int> &axis, double x,
+                          double *weight) {
+  if (axis.size() == 1 || x <= axis.front()) {
+    *weight = 0;
+    return 0;
+  }
+  if (x >= axis.back()) {
+    *weight = 1;
+    return axis.size() - 2;
+  }
+  size_t i = 0;
+  while (axis.at(i + 1) < x) {
+    i++;
+  }
+  *weight = (x - axis.at(i)) / (axis.at(i + 1) - axis.at(i));
+  return i;
+}
+
+SimulatedPlant::SimulatedPlant()
+    : VirtualPlant(sim_duration * 1000000UL),
+      rng(sim_seed),
+      normal(0, 1),
+      contention(0),
+      llc_share(1),
+      be_memory(0),
+      migrating_until(0),
+      noise(0),
+      noise_xpn(0) {
+  // the platform: the default MBA levels and L3 ways without the hardware
+  discover_mba_levels();
+  set_llc_ways(sim_llc_ways);
+  _mba = get_max_mba();
+  _llc_ways = get_max_llc_ways();
+
+  std::stringstream ss(sim_phases);
+  std::string tok;
+  while (getline(ss, tok, ',')) {
+    phases.push_back(std::min(1.0, std::max(0.0, atof(tok.c_str()))));
+  }
+  if (phases.empty()) {
+    phases.push_back(1);
+  }
+  if (!sim_table.empty()) {
+    load_table(sim_table);
+  }
+
+  // start in the steady state of the initial configuration
+  be_memory = be_memory_throughput(_mba, _ratio, _llc_ways);
+  contention = contention_target();
+
+  LINFOF("Simulating %d sec, %lu BE phases of %d sec, %s BE throughput",
+         sim_duration, phases.size(), sim_phase_length,
+         table.empty() ? "parametric" : "measured");
+}
+
+/*
+ * A table in the layout of test/mba_logs_processor.py: a first row with
+ * the remote ratios (after a label), then one row per MBA level with the
+ * BE throughput (e.g., IPC) at every ratio
+ */
+void SimulatedPlant::load_table(const std::string &path) {
+  std::ifstream f(path);
+  std::string line, label;
+  if (!f.is_open() || !getline(f, line)) {
+    LINFOF("Unable to read the BE throughput table %s", path.c_str());
+    exit(EXIT_FAILURE);
+  }
+  std::stringstream header(line);
+  int value;
+  header >> label;
+  while (header >> value) {
+    table_ratios.push_back(value);
+  }
+
+  double max = 0;
+  while (getline(f, line)) {
+    std::stringstream row(line);
+    int mba;
+    if (!(row >> mba)) {
+      continue;
+    }
+    std::vector<double> values;
+    double v;
+    while (row >> v) {
+      values.push_back(v);
+      max = std::max(max, v);
+    }
+    if (values.size() != table_ratios.size()) {
+      LINFOF("MBA %d: %lu values for %lu ratios in %s", mba, values.size(),
+             table_ratios.size(), path.c_str());
+      exit(EXIT_FAILURE);
+    }
+    table_mbas.push_back(mba);
+    table.push_back(values);
+  }
+  if (table.empty() || max <= 0) {
+    LINFOF("Empty BE throughput table %s", path.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  // sort the rows by MBA level and normalize to the best configuration
+  std::vector<size_t> order(table_mbas.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order.at(i) = i;
+  }
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return table_mbas.at(a) < table_mbas.at(b);
+  });
+  std::vector<int> mbas;
+  std::vector<std::vector<double>> rows;
+  for (size_t i : order) {
+    mbas.push_back(table_mbas.at(i));
+    rows.push_back(table.at(i));
+    for (double &v : rows.back()) {
+      v /= max;
+    }
+  }
+  table_mbas = mbas;
+  table = rows;
+  if (!std::is_sorted(table_ratios.begin(), table_ratios.end())) {
+    LINFOF("The remote ratios of %s are not sorted", path.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  LINFOF("Loaded the BE throughput of %lu MBA levels x %lu ratios from %s",
+         table_mbas.size(), table_ratios.size(), path.c_str());
+}
+
+double SimulatedPlant::intensity() {
+  size_t phase = (_now / (sim_phase_length * 1000000UL)) % phases.size();
+  return phases.at(phase);
+}
+
+double SimulatedPlant::be_memory_throughput(int mba, int ratio, int ways) {
+  double llc = get_max_llc_ways() ? (double) ways / get_max_llc_ways() : 1;
+  double throughput;
+
+  if (!table.empty()) {
+    double wm, wr;
+    size_t i = interpolate(table_mbas, mba, &wm);
+    size_t j = interpolate(table_ratios, ratio, &wr);
+    size_t i1 = std::min(i + 1, table_mbas.size() - 1);
+    size_t j1 = std::min(j + 1, table_ratios.size() - 1);
+    throughput = (1 - wm) * ((1 - wr) * table[i][j] + wr * table[i][j1])
+        + wm * ((1 - wr) * table[i1][j] + wr * table[i1][j1]);
+  } else {
+    throughput = get_mba_bandwidth(mba) / get_mba_bandwidth(get_max_mba())
+        * (1 - sim_remote_penalty * ratio / 100.0);
+  }
+  // a smaller L3 share costs the BE some hits
+  return throughput * (1 - sim_llc_sensitivity / 2 * (1 - llc));
+}
+
+double SimulatedPlant::contention_target() {
+  // only the BE pages on the HP node contend, less so with a smaller L3
+  // share of the BE (it pollutes less of the HP working set)
+  double ratio = _now < migrating_until ? 0 : _ratio;
+  return intensity() * be_memory * (1 - ratio / 100.0)
+      * (1 - sim_llc_sensitivity * (1 - llc_share));
+}
+
+void SimulatedPlant::place_pages(const std::vector<MySharedMemory> &segments,
+                                 int ratio) {
+  int previous = _ratio;
+  VirtualPlant::place_pages(segments, ratio);
+  // the pages move in the background, the old placement holds until then
+  migrating_until = std::max(migrating_until, _now)
+      + std::abs(ratio - previous) * sim_migration_cost;
+}
+
+void SimulatedPlant::step(uint64_t dt) {
+  double a_mba = 1 - std::exp(-(double) dt / sim_tau_mba);
+  double a_llc = 1 - std::exp(-(double) dt / sim_tau_llc);
+  double llc = get_max_llc_ways() ? (double) _llc_ways / get_max_llc_ways() : 1;
+
+  llc_share += a_llc * (llc - llc_share);
+  be_memory += a_mba
+      * (be_memory_throughput(_mba, _ratio, _llc_ways) - be_memory);
+  contention += a_mba * (contention_target() - contention);
+
+  double innovation = std::sqrt(
+      1 - sim_noise_correlation * sim_noise_correlation) * sim_noise;
+  noise = sim_noise_correlation * noise + innovation * normal(rng);
+  noise_xpn = sim_noise_correlation * noise_xpn + innovation * normal(rng);
+}
+
+// p99 of an HP application relative to its target
+static double hp_latency(double contention) {
+  contention = std::min(1.0, contention);
+  return sim_base_latency
+      * (1 + sim_latency_gain * contention / (1 - sim_saturation * contention));
+}
+
+double SimulatedPlant::latency() {
+  double c = contention + (_now < migrating_until ? sim_migration_traffic : 0);
+  return target_slo * hp_latency(c) * std::exp(noise);
+}
+
+double SimulatedPlant::latency_xpn() {
+  double c = contention + (_now < migrating_until ? sim_migration_traffic : 0);
+  return target_slo_xapian * hp_latency(c) * std::exp(noise_xpn);
+}
+
+double SimulatedPlant::be_throughput() {
+  // the compute part of the BE is not affected
+  return 1 - intensity() + intensity() * be_memory;
+}
+
+std::vector<double> SimulatedPlant::stall_rate() {
+  std::vector<double> values(active_cpus, 0);
+  // the BE is the first monitored core, the HP the second
+  values.at(0) = 1 - be_throughput();
+  if (values.size() > 1) {
+    values.at(1) = 0.1 + 0.5 * std::min(1.0, contention);
+  }
+  return values;
+}
@@ -0,0 +1,265 @@
+/*
+ * Tenants.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Tenants.hpp"
+
+#include <time.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+#include "include/Plant.hpp"
+#include "pqos.h"
+
+std::vector<BeProcess> be_processes;
+
+static struct timespec last_poll;
+
+// "pid:priority,pid:priority", BEs not listed have priority 0
+static std::map<pid_t, int> parse_priorities(const std::string &s) {
+  std::map<pid_t, int> priorities;
+  std::stringstream ss(s);
+  std::string tok;
+  while (getline(ss, tok, ',')) {
+    size_t colon = tok.find(':');
+    if (colon == std::string::npos) {
+      LINFOF("Invalid BE priority %s, expected pid:priority", tok.c_str());
+      exit(EXIT_FAILURE);
+    }
+    priorities[stoi(tok.substr(0, colon))] = stoi(tok.substr(colon + 1));
+  }
+  return priorities;
+}
+
+// COS0 is the default class of the HP
+static unsigned get_max_cos() {
+  return std::max(1, get_num_mba_classes() - 1);
+}
+
+// the lowest class no BE is using, or the last class (shared)
+static unsigned get_free_cos(const std::vector<BeProcess> &processes) {
+  unsigned max_cos = get_max_cos();
+  for (unsigned cos = 1; cos < max_cos; cos++) {
+    if (std::none_of(processes.begin(), processes.end(),
+                     [cos](const BeProcess &be) {
+                       return be.cos == cos;
+                     })) {
+      return cos;
+    }
+  }
+  return max_cos;
+}
+
+static BeProcess new_be_process(pid_t pid,
+                                const std::vector<BeProcess> &processes) {
+  std::map<pid_t, int> priorities = parse_priorities(be_priorities);
+  BeProcess be = { };
+  be.pid = pid;
+  be.ratio = current_remote_ratio;
+  be.cos = get_free_cos(processes);
+  be.mba = get_max_mba();
+  // a BE joining the shared last class gets the throttling of the class
+  if (std::any_of(processes.begin(), processes.end(),
+                  [&be](const BeProcess &other) {
+                    return other.cos == be.cos;
+                  })) {
+    int mba = actuator_get(ACT_MBA, 0, be.cos);
+    if (mba != -1) {
+      be.mba = mba;
+    }
+  }
+  be.priority = priorities.count(pid) ? priorities[pid] : 0;
+  return be;
+}
+
+// associate the BE with its class (the BE cores are in COS1 already) and
+// start monitoring its bandwidth
+static void start_be_process(BeProcess &be) {
+  if (!plant_is_hardware()) {
+    return;
+  }
+  if (be.cos != 1 && pqos_alloc_assoc_set_pid(be.pid, be.cos) != PQOS_RETVAL_OK) {
+    LWARNF("Unable to associate BE %d with COS%u (OS interface only), "
+           "associate its cores", be.pid, be.cos);
+  }
+  be.mon = (struct pqos_mon_data*) calloc(1, sizeof(struct pqos_mon_data));
+  if (pqos_mon_start_pid(
+      be.pid, (enum pqos_mon_event) (PQOS_MON_EVENT_LMEM_BW
+          | PQOS_MON_EVENT_TMEM_BW),
+      NULL, be.mon) != PQOS_RETVAL_OK) {
+    LWARNF("Unable to monitor the memory bandwidth of BE %d, estimating it",
+           be.pid);
+    free(be.mon);
+    be.mon = NULL;
+  }
+}
+
+static void stop_be_process(BeProcess &be) {
+  if (be.mon != NULL) {
+    pqos_mon_stop(be.mon);
+    free(be.mon);
+    be.mon = NULL;
+  }
+}
+
+void initialize_be_processes(const std::vector<MySharedMemory> &segments) {
+  update_be_segments(segments);
+  // the virtual plants model a single BE without segments
+  if (be_processes.empty() && !plant_is_hardware()) {
+    be_processes.push_back(new_be_process(0, be_processes));
+  }
+  clock_gettime(CLOCK_MONOTONIC, &last_poll);
+
+  if (be_processes.size() > get_max_cos()) {
+    LWARNF("%lu BEs for %u MBA classes, the last class is shared",
+           be_processes.size(), get_max_cos());
+  }
+  print_be_processes();
+}
+
+void update_be_segments(const std::vector<MySharedMemory> &segments) {
+  std::vector<BeProcess> previous;
+  previous.swap(be_processes);
+
+  for (size_t i = 0; i < segments.size(); i++) {
+    const MySharedMemory &segment = segments.at(i);
+    auto it = std::find_if(be_processes.begin(), be_processes.end(),
+                           [&segment](const BeProcess &be) {
+                             return be.pid == segment.processID;
+                           });
+    if (it == be_processes.end()) {
+      auto old = std::find_if(previous.begin(), previous.end(),
+                              [&segment](const BeProcess &be) {
+                                return be.pid == segment.processID;
+                              });
+      if (old != previous.end()) {
+        // keep the state of a known BE
+        be_processes.push_back(*old);
+        be_processes.back().segments.clear();
+        be_processes.back().bytes = 0;
+        old->mon = NULL;
+      } else {
+        be_processes.push_back(new_be_process(segment.processID,
+                                              be_processes));
+        start_be_process(be_processes.back());
+        LINFOF("New BE %d in COS%u", segment.processID,
+               be_processes.back().cos);
+      }
+      it = be_processes.end() - 1;
+    }
+    it->segments.push_back(segment);
+    it->bytes += segment.pageAlignedLength;
+  }
+
+  // the BEs without segments left
+  for (BeProcess &be : previous) {
+    if (std::none_of(be_processes.begin(), be_processes.end(),
+                     [&be](const BeProcess &other) {
+                       return other.pid == be.pid;
+                     })) {
+      LINFOF("BE %d is gone", be.pid);
+      stop_be_process(be);
+    }
+  }
+}
+
+void finalize_be_processes() {
+  for (BeProcess &be : be_processes) {
+    stop_be_process(be);
+  }
+}
+
+void update_be_bandwidth() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed = (now.tv_sec - last_poll.tv_sec)
+      + (now.tv_nsec - last_poll.tv_nsec) / 1e9;
+  last_poll = now;
+
+  unsigned long total_bytes = 0;
+  for (BeProcess &be : be_processes) {
+    total_bytes += be.bytes;
+  }
+
+  for (BeProcess &be : be_processes) {
+    if (be.mon != NULL && elapsed > 0
+        && pqos_mon_poll(&be.mon, 1) == PQOS_RETVAL_OK) {
+      be.bandwidth = be.mon->values.mbm_total_delta / elapsed / 1e6;
+      be.local_bandwidth = be.mon->values.mbm_local_delta / elapsed / 1e6;
+    } else {
+      // the footprint share of what the MBA level lets through
+      be.bandwidth = get_mba_bandwidth(be.mba)
+          * (total_bytes ? (double) be.bytes / total_bytes : 1);
+      be.local_bandwidth = be.bandwidth * (1 - be.ratio / 100.0);
+    }
+  }
+}
+
+void set_be_mba(BeProcess &be, int mba_value) {
+  actuator_request(ACT_MBA, 0, be.cos, mba_value);
+  // the class may be shared with other BEs
+  for (BeProcess &other : be_processes) {
+    if (other.cos == be.cos) {
+      other.mba = mba_value;
+    }
+  }
+  LINFOF("BE %d: MBA of COS%u => %d", be.pid, be.cos, mba_value);
+}
+
+void set_be_ratio(BeProcess &be, int ratio) {
+  plant->place_pages(be.segments, ratio);
+  be.ratio = ratio;
+  LINFOF("BE %d: remote ratio => %d", be.pid, ratio);
+}
+
+BeProcess* arbiter_pick_victim() {
+  BeProcess *victim = NULL;
+  double best = -1;
+
+  for (BeProcess &be : be_processes) {
+    if (be.mba == get_min_mba() && be.ratio >= 100) {
+      continue;
+    }
+    double score = be.local_bandwidth / (1 + std::max(0, be.priority));
+    if (score > best) {
+      best = score;
+      victim = &be;
+    }
+  }
+  return victim;
+}
+
+BeProcess* arbiter_pick_release() {
+  BeProcess *release = NULL;
+
+  for (BeProcess &be : be_processes) {
+    if (be.mba == get_max_mba()) {
+      continue;
+    }
+    if (release == NULL || be.priority > release->priority
+        || (be.priority == release->priority
+            && be.local_bandwidth < release->local_bandwidth)) {
+      release = &be;
+    }
+  }
+  return release;
+}
+
+void print_be_processes() {
+  for (const BeProcess &be : be_processes) {
+    LINFOF("BE %d: %lu segments (%lu MB), priority %d, COS%u, mba %d, "
+           "ratio %d, bandwidth %.0lf MB/s (%.0lf MB/s to the HP node)%s",
+           be.pid, be.segments.size(), be.bytes >> 20, be.priority, be.cos,
+           be.mba, be.ratio, be.bandwidth, be.local_bandwidth,
+           be.mon ? "" : " (estimated)");
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ * TimeSeries.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/TimeSeries.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+
+static std::mutex ts_mutex;  // the measurement thread and the control loop
+static int ts_fd = -1;
+static TimeSeriesHeader ts_header;
+// the chunk being filled and the next one
+static char *ts_buffers[2];
+static int ts_current;
+static uint64_t ts_next_index;
+
+static void ts_map_chunk(int slot, uint64_t index) {
+  uint64_t position =
+      ts_header.max_chunks == 0 ? index : index % ts_header.max_chunks;
+  off_t offset = TS_HEADER_SIZE + position * ts_header.chunk_size;
+  struct stat st;
+  if (fstat(ts_fd, &st) == -1
+      || (st.st_size < (off_t) (offset + ts_header.chunk_size)
+          && ftruncate(ts_fd, offset + ts_header.chunk_size) == -1)) {
+    LERRORF("Failed to extend the time series %s: %s",
+            timeseries_file.c_str(), strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  void *chunk = mmap(NULL, ts_header.chunk_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, ts_fd, offset);
+  if (chunk == MAP_FAILED) {
+    LERRORF("Failed to map the time series %s: %s", timeseries_file.c_str(),
+            strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  // a reused chunk is emptied before it is renamed
+  TimeSeriesChunk *c = (TimeSeriesChunk*) chunk;
+  __atomic_store_n(&c->rows, 0, __ATOMIC_RELEASE);
+  c->index = index;
+  c->magic = TS_MAGIC;
+  ts_buffers[slot] = (char*) chunk;
+}
+
+void open_timeseries() {
+  if (timeseries_file.empty()) {
+    return;
+  }
+  // two chunks are mapped at a time, they must be distinct
+  if (timeseries_max_chunks < 0 || timeseries_max_chunks == 1) {
+    LERRORF("TIMESERIES_MAX_CHUNKS must be 0 or at least 2, not %d",
+            timeseries_max_chunks);
+    exit(EXIT_FAILURE);
+  }
+  // the previous run (maybe the one that crashed) is kept as <file>.1
+  std::string old = timeseries_file + ".1";
+  if (rename(timeseries_file.c_str(), old.c_str()) == 0) {
+    LINFOF("The previous time series is kept as %s", old.c_str());
+  } else if (errno != ENOENT) {
+    LERRORF("Failed to keep the previous time series as %s: %s", old.c_str(),
+            strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  ts_fd = open(timeseries_file.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (ts_fd == -1) {
+    LERRORF("Failed to open the time series %s: %s", timeseries_file.c_str(),
+            strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  // the columns, one after the other in a chunk, 8-byte aligned
+  memset(&ts_header, 0, sizeof(ts_header));
+  ts_header.magic = TS_MAGIC;
+  ts_header.version = TS_VERSION;
+  ts_header.ncolumns = sizeof(ts_columns) / sizeof(ts_columns[0]);
+  ts_header.chunk_rows = TS_CHUNK_ROWS;
+  ts_header.max_chunks = timeseries_max_chunks;
+  uint64_t offset = sizeof(TimeSeriesChunk);
+  for (uint32_t i = 0; i < ts_header.ncolumns; i++) {
+    ts_header.columns[i] = ts_columns[i];
+    ts_header.columns[i].offset = offset;
+    offset += (ts_columns[i].size * TS_CHUNK_ROWS + 7) & ~7ULL;
+  }
+  ts_header.chunk_size = (offset + 4095) & ~4095ULL;
+  if (pwrite(ts_fd, &ts_header, sizeof(ts_header), 0)
+      != (ssize_t) sizeof(ts_header)) {
+    LERRORF("Failed to write the time series %s: %s", timeseries_file.c_str(),
+            strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  ts_map_chunk(0, 0);
+  ts_map_chunk(1, 1);
+  ts_current = 0;
+  ts_next_index = 2;
+  LINFOF("Recording the time series to %s (%lu rows per chunk of %lu KB)",
+         timeseries_file.c_str(), ts_header.chunk_rows,
+         ts_header.chunk_size >> 10);
+}
+
+void timeseries_record(const TimeSeriesRow &row) {
+  std::lock_guard<std::mutex> lock(ts_mutex);
+  if (ts_fd == -1) {
+    return;
+  }
+  TimeSeriesChunk *chunk = (TimeSeriesChunk*) ts_buffers[ts_current];
+  if (chunk->rows == ts_header.chunk_rows) {
+    // switch to the next chunk, then map the one after it in its place
+    int full = ts_current;
+    ts_current = 1 - ts_current;
+    chunk = (TimeSeriesChunk*) ts_buffers[ts_current];
+    munmap(ts_buffers[full], ts_header.chunk_size);
+    ts_map_chunk(full, ts_next_index++);
+  }
+
+  uint32_t i = chunk->rows;
+  for (uint32_t c = 0; c < ts_header.ncolumns; c++) {
+    const TimeSeriesColumn &column = ts_header.columns[c];
+    memcpy(
+        ts_buffers[ts_current] + column.offset + (uint64_t) i * column.size,
+        (const char*) &row + column.row_offset, column.size);
+  }
+  // the row is visible to the readers once it is complete
+  __atomic_store_n(&chunk->rows, i + 1, __ATOMIC_RELEASE);
+}
+
+void close_timeseries() {
+  std::lock_guard<std::mutex> lock(ts_mutex);
+  if (ts_fd == -1) {
+    return;
+  }
+  for (int slot = 0; slot < 2; slot++) {
+    msync(ts_buffers[slot], ts_header.chunk_size, MS_SYNC);
+    munmap(ts_buffers[slot], ts_header.chunk_size);
+  }
+  close(ts_fd);
+  ts_fd = -1;
+}
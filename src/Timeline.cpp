@@ -0,0 +1,161 @@
+/*
+ * Timeline.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Timeline.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/Plant.hpp"
+
+bool timeline_enabled = false;
+
+static std::mutex timeline_mutex;
+static FILE *timeline = NULL;
+static unsigned long timeline_events = 0;
+
+static uint64_t timeline_now() {
+  if (plant != NULL) {
+    return plant->now();
+  }
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+static int timeline_tid() {
+  static thread_local int tid = syscall(SYS_gettid);
+  return tid;
+}
+
+static void append_args(std::string &out, timeline_args args) {
+  char buf[96];
+  for (auto &a : args) {
+    snprintf(buf, sizeof(buf), "%s\"%s\":%.10g", out.empty() ? "" : ",",
+             a.first, a.second);
+    out += buf;
+  }
+}
+
+// a new file, with the name of the process
+static void timeline_start_file() {
+  timeline = fopen(timeline_file.c_str(), "w");
+  if (timeline == NULL) {
+    LERRORF("Failed to open the timeline %s: %s", timeline_file.c_str(),
+            strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  fprintf(timeline,
+          "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"name\":\"BwManager (%s plant)\"}}",
+          getpid(), plant != NULL ? plant->name() : "hardware");
+  timeline_events = 0;
+}
+
+static void timeline_end_file() {
+  fprintf(timeline, "\n]\n");
+  fclose(timeline);
+  timeline = NULL;
+}
+
+static void timeline_write(const char *ph, const char *cat, const char *name,
+                           uint64_t ts, int64_t dur, const std::string &args) {
+  std::lock_guard<std::mutex> lock(timeline_mutex);
+  if (timeline == NULL) {
+    return;
+  }
+  if (timeline_events == (unsigned long) timeline_max_events) {
+    timeline_end_file();
+    std::string old = timeline_file + ".1";
+    rename(timeline_file.c_str(), old.c_str());
+    timeline_start_file();
+  }
+  fprintf(timeline,
+          ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%lu,",
+          name, cat, ph, ts);
+  if (dur >= 0) {
+    fprintf(timeline, "\"dur\":%ld,", dur);
+  }
+  if (ph[0] == 'i') {
+    fprintf(timeline, "\"s\":\"t\",");
+  }
+  fprintf(timeline, "\"pid\":%d,\"tid\":%d,\"args\":{%s}}", getpid(),
+          timeline_tid(), args.c_str());
+  timeline_events++;
+}
+
+void open_timeline() {
+  if (timeline_file.empty()) {
+    return;
+  }
+  timeline_start_file();
+  timeline_enabled = true;
+  // the plants may exit from anywhere
+  atexit(close_timeline);
+  LINFOF("Timeline to %s (%d events per file)", timeline_file.c_str(),
+         timeline_max_events);
+}
+
+void close_timeline() {
+  std::lock_guard<std::mutex> lock(timeline_mutex);
+  timeline_enabled = false;
+  if (timeline != NULL) {
+    timeline_end_file();
+  }
+}
+
+void timeline_instant(const char *cat, const char *name, timeline_args args) {
+  if (!timeline_enabled) {
+    return;
+  }
+  std::string a;
+  append_args(a, args);
+  timeline_write("i", cat, name, timeline_now(), -1, a);
+}
+
+void timeline_counter(const char *name, timeline_args args) {
+  if (!timeline_enabled) {
+    return;
+  }
+  std::string a;
+  append_args(a, args);
+  timeline_write("C", "sensor", name, timeline_now(), -1, a);
+}
+
+TimelineSpan::TimelineSpan(const char *cat, const char *name,
+                           timeline_args args)
+    : _cat(cat),
+      _name(name),
+      _active(timeline_enabled),
+      _start(0) {
+  if (!_active) {
+    return;
+  }
+  _start = timeline_now();
+  append_args(_args, args);
+}
+
+TimelineSpan::~TimelineSpan() {
+  if (!_active || !timeline_enabled) {
+    return;
+  }
+  uint64_t end = timeline_now();
+  timeline_write("X", _cat, _name, _start, end - _start, _args);
+}
+
+void TimelineSpan::arg(const char *key, double value) {
+  if (_active) {
+    append_args(_args, { { key, value } });
+  }
+}
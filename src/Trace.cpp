@@ -0,0 +1,91 @@
+/*
+ * Trace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/Trace.hpp"
+
+#include <stdio.h>
+
+#include "include/Logger.hpp"
+
+static FILE *trace_file = NULL;
+static unsigned long trace_records = 0;
+// the records are small, buffer them to keep the control loop off the disk
+static const size_t trace_buffer_size = 1 << 20;
+
+bool trace_open(const std::string &path, const trace_header &header) {
+  trace_file = fopen(path.c_str(), "wb");
+  if (trace_file == NULL) {
+    LINFOF("Unable to create the trace file %s", path.c_str());
+    return false;
+  }
+  setvbuf(trace_file, NULL, _IOFBF, trace_buffer_size);
+  if (fwrite(&header, sizeof(header), 1, trace_file) != 1) {
+    LINFOF("Unable to write the trace header to %s", path.c_str());
+    fclose(trace_file);
+    trace_file = NULL;
+    return false;
+  }
+  trace_records = 0;
+  LINFOF("Recording the trace to %s", path.c_str());
+  return true;
+}
+
+bool trace_is_open() {
+  return trace_file != NULL;
+}
+
+void trace_write(uint64_t t, trace_kind kind, uint32_t index, double value) {
+  if (trace_file == NULL) {
+    return;
+  }
+  trace_record record = { t, (uint32_t) kind, index, value };
+  if (fwrite(&record, sizeof(record), 1, trace_file) != 1) {
+    LWARN("Unable to write to the trace, stop recording");
+    trace_close();
+    return;
+  }
+  trace_records++;
+}
+
+void trace_close() {
+  if (trace_file == NULL) {
+    return;
+  }
+  fclose(trace_file);
+  trace_file = NULL;
+  LINFOF("Trace closed (%lu records)", trace_records);
+}
+
+bool trace_read(const std::string &path, trace_header *header,
+                std::vector<trace_record> *records) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == NULL) {
+    LINFOF("Unable to open the trace file %s", path.c_str());
+    return false;
+  }
+  if (fread(header, sizeof(*header), 1, f) != 1
+      || header->magic != TRACE_MAGIC || header->version != TRACE_VERSION) {
+    LINFOF("%s is not a valid trace", path.c_str());
+    fclose(f);
+    return false;
+  }
+
+  trace_record record;
+  records->clear();
+  while (fread(&record, sizeof(record), 1, f) == 1) {
+    if (record.kind >= TRACE_MAX_KINDS) {
+      LINFOF("Invalid record kind %u in %s", record.kind, path.c_str());
+      fclose(f);
+      return false;
+    }
+    records->push_back(record);
+  }
+  fclose(f);
+
+  LINFOF("Loaded %lu records (%.1lf sec) from %s", records->size(),
+         records->empty() ? 0.0 : records->back().t / 1e6, path.c_str());
+  return true;
+}
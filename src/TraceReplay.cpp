@@ -0,0 +1,247 @@
+/*
+ * TraceReplay.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/TraceReplay.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "include/BwManager.hpp"
+#include "include/Logger.hpp"
+#include "include/MbaHandler.hpp"
+
+/////////////////////////////////////////////
+// provide this in a config
+uint64_t fit_skip = 100000;  // samples right after an action are transient
+extern useconds_t virtual_period;
+////////////////////////////////////////////
+
+/*
+ * Load a trace and set up the platform it was recorded on
+ * returns the duration of the trace
+ */
+static uint64_t load_trace(const std::string &path, trace_header *header,
+                           std::vector<trace_record> *records) {
+  if (path.empty()) {
+    LINFO("No trace to replay (TRACE_REPLAY)");
+    exit(EXIT_FAILURE);
+  }
+  if (!trace_read(path, header, records) || records->empty()) {
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<int> levels;
+  std::vector<double> bandwidth;
+  for (size_t i = 0; i < records->size(); i++) {
+    const trace_record &r = records->at(i);
+    if (r.kind == TRACE_MBA_LEVEL) {
+      levels.push_back(r.index);
+      bandwidth.push_back(r.value);
+    } else if (r.kind == TRACE_LLC_WAYS) {
+      set_llc_ways(r.value);
+    }
+  }
+  set_mba_levels(levels, bandwidth);
+
+  LINFOF("Trace: target slo %.0lf, xapian %.0lf, remote ratio %d, mba %d, " "%u cores, %lu MBA levels, %d L3 ways", header->target_slo,
+         header->target_slo_xapian, header->remote_ratio, header->mba,
+         header->num_cores, levels.size(), get_max_llc_ways());
+
+  return records->back().t;
+}
+
+/*
+ * TracePlant
+ */
+TracePlant::TracePlant(const std::string &path)
+    : VirtualPlant(0),
+      cursor(0),
+      counters(false),
+      last_latency(0),
+      last_latency_xpn(0) {
+  _duration = load_trace(path, &header, &records);
+  _mba = get_max_mba();
+  _llc_ways = get_max_llc_ways();
+  last_stall_rate.assign(header.num_cores, 0);
+  for (size_t i = 0; i < records.size() && !counters; i++) {
+    counters = records.at(i).kind == TRACE_STALL_RATE;
+  }
+}
+
+void TracePlant::seek() {
+  while (cursor < records.size() && records.at(cursor).t <= _now) {
+    const trace_record &r = records.at(cursor++);
+    switch (r.kind) {
+      case TRACE_LATENCY:
+        last_latency = r.value;
+        break;
+      case TRACE_LATENCY_XPN:
+        last_latency_xpn = r.value;
+        break;
+      case TRACE_STALL_RATE:
+        if (r.index < last_stall_rate.size()) {
+          last_stall_rate.at(r.index) = r.value;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+double TracePlant::latency() {
+  seek();
+  return last_latency;
+}
+
+double TracePlant::latency_xpn() {
+  seek();
+  return last_latency_xpn;
+}
+
+bool TracePlant::has_counters() {
+  return counters;
+}
+
+std::vector<double> TracePlant::stall_rate() {
+  seek();
+  return last_stall_rate;
+}
+
+/*
+ * FittedPlant
+ */
+FittedPlant::FittedPlant(const std::string &path)
+    : VirtualPlant(0),
+      counters(false),
+      ticks(0) {
+  std::vector<trace_record> records;
+  _duration = load_trace(path, &header, &records);
+  _mba = get_max_mba();
+  _llc_ways = get_max_llc_ways();
+
+  // walk the trace keeping track of the active configuration
+  Config config(header.remote_ratio, header.mba, get_max_llc_ways());
+  uint64_t changed = 0;
+  unsigned long used = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    const trace_record &r = records.at(i);
+    switch (r.kind) {
+      case TRACE_MBA:
+        if (TRACE_COS(r.index) == 1) {
+          std::get<1>(config) = r.value;
+          changed = r.t;
+        }
+        continue;
+      case TRACE_LLC:
+        if (TRACE_COS(r.index) == 1) {
+          std::get<2>(config) = r.value;
+          changed = r.t;
+        }
+        continue;
+      case TRACE_RATIO:
+        std::get<0>(config) = r.value;
+        changed = r.t;
+        continue;
+      case TRACE_LATENCY:
+      case TRACE_LATENCY_XPN:
+      case TRACE_STALL_RATE:
+        break;
+      default:
+        continue;
+    }
+    if (r.t < changed + fit_skip) {
+      continue;
+    }
+    // the controller reads the same sample several times per period, keep
+    // one per measurement period
+    Samples &samples = cells[config][Series(r.kind, r.index)];
+    if (!samples.values.empty() && r.t < samples.last_t + virtual_period) {
+      continue;
+    }
+    samples.values.push_back(r.value);
+    samples.last_t = r.t;
+    counters = counters || r.kind == TRACE_STALL_RATE;
+    used++;
+  }
+
+  if (cells.empty()) {
+    LINFO("No samples to fit the plant to");
+    exit(EXIT_FAILURE);
+  }
+  LINFOF("Fitted %lu configurations with %lu samples", cells.size(), used);
+  for (auto &it : cells) {
+    auto lat = it.second.find(Series(TRACE_LATENCY, 0));
+    LDEBUGF("ratio %d, mba %d, ways %d: %lu latency samples",
+            std::get<0>(it.first), std::get<1>(it.first),
+            std::get<2>(it.first),
+            lat == it.second.end() ? 0 : lat->second.values.size());
+  }
+}
+
+FittedPlant::Samples* FittedPlant::lookup(trace_kind kind, uint32_t index) {
+  Series series(kind, index);
+  Samples *best = NULL;
+  double best_distance = std::numeric_limits<double>::infinity();
+
+  for (auto &it : cells) {
+    auto s = it.second.find(series);
+    if (s == it.second.end()) {
+      continue;
+    }
+    double distance = std::abs(std::get<0>(it.first) - _ratio)
+        / (double) ADAPTATION_STEP
+        + std::abs(std::get<1>(it.first) - _mba) / 10.0
+        + std::abs(std::get<2>(it.first) - _llc_ways);
+    if (distance < best_distance) {
+      best_distance = distance;
+      best = &s->second;
+    }
+  }
+  return best;
+}
+
+double FittedPlant::value(trace_kind kind, uint32_t index) {
+  Samples *samples = lookup(kind, index);
+  if (samples == NULL) {
+    return 0;
+  }
+  // walk the recorded samples in order to keep their autocorrelation
+  return samples->values.at(ticks % samples->values.size());
+}
+
+void FittedPlant::step(uint64_t dt) {
+  ticks++;
+}
+
+double FittedPlant::latency() {
+  return value(TRACE_LATENCY, 0);
+}
+
+double FittedPlant::latency_xpn() {
+  return value(TRACE_LATENCY_XPN, 0);
+}
+
+bool FittedPlant::has_counters() {
+  return counters;
+}
+
+std::vector<double> FittedPlant::stall_rate() {
+  std::vector<double> values(header.num_cores);
+  for (size_t i = 0; i < values.size(); i++) {
+    values.at(i) = value(TRACE_STALL_RATE, i);
+  }
+  return values;
+}
+
+double FittedPlant::be_throughput() {
+  if (counters) {
+    // the BE is the first monitored core
+    return 1 - value(TRACE_STALL_RATE, 0);
+  }
+  return VirtualPlant::be_throughput();
+}
@@ -7,13 +7,27 @@
 
 #include "include/Utilities.hpp"
 
+#include "include/Actuator.hpp"
 #include "include/BwManager.hpp"
+#include "include/ChangeDetector.hpp"
+#include "include/Checkpoint.hpp"
+#include "include/ControlServer.hpp"
 #include "include/Logger.hpp"
 #include "include/MbaHandler.hpp"
-#include "include/MyLogger.hpp"
+#include "include/Metrics.hpp"
 #include "include/MySharedMemory.hpp"
 #include "include/PagePlacement.hpp"
 #include "include/PerformanceCounters.hpp"
+#include "include/PerformanceModel.hpp"
+#include "include/PidController.hpp"
+#include "include/Plant.hpp"
+#include "include/Profiler.hpp"
+#include "include/SegmentRegistry.hpp"
+#include "include/SettleDetector.hpp"
+#include "include/Tenants.hpp"
+#include "include/TimeSeries.hpp"
+#include "include/Timeline.hpp"
+#include "include/WeightTuner.hpp"
 
 // for set precision
 #include <iomanip>
@@ -23,6 +37,7 @@
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/lexical_cast.hpp>
+#include <mutex>
 #include <thread>
 
 using boost::asio::ip::tcp;
@@ -43,11 +58,13 @@ bool optimization_complete = false;
 std::vector<double> stall_rate(active_cpus);
 std::vector<double> prev_stall_rate(active_cpus);
 std::vector<double> best_stall_rate(active_cpus);
-std::vector<double> percentile_samples;
+// the latest sample of the measurement thread (all in the time series)
+double latest_sample = 0;
 int violations_counter_f = 0;
 int violations_counter_t = 0;
 // same metrics for other xapian - hard-coded for now!
-std::vector<double> percentile_samples_xpn;
+double latest_sample_xpn = 0;
+std::mutex samples_mutex;
 int vlts_cnt_f = 0;
 int vlts_cnt_t = 0;
 // handle multiple LCAs, for now just 2
@@ -64,9 +81,6 @@ double slack;
 double slack_xpn;
 /////////////////////////////////////////////
 
-// For Logging purposes
-std::vector<MyLogger> my_logs;
-
 static int run = 1;
 // static int sleeptime = 1;
 useconds_t sleeptime = 20000;
@@ -83,12 +97,23 @@ void signalHandler(int signum) {
   LINFOF("Interrupt signal %d received", signum);
   // cleanup and close up stuff here
   // terminate program
-  destroy_shared_memory();
-  // stop_all_counters();
-  reset_mba();
+  if (plant_is_hardware()) {
+    close_checkpoint();
+    destroy_shared_memory();
+    close_segment_registry();
+    stop_control_server();
+    // stop_all_counters();
+    finalize_be_processes();
+    reset_mba();
+  }
+  finalize_plant();
   // print_logs();
   print_logs_v2();
-  print_to_file();
+  close_timeseries();
+  actuator_print_stats();
+  settle_print_stats();
+  profile_print_summary();
+  perf_model.print();
   run = 0;
   exit(signum);
 }
@@ -97,16 +122,47 @@ void terminateHandler() {
   LINFO("Terminate signal received!");
   // cleanup and close up stuff here
   // terminate program
-  destroy_shared_memory();
-  // stop_all_counters();
-  reset_mba();
+  if (plant_is_hardware()) {
+    close_checkpoint();
+    destroy_shared_memory();
+    close_segment_registry();
+    stop_control_server();
+    // stop_all_counters();
+    finalize_be_processes();
+    reset_mba();
+  }
+  finalize_plant();
   // print_logs();
   print_logs_v2();
-  print_to_file();
+  close_timeseries();
+  actuator_print_stats();
+  settle_print_stats();
+  profile_print_summary();
+  perf_model.print();
   run = 0;
   exit(EXIT_FAILURE);
 }
 
+/*
+ * Checked by the modes every period: apply the runtime control requests,
+ * save the checkpoint, hold while the controller is paused, return false to stop the mode (on
+ * exit or on a mode switch)
+ */
+static bool keep_running() {
+  control_apply_requests();
+  checkpoint_if_due();
+  metrics_publish();
+  profile_iteration();
+  while (run && control_paused() && !control_mode_requested()) {
+    plant->sleep(sleeptime);
+    control_apply_requests();
+    checkpoint_if_due();
+    metrics_publish();
+    profile_iteration();
+  }
+  return run && !control_mode_requested();
+}
+
 unsigned long time_diff(struct timeval *start, struct timeval *stop) {
   unsigned long sec_res = stop->tv_sec - start->tv_sec;
   unsigned long usec_res = stop->tv_usec - start->tv_usec;
@@ -120,9 +176,24 @@ std::vector<MySharedMemory> mem_segments;
 int iter = 0;
 
 void get_memory_segments() {
-  // First read the memory segments to be moved
+  // First read the memory segments to be moved, from the one-shot handoff
+  // or from the registration queue, whichever comes first
   LINFO("Waiting for the memory segments from BE");
-  mem_segments = get_shared_memory();
+  bool handoff = false;
+  while (mem_segments.empty()) {
+    std::vector<MySharedMemory> segments;
+    if (!handoff && try_get_shared_memory(segments)) {
+      handoff = true;
+      register_segments(segments);
+      // some sanity check
+      if (segments.size() == 0) {
+        LINFO("No segments found in the handoff, waiting for registrations");
+      }
+    }
+    if (!sync_segments()) {
+      usleep(100000);
+    }
+  }
 
   LINFOF("Number of Segments: %lu", mem_segments.size());
   //in case of mg.c.x
@@ -131,15 +202,12 @@ void get_memory_segments() {
    place_all_pages(mem_segments, current_remote_ratio);
    sleep(3);*/
 
-  // some sanity check
-  if (mem_segments.size() == 0) {
-    LINFO("No segments found! Exiting");
-    destroy_shared_memory();
-    stop_all_counters();
-    exit(EXIT_FAILURE);
-  }
+  initialize_stall_rates();
+  initialize_be_processes(mem_segments);
+}
 
-  // Initialize the best and previuos stall rates
+// Initialize the best and previuos stall rates
+void initialize_stall_rates() {
   int i;
   for (i = 0; i < active_cpus; i++) {
     prev_stall_rate.push_back(std::numeric_limits<double>::infinity());
@@ -150,6 +218,28 @@ void get_memory_segments() {
          best_stall_rate.at(BE), prev_stall_rate.at(BE));
 }
 
+/*
+ * One sample of every series watched by the phase change detector: the
+ * latency of every HP source, plus the stall rates if counters are on, plus
+ * the bandwidth of every BE monitored with MBM (the estimate without MBM
+ * only follows our own actions)
+ */
+static std::vector<double> get_phase_sample() {
+  std::vector<double> sample;
+  sample.push_back(current_latency);
+  sample.push_back(current_latency_xpn);
+  if (plant->has_counters()) {
+    sample.insert(sample.end(), stall_rate.begin(), stall_rate.end());
+  }
+  update_be_bandwidth();
+  for (const BeProcess &be : be_processes) {
+    if (be.mon != NULL) {
+      sample.push_back(be.bandwidth);
+    }
+  }
+  return sample;
+}
+
 /*
  * Split the execution time of the controller in monitoring periods of length T,
  * during which we monitor the stall rate of HP and BE
@@ -157,8 +247,10 @@ void get_memory_segments() {
  *
  */
 void abc_numa() {
+  int initial_remote_ratio = current_remote_ratio;
+
   LINFOF("Monitoring period: %d ms", sleeptime);
-  while (run) {
+  while (keep_running()) {
     // TODO: this can be inside the loop or outside the loop!
     // TODO: Define the operation region of the controller
     // LINFO("======================================================");
@@ -176,16 +268,45 @@ void abc_numa() {
     // for xapian, TODO: Make this dynamic
     current_latency_xpn = get_latest_percentile_latency_xpn();
     slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    if (plant->has_counters()) {
+      stall_rate = plant->stall_rate();
+    }
     // update the BE best stall rate
     //  best_stall_rate.at(BE) =
     //      std::min(best_stall_rate.at(BE), stall_rate.at(BE));
 
     // log the measurements for the debugging purposes!
-    std::string my_action = "iteration-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
 
+    // the workload changed phase: the ratio found for the old phase is
+    // stale, restart the ratio search from the initial ratio
+    if (detect_phase_change(get_phase_sample())) {
+      optimization_complete = false;
+      best_stall_rate.at(BE) = std::numeric_limits<double>::infinity();
+      if (current_remote_ratio != initial_remote_ratio
+          && optimal_mba == get_max_mba() && slack > slack_down_pg
+          && slack_xpn > slack_down_pg) {
+        LINFO("------------------------------------------------------");
+        LINFOF("Phase change detected, restarting the ratio search at %d",
+               initial_remote_ratio);
+        plant->place_pages(initial_remote_ratio);
+        current_remote_ratio = initial_remote_ratio;
+        wait_settle(SETTLE_RATIO);
+      }
+      my_action = { TS_PHASE_CHANGE };
+      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+                target_slo, current_latency, slack, stall_rate.at(HP),
+                stall_rate.at(BE), my_action, logCounter++);
+      iter++;
+      actuator_commit();
+      plant->sleep(sleeptime);
+      continue;
+    }
+
     if (slack < slack_up || slack_xpn < slack_up) {
       /* if (current_latency != 0 && current_latency > target_slo * (1 +
        delta_hp)) {
@@ -202,19 +323,27 @@ void abc_numa() {
       // incase of single-skt check 100 also!
       // if (current_remote_ratio != 100) {
       if (current_remote_ratio != 0) {
+        // First shrink the LLC share of the BE (LLC thrashing is not fixed by
+        // throttling bandwidth), only escalate to MBA if that is not enough
+        if (llc_control && optimal_mba == get_max_mba()
+            && optimal_llc_ways != get_min_llc_ways()) {
+          LINFO("------------------------------------------------------");
+          optimal_llc_ways = shrink_llc();
+        }
         // Enforce MBA
         LINFO("------------------------------------------------------");
         // optimal_mba = search_optimal_mba();
-        if (optimal_mba != 10) {
-          apply_mba(10);
-          optimal_mba = 10;
-          sleep(3);
-          // sleep for 1 sec
+        if ((slack < slack_up || slack_xpn < slack_up)
+            && optimal_mba != get_min_mba()) {
+          apply_mba(get_min_mba());
+          optimal_mba = get_min_mba();
+          // wait until the plant settles (at most 3 sec)
+          wait_settle(SETTLE_MBA);
           // usleep(sleeptime);
           // usleep(500000);
           // log the measurements for the debugging purposes!
 
-          my_action = "apply_mba-" + std::to_string(10);
+          my_action = { TS_APPLY_MBA, optimal_mba };
           my_logger(chrono::system_clock::now(), current_remote_ratio,
                     optimal_mba, target_slo, current_latency, slack,
                     stall_rate.at(HP), stall_rate.at(BE), my_action,
@@ -222,7 +351,16 @@ void abc_numa() {
         }
         // Enforce Lazy Page migration while releasing MBA
         //  while (mba_flag) {
-        while (optimal_mba != 100) {
+        while (optimal_mba != get_max_mba()) {
+          // flush a pending revert of release_mba() before measuring
+          actuator_commit();
+          // wait for a fresh sample instead of spinning on the same one
+          plant->sleep(sleeptime);
+          // serve the runtime control (and the checkpoint, the metrics)
+          // while the BE is throttled, leave on a stop or a mode switch
+          if (!keep_running()) {
+            break;
+          }
           // evaluate SLO function whenever we come back here again!
           current_latency = get_latest_percentile_latency();
           slack = (target_slo - current_latency) / target_slo;
@@ -271,6 +409,11 @@ void abc_numa() {
         LINFOF("target: %.0lf, current: %.0lf", target_slo, current_latency);
       }
       // }
+    } else if (llc_control && optimal_llc_ways != get_max_llc_ways()
+        && slack > slack_down_mba && slack_xpn > slack_down_mba) {
+      // green zone, give the LLC back to the BE
+      LINFO("------------------------------------------------------");
+      optimal_llc_ways = release_llc();
     } /*else if (slack > slack_down && current_remote_ratio < 10) {
      LINFOF(
      "SLO has NOT been violated (BELOW operation region) target: %.0lf, "
@@ -294,56 +437,6 @@ void abc_numa() {
      *
      */
 
-    /*
-     * After a new iteraion check if the current stall rate is within the
-     * optimal region
-     */
-    /*    double diff = stall_rate.at(BE) - best_stall_rate.at(BE);
-     LINFOF("BE current: %.10lf, BE best: %.10lf, diff: %.10lf",
-     stall_rate.at(BE), best_stall_rate.at(BE), diff);
-
-     if (abs(diff) > phase_change &&
-     abs(diff) != std::numeric_limits<double>::infinity()) {
-     optimization_complete = false;
-     LINFOF("Phase change detected, diff: %.10lf", diff);
-     // reset the best ratio value!
-     best_stall_rate.at(BE) = std::numeric_limits<double>::infinity();
-     // fix this
-     // check the direction of the optimization process!
-     int direction = check_opt_direction();
-
-     if (direction == 1) {
-     current_remote_ratio = apply_pagemigration_rl_be();
-     } else {
-     current_remote_ratio = apply_pagemigration_lr();
-     }
-     } else {
-     if (!optimization_complete) {
-     if ((diff < -(delta_be)) ||
-     diff == -(std::numeric_limits<double>::infinity()) || diff == 0)
-     { current_remote_ratio = apply_pagemigration_lr(); } else if ((diff >
-     delta_be) || diff == -(std::numeric_limits<double>::infinity())) {
-     current_remote_ratio = apply_pagemigration_rl_be();
-     } else if ((diff != 0 && diff > -(delta_be) && diff < delta_be) ||
-     diff == -(std::numeric_limits<double>::infinity())) {
-     LINFOF(
-     "Nothing can be done (SLO within the operation region && No "
-     "performance improvement for BE), delta_be: %.10lf",
-     diff);
-     // update the BE best stall rate
-     best_stall_rate.at(BE) =
-     std::min(best_stall_rate.at(BE), stall_rate.at(BE));
-     } else {
-     LINFO("Something else happened");
-     exit(EXIT_FAILURE);
-     }
-     }
-     }
-     }
-
-     LINFO("OPTIMIZATION COMPLETED!");
-     optimization_complete = true;*/
-
     // LINFOF("End of iteration: %d, sleeping for %d seconds", iter, sleeptime);
     // LINFOF("current_remote_ratio: %d, optimal_mba: %d, current_latency:
     // %.0lf, slack: %.2lf", current_remote_ratio, optimal_mba, current_latency,
@@ -351,7 +444,8 @@ void abc_numa() {
     iter++;
 
     // print_logs();
-    usleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
   }
 }
 
@@ -361,7 +455,7 @@ void abc_numa() {
  */
 void page_migration_only() {
   LINFOF("Monitoring period: %d ms", sleeptime);
-  while (run) {
+  while (keep_running()) {
     // TODO: this can be inside the loop or outside the loop!
     // TODO: Define the operation region of the controller
     // LINFO("======================================================");
@@ -384,7 +478,7 @@ void page_migration_only() {
     //    std::min(best_stall_rate.at(BE), stall_rate.at(BE));
 
     // log the measurements for the debugging purposes!
-    std::string my_action = "iteration-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -482,7 +576,8 @@ void page_migration_only() {
     iter++;
 
     // print_logs();
-    usleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
   }
 }
 
@@ -497,7 +592,7 @@ int check_opt_direction() {
   if (tried_ratio > 0) {
     // first try from remote to local
     tried_ratio -= ADAPTATION_STEP;
-    place_all_pages(mem_segments, tried_ratio);
+    plant->place_pages(tried_ratio);
     rl_str = get_average_stall_rate(_num_polls, _poll_sleep,
                                     _num_poll_outliers);
 
@@ -508,7 +603,7 @@ int check_opt_direction() {
       current_remote_ratio = tried_ratio;  // update the current ratio
     } else {
       // local to remote migration
-      place_all_pages(mem_segments, (tried_ratio + ADAPTATION_STEP));
+      plant->place_pages((tried_ratio + ADAPTATION_STEP));
     }
   }
   LINFOF("Direction: %d, current(BE): %.10lf, tried(BE): %.10lf, diff: %.10lf",
@@ -522,7 +617,7 @@ int check_opt_direction() {
  *
  */
 void mba_only() {
-  while (run) {
+  while (keep_running()) {
     // TODO: this can be inside the loop or outside the loop!
     // TODO: Define the operation region of the controller
     LINFO("======================================================");
@@ -541,7 +636,7 @@ void mba_only() {
                                       stall_rate.at(BE));
 
     // log the measurements for the debugging purposes!
-    std::string my_action = "iteration-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -631,7 +726,8 @@ void mba_only() {
     iter++;
 
     // print_logs();
-    sleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
   }
 }
 
@@ -641,7 +737,7 @@ void mba_only() {
  */
 void mba_10() {
   LINFOF("Monitoring period: %d ms", sleeptime);
-  while (run) {
+  while (keep_running()) {
     // TODO: this can be inside the loop or outside the loop!
     // TODO: Define the operation region of the controller
     // LINFO("======================================================");
@@ -665,7 +761,7 @@ void mba_10() {
     //     std::min(best_stall_rate.at(BE), stall_rate.at(BE));
 
     // log the measurements for the debugging purposes!
-    std::string my_action = "iteration-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -677,12 +773,12 @@ void mba_10() {
           "SLO has been violated (ABOVE operation region) slack: %.2lf, " "target: %.0lf, " "current: %.0lf",
           slack, target_slo, current_latency);
 
-      if (current_remote_ratio != 0 && optimal_mba != 10) {
-        // Enforce MBA of 10
+      if (current_remote_ratio != 0 && optimal_mba != get_min_mba()) {
+        // Enforce the minimum MBA
         LINFO("------------------------------------------------------");
-        apply_mba(10);
-        sleep(3);
-        optimal_mba = 10;
+        apply_mba(get_min_mba());
+        wait_settle(SETTLE_MBA);
+        optimal_mba = get_min_mba();
       } else {
         LINFO("Nothing can be done about SLO violation (Change in workload!), "
               "Find new target SLO!");
@@ -761,7 +857,354 @@ void mba_10() {
     iter++;
 
     // print_logs();
-    usleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
+  }
+}
+
+/*
+ * BE throughput: the unstalled fraction of the BE cycles when the counters
+ * are set up, otherwise the calibrated bandwidth of the BE MBA level
+ */
+static double get_be_perf(int mba) {
+  if (plant->has_counters() && !std::isinf(stall_rate.at(BE))
+      && !std::isnan(stall_rate.at(BE))) {
+    return 1 - stall_rate.at(BE);
+  }
+  return get_mba_bandwidth(mba);
+}
+
+/*
+ * abc_numa with a joint (remote ratio x MBA) search
+ * every monitoring period updates the online performance model, which picks
+ * the next (ratio, mba) probe instead of walking the two 1-D ladders
+ */
+void abc_numa_model() {
+  std::vector<int> ratios;
+  for (int r = 0; r <= 100; r += ADAPTATION_STEP) {
+    ratios.push_back(r);
+  }
+  // keep what was learnt before (checkpoint, mode switch) on the same grid
+  if (perf_model.get_ratios() != ratios
+      || perf_model.get_mbas() != get_mba_levels()) {
+    perf_model.reset(ratios, get_mba_levels());
+  } else {
+    LINFOF("Resuming the model (%d observations)", perf_model.observations());
+  }
+
+  LINFOF("Monitoring period: %d ms", sleeptime);
+  while (keep_running()) {
+    // Measure the 99th percentile of the HP applications
+    current_latency = get_latest_percentile_latency();
+    slack = (target_slo - current_latency) / target_slo;
+
+    // for xapian, TODO: Make this dynamic
+    current_latency_xpn = get_latest_percentile_latency_xpn();
+    slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    if (plant->has_counters()) {
+      stall_rate = plant->stall_rate();
+    }
+
+    // log the measurements for the debugging purposes!
+    TsAction my_action = { TS_ITERATION, iter };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+              target_slo, current_latency, slack, stall_rate.at(HP),
+              stall_rate.at(BE), my_action, logCounter++);
+
+    // the workload changed phase: what the model learnt is stale
+    if (detect_phase_change(get_phase_sample())) {
+      LINFOF("Phase change detected, resetting the model (%d observations)",
+             perf_model.observations());
+      perf_model.clear();
+      my_action = { TS_PHASE_CHANGE };
+      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+                target_slo, current_latency, slack, stall_rate.at(HP),
+                stall_rate.at(BE), my_action, logCounter++);
+    }
+
+    // every period is an observation of the current configuration
+    perf_model.observe(current_remote_ratio, optimal_mba,
+                       std::min(slack, slack_xpn), get_be_perf(optimal_mba));
+
+    int ratio, mba;
+    if (perf_model.next_probe(current_remote_ratio, optimal_mba, slack_up,
+                              &ratio, &mba)) {
+      LINFO("------------------------------------------------------");
+      LINFOF(
+          "Probing ratio: %d, mba: %d (predicted slack: %.2lf, be: %.4lf), " "slack: %.2lf, slack_xpn: %.2lf",
+          ratio, mba, perf_model.predict_slack(ratio, mba),
+          perf_model.predict_be(ratio, mba), slack, slack_xpn);
+
+      bool migrate = ratio != current_remote_ratio;
+      if (migrate) {
+        plant->place_pages(ratio);
+        current_remote_ratio = ratio;
+      }
+      if (mba != optimal_mba) {
+        apply_mba(mba);
+        optimal_mba = mba;
+      }
+      wait_settle(migrate ? SETTLE_RATIO : SETTLE_MBA);
+
+      my_action = { TS_APPLY_PROBE, ratio, mba };
+      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+                target_slo, current_latency, slack, stall_rate.at(HP),
+                stall_rate.at(BE), my_action, logCounter++);
+    }
+
+    iter++;
+
+    actuator_commit();
+    plant->sleep(sleeptime);
+  }
+}
+
+/*
+ * Nearest valid MBA level to a continuous MBA value
+ */
+static int quantize_mba(double mba) {
+  const std::vector<int> &levels = get_mba_levels();
+  int best = get_max_mba();
+  for (size_t i = 0; i < levels.size(); i++) {
+    if (std::abs(levels.at(i) - mba) < std::abs(best - mba))
+      best = levels.at(i);
+  }
+  return best;
+}
+
+/*
+ * PID mode
+ * A PI(D) controller holds the HP slack (min over all the sources) at
+ * pid_setpoint, its output is the MBA of the BE clamped to the discovered
+ * MBA levels: the BE gets all the bandwidth the HP can spare
+ */
+void pid_mba() {
+  PidController pid(pid_kp, pid_ki, pid_kd, get_min_mba(), get_max_mba());
+  pid.reset(optimal_mba);
+
+  uint64_t prev = plant->now();
+
+  LINFOF("Control period: %d ms", pid_period);
+  while (keep_running()) {
+    // Measure the 99th percentile of the HP applications
+    current_latency = get_latest_percentile_latency();
+    slack = (target_slo - current_latency) / target_slo;
+
+    // for xapian, TODO: Make this dynamic
+    current_latency_xpn = get_latest_percentile_latency_xpn();
+    slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    uint64_t now = plant->now();
+    double dt = (now - prev) / 1e6;
+    prev = now;
+
+    double u = pid.update(pid_setpoint, std::min(slack, slack_xpn), dt);
+    int mba = quantize_mba(u);
+
+    if (mba != optimal_mba) {
+      LDEBUGF("slack: %.2lf, slack_xpn: %.2lf, pid output: %.1lf, mba: %d",
+              slack, slack_xpn, u, mba);
+      apply_mba(mba);
+      optimal_mba = mba;
+
+      TsAction my_action = { TS_APPLY_MBA, mba };
+      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+                target_slo, current_latency, slack, stall_rate.at(HP),
+                stall_rate.at(BE), my_action, logCounter++);
+    }
+
+    TsAction my_action = { TS_ITERATION, iter };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+              target_slo, current_latency, slack, stall_rate.at(HP),
+              stall_rate.at(BE), my_action, logCounter++);
+    iter++;
+
+    actuator_commit();
+    plant->sleep(pid_period * 1000);
+  }
+}
+
+/*
+ * abc_numa with several BEs
+ * when the HP slack drops the arbiter picks the BE to throttle (one MBA
+ * level at a time, then migrate its pages away from the HP node), in the
+ * green zone it picks the BE to release first
+ */
+void abc_numa_multi() {
+  LINFOF("Monitoring period: %d ms, %lu BEs", sleeptime, be_processes.size());
+  while (keep_running()) {
+    // Measure the 99th percentile of the HP applications
+    current_latency = get_latest_percentile_latency();
+    slack = (target_slo - current_latency) / target_slo;
+
+    // for xapian, TODO: Make this dynamic
+    current_latency_xpn = get_latest_percentile_latency_xpn();
+    slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    // BEs come and go
+    if (plant_is_hardware() && sync_segments()) {
+      print_be_processes();
+    }
+    update_be_bandwidth();
+
+    // log the measurements for the debugging purposes!
+    TsAction my_action = { TS_ITERATION, iter };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+              target_slo, current_latency, slack, stall_rate.at(HP),
+              stall_rate.at(BE), my_action, logCounter++);
+
+    if (slack < slack_up || slack_xpn < slack_up) {
+      BeProcess *be = arbiter_pick_victim();
+      if (be == NULL) {
+        LINFO("Nothing can be done about SLO violation (every BE is " "throttled), Find new target SLO!");
+      } else {
+        LINFO("------------------------------------------------------");
+        LINFOF("SLO is about to be violated, slack: %.2lf, slack_xpn: %.2lf, " "throttling BE %d (%.0lf MB/s to the HP node, priority %d)",
+               slack, slack_xpn, be->pid, be->local_bandwidth, be->priority);
+        if (be->mba != get_min_mba()) {
+          set_be_mba(*be, get_prev_mba(be->mba));
+          my_action = { TS_APPLY_MBA, be->mba, 0, be->pid };
+          wait_settle(SETTLE_MBA);
+        } else {
+          set_be_ratio(*be, std::min(100, be->ratio + ADAPTATION_STEP));
+          my_action = { TS_APPLY_RATIO, be->ratio, 0, be->pid };
+          wait_settle(SETTLE_RATIO);
+        }
+        my_logger(chrono::system_clock::now(), be->ratio, be->mba, target_slo,
+                  current_latency, slack, stall_rate.at(HP), stall_rate.at(BE),
+                  my_action, logCounter++);
+      }
+    } else if (slack > slack_down_mba && slack_xpn > slack_down_mba) {
+      BeProcess *be = arbiter_pick_release();
+      if (be != NULL) {
+        LINFO("------------------------------------------------------");
+        LINFOF("Releasing BE %d (priority %d), slack: %.2lf, slack_xpn: %.2lf",
+               be->pid, be->priority, slack, slack_xpn);
+        set_be_mba(*be, get_next_mba(be->mba));
+        my_action = { TS_APPLY_MBA, be->mba, 0, be->pid };
+        wait_settle(SETTLE_MBA);
+        my_logger(chrono::system_clock::now(), be->ratio, be->mba, target_slo,
+                  current_latency, slack, stall_rate.at(HP), stall_rate.at(BE),
+                  my_action, logCounter++);
+      }
+    }
+
+    iter++;
+
+    actuator_commit();
+    plant->sleep(sleeptime);
+  }
+}
+
+// "node: weight" of every node
+static std::string weights_string(const std::vector<double> &weights) {
+  std::string s;
+  for (size_t i = 0; i < weights.size(); i++) {
+    char weight[32];
+    snprintf(weight, sizeof(weight), "%s%lu: %.1lf", i == 0 ? "" : ", ", i,
+             weights[i]);
+    s += weight;
+  }
+  return s;
+}
+
+// the BE stall rate once the pages are placed by the weights, node: the
+// node probed (-1: none)
+static double bwap_cost(const std::vector<double> &weights, int node) {
+  plant->place_weights(weights);
+  wait_settle(SETTLE_RATIO);
+  stall_rate = get_average_stall_rate(_num_polls, _poll_sleep,
+                                      _num_poll_outliers);
+
+  TsAction my_action = { TS_APPLY_WEIGHTS, (int) lround(100 - weights.at(0)),
+      node };
+  my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+            target_slo, current_latency, slack, stall_rate.at(HP),
+            stall_rate.at(BE), my_action, logCounter++);
+  return stall_rate.at(BE);
+}
+
+// the weights in the format of read_weights()
+static void save_weights(const std::vector<double> &weights) {
+  FILE *fp = fopen(bwap_weights_out.c_str(), "w");
+  if (fp == NULL) {
+    LWARNF("Unable to write the weights to %s: %s", bwap_weights_out.c_str(),
+           strerror(errno));
+    return;
+  }
+  for (size_t i = 0; i < weights.size(); i++) {
+    fprintf(fp, "%.1lf,%lu\n", weights[i], i);
+  }
+  fclose(fp);
+  LINFOF("Weights written to %s", bwap_weights_out.c_str());
+}
+
+/*
+ * bwap mode
+ * the weights of the BE pages on every node tuned online by gradient
+ * descent on the BE stall rate (WeightTuner), from the remote ratio (off the
+ * worker node, evenly), then held; the HP is not protected
+ * BWMAN_WEIGHTS is left alone, a switch to another mode keeps the tuned
+ * placement, with the share off the worker node as the remote ratio
+ */
+bool bwap_ready() {
+  // on hardware the counters are set up the first time the mode is entered
+  return plant->has_counters() || (plant_is_hardware() && initialize_likwid());
+}
+
+void bwap_tune() {
+  if (!bwap_ready()) {
+    LWARN("The bwap mode needs the stall rate of the BE (likwid)");
+    return;
+  }
+  int nodes = plant_is_hardware() ? numa_num_configured_nodes() : MAX_NODES;
+  WeightTuner tuner(nodes, bwap_step, bwap_rate, bwap_min_move, bwap_max_iter);
+  std::vector<double> weights(nodes, 100.0);
+  if (nodes > 1) {
+    std::fill(weights.begin(), weights.end(),
+              (double) current_remote_ratio / (nodes - 1));
+    weights.at(0) = 100 - current_remote_ratio;
+  }
+  tuner.reset(weights);
+
+  LINFOF("Tuning the weights of %d nodes from %s", nodes,
+         weights_string(tuner.weights()).c_str());
+  while (keep_running()) {
+    if (tuner.converged()) {
+      TsAction my_action = { TS_ITERATION, iter };
+      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+                target_slo, current_latency, slack, stall_rate.at(HP),
+                stall_rate.at(BE), my_action, logCounter++);
+      iter++;
+      plant->sleep(sleeptime);
+      continue;
+    }
+
+    // the cost at the weights and at a probe per node
+    double cost = bwap_cost(tuner.weights(), -1);
+    std::vector<double> probe_costs;
+    for (int i = 0; i < nodes && run; i++) {
+      probe_costs.push_back(bwap_cost(tuner.probe(i), i));
+    }
+    if ((int) probe_costs.size() < nodes) {
+      continue;
+    }
+    double moved = tuner.update(cost, probe_costs);
+    LINFOF("Iteration %d: stall rate %.4lf, moved %.1lf%%, weights %s",
+           tuner.iterations(), cost, moved,
+           weights_string(tuner.weights()).c_str());
+    iter++;
+
+    if (tuner.converged()) {
+      cost = bwap_cost(tuner.weights(), -1);
+      current_remote_ratio = (int) lround(100 - tuner.weights().at(0));
+      LINFOF("Weights tuned in %d iterations, stall rate %.4lf: %s",
+             tuner.iterations(), cost, weights_string(tuner.weights()).c_str());
+      if (!bwap_weights_out.empty()) {
+        save_weights(tuner.weights());
+      }
+    }
   }
 }
 
@@ -770,7 +1213,7 @@ void mba_10() {
  *
  */
 void disabled_controller() {
-  while (run) {
+  while (keep_running()) {
     // TODO: this can be inside the loop or outside the loop!
     // TODO: Define the operation region of the controller
     LINFO("======================================================");
@@ -789,7 +1232,7 @@ void disabled_controller() {
                                       stall_rate.at(BE));
 
     // log the measurements for the debugging purposes!
-    std::string my_action = "iteration-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -854,7 +1297,8 @@ void disabled_controller() {
     iter++;
 
     // print_logs();
-    sleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
   }
 }
 
@@ -864,7 +1308,7 @@ void disabled_controller() {
  */
 void linux_default() {
   LINFOF("Monitoring period: %d ms", sleeptime);
-  while (run) {
+  while (keep_running()) {
     // LINFO("======================================================");
     // LINFOF("Starting a new iteration: %d", iter);
     // LINFO("------------------------------------------------------");
@@ -886,7 +1330,7 @@ void linux_default() {
      "current: %.10lf",
      target_slo, current_latency, stall_rate.at(BE), stall_rate.at(HP));*/
 
-    std::string my_action = "iter-" + std::to_string(iter);
+    TsAction my_action = { TS_ITERATION, iter };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -894,7 +1338,8 @@ void linux_default() {
     iter++;
 
     // print_logs();
-    usleep(sleeptime);
+    actuator_commit();
+    plant->sleep(sleeptime);
   }
 }
 
@@ -910,12 +1355,13 @@ void linux_default() {
  */
 double get_target_stall_rate() {
   double target_stall_rate;
-  int min_mba = 10;
-  int max_mba = 100;
+  int min_mba = get_min_mba();
+  int max_mba = get_max_mba();
 
   LINFO("Getting the target SLO for the HP");
   if (current_remote_ratio != 0) {
     apply_mba(min_mba);
+    actuator_commit();
   }
 
   // Measure the stall_rate of the applications
@@ -926,6 +1372,7 @@ double get_target_stall_rate() {
 
   if (current_remote_ratio != 0) {
     apply_mba(max_mba);
+    actuator_commit();
   }
 
   return target_stall_rate;
@@ -1049,11 +1496,29 @@ void spawn_measurement_thread() {
 void measurement_collector() {
   double cpl = 0;
   double cpl_xpn = 0;
+  uint32_t samples = 0;
   while (run) {
-    cpl = get_percentile_latency();
-    cpl_xpn = get_percentile_latency_xpn();
-    percentile_samples.push_back(cpl);
-    percentile_samples_xpn.push_back(cpl_xpn);
+    {
+      TimelineSpan span("sensor", "latency read");
+      ProfileScope scope(PROF_MEASUREMENT);
+      cpl = get_percentile_latency();
+      cpl_xpn = get_percentile_latency_xpn();
+    }
+    timeline_counter("p99", { { "memcached", cpl }, { "xapian", cpl_xpn } });
+    {
+      std::lock_guard<std::mutex> lock(samples_mutex);
+      latest_sample = cpl;
+      latest_sample_xpn = cpl_xpn;
+    }
+    TimeSeriesRow row = { };
+    row.time = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    row.counter = samples++;
+    row.action = TS_SAMPLE;
+    row.target_slo = target_slo;
+    row.latency = cpl;
+    row.latency_xpn = cpl_xpn;
+    timeseries_record(row);
     // TODO: factor this out!
     if (((target_slo - cpl) / target_slo) <= slack_up) {
       violations_counter_f++;
@@ -1074,25 +1539,29 @@ void measurement_collector() {
 }
 
 double get_latest_percentile_latency() {
-  if (!percentile_samples.empty()) {
-    return percentile_samples.back();
-  } else {
-    return 0;
-  }
+  return plant->latency();
 }
 
 double get_latest_percentile_latency_xpn() {
-  if (!percentile_samples_xpn.empty()) {
-    return percentile_samples_xpn.back();
-  } else {
-    return 0;
-  }
+  return plant->latency_xpn();
+}
+
+/*
+ * Latest sample of the measurement thread (the sensors of the hardware)
+ */
+double get_sampled_percentile_latency() {
+  std::lock_guard<std::mutex> lock(samples_mutex);
+  return latest_sample;
+}
+
+double get_sampled_percentile_latency_xpn() {
+  std::lock_guard<std::mutex> lock(samples_mutex);
+  return latest_sample_xpn;
 }
 
 /*
  * Search the highest MBA that still meets the target SLO
- * Apply binary search to reduce the search space
- * Valid MBA states in our case: 100, 90, 60, 50, 40, 30, 20, 10
+ * Apply binary search over the valid MBA levels to reduce the search space
  * TODO: check for transient values
  *
  */
@@ -1101,17 +1570,16 @@ int search_optimal_mba() {
   int i;
   double progress;
 
-  i = 40;
-  int previous_mba = 40;
+  int low_mba = get_min_mba();
+  int high_mba = get_max_mba();
+  int previous_mba = optimal_mba;
+  bool achieved = false;
 
-  while (i != 10 || i != 30 || i != 50 || i != 90) {
-    if (i == 0) {
-      LINFO("End of valid MBA states, breaking!");
-      optimal_mba = previous_mba;
-      break;
-    }
+  while (low_mba <= high_mba) {
+    i = mba_binary_search(low_mba, high_mba);
 
     apply_mba(i);
+    actuator_commit();
 
     // Measure the stall_rate of the applications after enforcing MBA
     stall_rate = get_average_stall_rate(_num_polls, _poll_sleep,
@@ -1120,7 +1588,7 @@ int search_optimal_mba() {
     // Measure the current latency
     current_latency = get_latest_percentile_latency();
 
-    std::string my_action = "apply_mba-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_MBA, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, i, target_slo,
               current_latency, slack, stall_rate.at(HP), stall_rate.at(BE),
               my_action, logCounter++);
@@ -1128,29 +1596,39 @@ int search_optimal_mba() {
     // sanity checker
     if (current_latency == 0) {
       LINFO("0 latency reported, revert to the previous state and break!");
-      apply_mba(optimal_mba);
-      break;
+      apply_mba(previous_mba);
+      actuator_commit();
+      return optimal_mba = previous_mba;
     }
 
+    // progress = stall_rate.at(HP) - target_stall_rate;
+    progress = current_latency - target_slo;
+    LINFOF("Progress: %.2lf", progress);
+
     if (current_latency <= target_slo * (1 + delta_hp)) {
       LINFOF("SLO has been achieved: target: %.0lf, current: %.0lf", target_slo,
              current_latency);
       optimal_mba = i;
-      break;
-    }
-
-    else {
+      achieved = true;
+      if (i == get_max_mba())
+        break;
+      low_mba = get_next_mba(i);
+    } else {
       LINFOF("SLO has NOT been achieved:  target: %.0lf, current: %.0lf",
              target_slo, current_latency);
+      if (i == get_min_mba())
+        break;
+      high_mba = get_prev_mba(i);
     }
+  }
 
-    // progress = stall_rate.at(HP) - target_stall_rate;
-    progress = current_latency - target_slo;
-    LINFOF("Progress: %.2lf", progress);
-    previous_mba = i;
-    i = mba_binary_search(i, progress);
-    optimal_mba = i;
+  if (!achieved) {
+    LINFO("End of valid MBA states, keeping the minimum MBA!");
+    optimal_mba = get_min_mba();
   }
+  // the last probe may have been above the optimal level
+  apply_mba(optimal_mba);
+  actuator_commit();
 
   LINFOF("Optimal MBA value: %d", optimal_mba);
   return optimal_mba;
@@ -1169,7 +1647,7 @@ int apply_pagemigration_rl() {
 
   for (i = current_remote_ratio; i >= 0; i -= ADAPTATION_STEP) {
     // LINFOF("Going to check a ratio of %d", i);
-    place_all_pages(mem_segments, i);
+    plant->place_pages(i);
     // break;
     // Measure the stall_rate of the applications
     //  stall_rate =
@@ -1177,8 +1655,8 @@ int apply_pagemigration_rl() {
 
     // sleep for 100ms
     // usleep(100000);
-    // sleep for 1 sec
-    sleep(3);
+    // wait until the plant settles (at most 3 sec)
+    wait_settle(SETTLE_RATIO);
     // usleep(sleeptime);
     // Measure the current latency measurement
     current_latency = get_latest_percentile_latency();
@@ -1187,7 +1665,7 @@ int apply_pagemigration_rl() {
     // best_stall_rate.at(BE) =
     //    std::min(best_stall_rate.at(BE), stall_rate.at(BE));
 
-    std::string my_action = "apply_ratio-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_RATIO, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -1240,7 +1718,7 @@ int apply_pagemigration_lr_same_socket() {
 
   for (i = current_remote_ratio; i <= 100; i += ADAPTATION_STEP) {
     // LINFOF("Going to check a ratio of %d", i);
-    place_all_pages(mem_segments, i);
+    plant->place_pages(i);
     // break;
     // Measure the stall_rate of the applications
     //  stall_rate =
@@ -1248,8 +1726,8 @@ int apply_pagemigration_lr_same_socket() {
 
     // sleep for 100ms
     // usleep(100000);
-    // sleep for 1 sec
-    sleep(3);
+    // wait until the plant settles (at most 3 sec)
+    wait_settle(SETTLE_RATIO);
     // usleep(sleeptime);
     // Measure the current latency measurement
     current_latency = get_latest_percentile_latency();
@@ -1262,7 +1740,7 @@ int apply_pagemigration_lr_same_socket() {
     // best_stall_rate.at(BE) =
     //    std::min(best_stall_rate.at(BE), stall_rate.at(BE));
 
-    std::string my_action = "apply_ratio-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_RATIO, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -1311,7 +1789,7 @@ int apply_pagemigration_rl_be() {
 
   for (i = current_remote_ratio; i >= 0; i -= ADAPTATION_STEP) {
     LINFOF("Going to check a ratio of %d", i);
-    place_all_pages(mem_segments, i);
+    plant->place_pages(i);
 
     // Measure the stall_rate of the applications
     stall_rate = get_average_stall_rate(_num_polls, _poll_sleep,
@@ -1324,7 +1802,7 @@ int apply_pagemigration_rl_be() {
     best_stall_rate.at(BE) = std::min(best_stall_rate.at(BE),
                                       stall_rate.at(BE));
 
-    std::string my_action = "apply_ratio-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_RATIO, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -1345,7 +1823,7 @@ int apply_pagemigration_rl_be() {
              stall_rate.at(HP), best_stall_rate.at(BE), stall_rate.at(BE));
       if (i != 100) {
         LINFO("Going one step back before breaking!");
-        place_all_pages(mem_segments, (i + ADAPTATION_STEP));
+        plant->place_pages((i + ADAPTATION_STEP));
         current_remote_ratio = i + ADAPTATION_STEP;
       } else {
         current_remote_ratio = i;
@@ -1384,7 +1862,7 @@ int apply_pagemigration_lr() {
   for (i = current_remote_ratio; i <= 100; i += ADAPTATION_STEP) {
     LINFOF("Going to check a ratio of %d", i);
     if (i != 0) {
-      place_all_pages(mem_segments, i);
+      plant->place_pages(i);
     }
 
     // Measure the stall_rate of the applications
@@ -1392,7 +1870,7 @@ int apply_pagemigration_lr() {
     //     get_average_stall_rate(_num_polls, _poll_sleep, _num_poll_outliers);
 
     // sleep(sleeptime);
-    sleep(3);
+    wait_settle(SETTLE_RATIO);
     // Measure the current latency measurement
     /*current_latency = get_percentile_latency();
      // First check if we are violating the SLO
@@ -1405,7 +1883,7 @@ int apply_pagemigration_lr() {
      // current diff
      // double my_diff = stall_rate.at(BE) - best_stall_rate.at(BE);
 
-     std::string my_action = "apply_ratio-" + std::to_string(i);
+     TsAction my_action = { TS_APPLY_RATIO, i };
      my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
      target_slo, current_latency, slack, stall_rate.at(HP),
      stall_rate.at(BE), my_action, logCounter++);
@@ -1529,7 +2007,7 @@ int apply_pagemigration_lr_dc() {
   for (i = current_remote_ratio; i <= 100; i += ADAPTATION_STEP) {
     LINFOF("Going to check a ratio of %d", i);
     if (i != 0) {
-      place_all_pages(mem_segments, i);
+      plant->place_pages(i);
     }
 
     // Measure the stall_rate of the applications
@@ -1546,7 +2024,7 @@ int apply_pagemigration_lr_dc() {
     // current diff
     double my_diff = stall_rate.at(BE) - best_stall_rate.at(BE);
 
-    std::string my_action = "apply_ratio-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_RATIO, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
@@ -1570,7 +2048,7 @@ int apply_pagemigration_lr_dc() {
                stall_rate_transient.at(BE));
         if (i != 0) {
           LINFO("Going one step back before breaking!");
-          place_all_pages(mem_segments, (i - ADAPTATION_STEP));
+          plant->place_pages((i - ADAPTATION_STEP));
           current_remote_ratio = i - ADAPTATION_STEP;
         } else {
           current_remote_ratio = i;
@@ -1588,7 +2066,7 @@ int apply_pagemigration_lr_dc() {
           stall_rate.at(HP), best_stall_rate.at(BE), stall_rate.at(BE), my_diff);
       if (i != 0) {
         LINFO("Going one step back before breaking!");
-        place_all_pages(mem_segments, (i - ADAPTATION_STEP));
+        plant->place_pages((i - ADAPTATION_STEP));
         current_remote_ratio = i - ADAPTATION_STEP;
       } else {
         current_remote_ratio = i;
@@ -1620,18 +2098,18 @@ int apply_pagemigration_lr_dc() {
 int release_mba() {
   int i;
   // apply the next mba immediately
-  optimal_mba += 10;
+  optimal_mba = get_next_mba(optimal_mba);
 
   // if the current ratio is zero, then apply the max mba immediately incase of
   // multi-socket colocation or if the current ratio is 100, them apply the max
   // mba immediately incase of single-socket colocation
   if (current_remote_ratio == 0) {
-    apply_mba(100);
+    apply_mba(get_max_mba());
 
     // sleep for 100ms
     // usleep(100000);
-    // sleep for 1 sec
-    sleep(3);
+    // wait until the plant settles (at most 3 sec)
+    wait_settle(SETTLE_MBA);
     // usleep(sleeptime);
     // Measure the stall_rate of the applications
     // stall_rate =
@@ -1644,12 +2122,12 @@ int release_mba() {
     current_latency_xpn = get_latest_percentile_latency_xpn();
     slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
 
-    std::string my_action = "apply_mba-" + std::to_string(100);
-    my_logger(chrono::system_clock::now(), current_remote_ratio, 100,
+    TsAction my_action = { TS_APPLY_MBA, get_max_mba() };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, get_max_mba(),
               target_slo, current_latency, slack, stall_rate.at(HP),
               stall_rate.at(BE), my_action, logCounter++);
 
-    optimal_mba = 100;
+    optimal_mba = get_max_mba();
 
     // LINFOF("Optimal MBA: %d", optimal_mba);
     LINFOF(
@@ -1658,16 +2136,14 @@ int release_mba() {
     return optimal_mba;
   }
 
-  for (i = optimal_mba; i <= 100; i += 10) {
-    if (i == 70 || i == 80)
-      continue;
-
+  // walk the valid MBA levels only, see discover_mba_levels()
+  for (i = optimal_mba; i <= get_max_mba(); i = get_next_mba(i)) {
     apply_mba(i);
 
     // sleep for 100ms
     // usleep(100000);
-    sleep(3);
-    // sleep for 1 sec
+    // wait until the plant settles (at most 3 sec)
+    wait_settle(SETTLE_MBA);
     // usleep(sleeptime);
     // Measure the stall_rate of the applications
     // stall_rate =
@@ -1680,7 +2156,7 @@ int release_mba() {
     current_latency_xpn = get_latest_percentile_latency_xpn();
     slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
 
-    std::string my_action = "apply_mba-" + std::to_string(i);
+    TsAction my_action = { TS_APPLY_MBA, i };
     my_logger(chrono::system_clock::now(), current_remote_ratio, i, target_slo,
               current_latency, slack, stall_rate.at(HP), stall_rate.at(BE),
               my_action, logCounter++);
@@ -1700,10 +2176,12 @@ int release_mba() {
           "SLO violation has been detected (STOP releasing MBA and " "revert-back): target: " "%.0lf, current: %.0lf, slack: %.2lf",
           target_slo, current_latency, slack);
       // revert_back to the previous mba
-      apply_mba(i - 10);
-      optimal_mba = i - 10;
+      apply_mba(get_prev_mba(i));
+      optimal_mba = get_prev_mba(i);
       break;
     }
+    if (i == get_max_mba())
+      break;
   }
 
   // LINFOF("Optimal MBA: %d", optimal_mba);
@@ -1716,50 +2194,125 @@ int release_mba() {
 
 /*
  * Apply a single MBA value
- * TODO: Avoid using a system call to do this, instead use the library directly!
+ * The value is queued in the actuator, which drops no-op writes and
+ * coalesces bursts until the next actuator_commit()
  */
 void apply_mba(int mba_value) {
-  LINFOF("Applying MBA of %d", mba_value);
-  /*char buf[32];
-   sprintf(buf, "sudo pqos -e 'mba@0:0=%d'", mba_value);
-   system(buf); */
+  LDEBUGF("Requesting MBA of %d", mba_value);
   // use cos 1 and socket 0
   // TODO: specify this as parameters
-  set_mba_parameters(1, mba_value);
-  int ret = set_mba_allocation(0);
-  if (ret < 0) {
-    LINFO("Allocation configuration error!");
-    exit(EXIT_FAILURE);
+  actuator_request(ACT_MBA, 0, 1, mba_value);
+}
+
+/*
+ * Apply a L3 way allocation to the BE (cos 1 and socket 0)
+ */
+void apply_llc(int ways) {
+  LDEBUGF("Requesting LLC allocation of %d ways", ways);
+  actuator_request(ACT_LLC, 0, 1, ways);
+}
+
+
+/*
+ * Shrink the LLC share of the BE by halving its ways
+ * stop as soon as the SLO is no longer about to be violated
+ */
+int shrink_llc() {
+  int ways = optimal_llc_ways;
+
+  while (ways > get_min_llc_ways()) {
+    ways = std::max(ways / 2, get_min_llc_ways());
+    apply_llc(ways);
+
+    wait_settle(SETTLE_LLC);
+    // Measure the current latency
+    current_latency = get_latest_percentile_latency();
+    slack = (target_slo - current_latency) / target_slo;
+
+    current_latency_xpn = get_latest_percentile_latency_xpn();
+    slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    TsAction my_action = { TS_APPLY_LLC, ways };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+              target_slo, current_latency, slack, stall_rate.at(HP),
+              stall_rate.at(BE), my_action, logCounter++);
+
+    if (slack > slack_up && slack_xpn > slack_up) {
+      LINFOF(
+          "SLO has been achieved (STOP shrinking LLC): target: %.0lf, " "current: %.0lf, slack: %.2lf",
+          target_slo, current_latency, slack);
+      break;
+    } else {
+      LINFOF(
+          "SLO has NOT been achieved (CONTINUE shrinking LLC): target: %.0lf, " "current: %.0lf, slack: %.2lf",
+          target_slo, current_latency, slack);
+    }
+  }
+
+  LINFOF("LLC ways: %d, latency: %.0lf, slack: %.2lf", ways, current_latency,
+         slack);
+  return ways;
+}
+
+/*
+ * Give the LLC back to the BE by doubling its ways
+ * revert to the previous allocation as soon as the slack leaves the green zone
+ */
+int release_llc() {
+  int ways = optimal_llc_ways;
+
+  while (ways < get_max_llc_ways()) {
+    int next_ways = std::min(ways * 2, get_max_llc_ways());
+    apply_llc(next_ways);
+
+    wait_settle(SETTLE_LLC);
+    // Measure the current latency
+    current_latency = get_latest_percentile_latency();
+    slack = (target_slo - current_latency) / target_slo;
+
+    current_latency_xpn = get_latest_percentile_latency_xpn();
+    slack_xpn = (target_slo_xapian - current_latency_xpn) / target_slo_xapian;
+
+    TsAction my_action = { TS_APPLY_LLC, next_ways };
+    my_logger(chrono::system_clock::now(), current_remote_ratio, optimal_mba,
+              target_slo, current_latency, slack, stall_rate.at(HP),
+              stall_rate.at(BE), my_action, logCounter++);
+
+    if (slack > slack_down_mba && slack_xpn > slack_down_mba) {
+      LINFOF(
+          "SLO violation has NOT been detected (CONTINUE releasing LLC): " "target: %.0lf, current: %.0lf, slack: %.2lf",
+          target_slo, current_latency, slack);
+      ways = next_ways;
+    } else {
+      LINFOF(
+          "SLO violation has been detected (STOP releasing LLC and " "revert-back): target: %.0lf, current: %.0lf, slack: %.2lf",
+          target_slo, current_latency, slack);
+      apply_llc(ways);
+      break;
+    }
   }
-  LINFO("Allocation configuration altered.");
+
+  LINFOF("LLC ways: %d, latency: %.0lf, slack: %.2lf", ways, current_latency,
+         slack);
+  return ways;
 }
 
 /*
  * Binary search in MBA
+ * returns the valid MBA level halfway between low_mba and high_mba
  */
-int mba_binary_search(int current_mba, double progress) {
-  int next_mba;
-  if (progress > 0) {
-    if (current_mba == 40)
-      next_mba = 20;
-    else if (current_mba == 20)
-      next_mba = 10;
-    else if (current_mba == 60)
-      next_mba = 50;
-    else
-      next_mba = 0;
-  } else if (progress < 0) {
-    if (current_mba == 40)
-      next_mba = 60;
-    else if (current_mba == 20)
-      next_mba = 30;
-    else if (current_mba == 60)
-      next_mba = 90;
-    else
-      next_mba = 0;
+int mba_binary_search(int low_mba, int high_mba) {
+  const std::vector<int> &levels = get_mba_levels();
+  std::vector<int> range;
+
+  for (size_t i = 0; i < levels.size(); i++) {
+    if (levels.at(i) >= low_mba && levels.at(i) <= high_mba)
+      range.push_back(levels.at(i));
   }
+  if (range.empty())
+    return low_mba;
 
-  return next_mba;
+  return range.at(range.size() / 2);
 }
 
 /*
@@ -1830,21 +2383,12 @@ void find_optimal_lr_ratio() {
  *
  */
 void print_logs() {
-  for (size_t j = 0; j < my_logs.size(); j++) {
-    std::cout << std::fixed;
-    std::cout << std::setprecision(10);
-
-    std::time_t now_c = std::chrono::system_clock::to_time_t(
-        my_logs.at(j).timenow);
-
-    cout << now_c << "\t" << my_logs.at(j).current_remote_ratio << "\t"
-         << my_logs.at(j).current_mba_level << "\t"
-         << (int) my_logs.at(j).HPA_target_slo << "\t"
-         << (int) my_logs.at(j).HPA_currency_latency << "\t"
-         << my_logs.at(j).HPA_slack << "\t" << my_logs.at(j).HPA_stall_rate
-         << "\t" << my_logs.at(j).BEA_stall_rate << "\t" << my_logs.at(j).action
-         << "\t" << my_logs.at(j).logCounter << endl;
+  if (timeseries_file.empty()) {
+    LWARN("No time series recorded (TIMESERIES)");
+    return;
   }
+  LINFOF("The actions are in the time series %s, e.g. bwtsdump -a %s",
+         timeseries_file.c_str(), timeseries_file.c_str());
 }
 
 void print_logs_v2() {
@@ -1870,7 +2414,7 @@ void print_logs_v2() {
   cout << "Total violations_f:\t" << violations_counter_f << endl;
   cout << "Total violations_t:\t" << violations_counter_t << endl;
   cout << "optimal mba:\t" << optimal_mba << "\toptimal ratio:\t"
-       << current_remote_ratio << endl;
+       << current_remote_ratio << "\tllc ways:\t" << optimal_llc_ways << endl;
 
   // print the violations for xapian, TODO: Make this dynamic
   cout << "xapian, Total violations_f:\t" << vlts_cnt_f << endl;
@@ -1887,36 +2431,39 @@ void print_logs_v2() {
   fclose(f);
 }
 
-void print_to_file() {
-  // log memcached latency data into a file
-  FILE *f = fopen("memcached_latency_log.txt", "w");
-  for (size_t j = 0; j < percentile_samples.size(); j++) {
-    // fprintf(f, "%d\n", (int)my_logs.at(j).HPA_currency_latency);
-    fprintf(f, "%d\t%d\n", (int) j, (int) percentile_samples.at(j));
-  }
-  /* close the file*/
-  fclose(f);
-
-  // log xapian latency data also into a file: TODO: factor this function out!
-  FILE *f_2 = fopen("xapian_latency_log.txt", "w");
-  for (size_t j = 0; j < percentile_samples_xpn.size(); j++) {
-    // fprintf(f, "%d\n", (int)my_logs.at(j).HPA_currency_latency);
-    fprintf(f_2, "%d\t%.2f\n", (int) j, percentile_samples_xpn.at(j));
-  }
-  /* close the file*/
-  fclose(f_2);
-}
-
 /*
  * Log all the current information
  */
 void my_logger(std::chrono::system_clock::time_point tn, int crr, int cml,
                double hpt, double hcl, double slk, double hps, double bes,
-               std::string action, int lc) {
-  // Log all the current information
-  MyLogger mylogger(tn, crr, cml, hpt, hcl, slk, hps, bes, action, lc);
-
-  my_logs.push_back(mylogger);
+               const TsAction &action, int lc) {
+  TimeSeriesRow row = { };
+  // the virtual plants run on their own clock
+  row.time =
+      plant_is_hardware() ?
+          chrono::duration_cast<chrono::nanoseconds>(tn.time_since_epoch())
+              .count() :
+          plant->now() * 1000;
+  row.counter = lc;
+  row.action = action.type;
+  row.pid = action.pid;
+  row.value = action.value;
+  row.value2 = action.value2;
+  row.remote_ratio = crr;
+  row.mba = cml;
+  row.target_slo = hpt;
+  row.latency = hcl;
+  row.latency_xpn = current_latency_xpn;
+  row.slack = slk;
+  row.hp_stall_rate = hps;
+  row.be_stall_rate = bes;
+  timeseries_record(row);
+
+  timeline_instant("decision", ts_action_name(action.type), { { "value",
+      action.value }, { "value2", action.value2 }, { "pid", action.pid }, {
+      "remote_ratio", crr }, { "mba", cml }, { "slack", slk } });
+  timeline_counter("p99", { { "memcached", hcl }, { "xapian",
+      current_latency_xpn } });
 }
 
 void test_fixed_ratio() {
@@ -1925,7 +2472,7 @@ void test_fixed_ratio() {
   LINFOF("Before: stall_rate(BE): %.10lf, stall_rate(HP): %.10lf",
          stall_rate.at(BE), stall_rate.at(HP));
   LINFOF("Going to check a ratio of %d", fixed_ratio_value);
-  place_all_pages(mem_segments, fixed_ratio_value);
+  plant->place_pages(fixed_ratio_value);
   stall_rate = get_average_stall_rate(_num_polls, _poll_sleep,
                                       _num_poll_outliers);
   LINFOF("After: stall_rate(BE): %.10lf, stall_rate(HP): %.10lf",
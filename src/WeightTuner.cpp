@@ -0,0 +1,75 @@
+/*
+ * WeightTuner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "include/WeightTuner.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+WeightTuner::WeightTuner(int nodes, double step, double rate, double min_move,
+                         int max_iter)
+    : _nodes(nodes),
+      _step(step),
+      _rate(rate),
+      _min_move(min_move),
+      _max_iter(max_iter),
+      _weights(nodes, 100.0 / nodes),
+      _iterations(0),
+      _converged(nodes < 2) {
+}
+
+void WeightTuner::reset(const std::vector<double> &weights) {
+  _weights = weights;
+  _weights.resize(_nodes, 0);
+  normalize(_weights);
+  _iterations = 0;
+  _converged = _nodes < 2;
+}
+
+std::vector<double> WeightTuner::probe(int node) const {
+  std::vector<double> p(_weights);
+  for (int i = 0; i < _nodes; i++) {
+    p[i] += i == node ? _step : -_step / (_nodes - 1);
+  }
+  normalize(p);
+  return p;
+}
+
+double WeightTuner::update(double cost, const std::vector<double> &probe_costs) {
+  std::vector<double> next(_weights);
+  for (int i = 0; i < _nodes; i++) {
+    // the probe is clamped, what was actually moved to the node
+    double moved = probe(i)[i] - _weights[i];
+    double derivative = 0;
+    if (cost > 0 && moved != 0) {
+      derivative = (probe_costs.at(i) - cost) / cost / moved;
+    }
+    next[i] -= std::min(std::max(_rate * derivative, -_step), _step);
+  }
+  normalize(next);
+
+  double max_move = 0;
+  for (int i = 0; i < _nodes; i++) {
+    max_move = std::max(max_move, fabs(next[i] - _weights[i]));
+  }
+  _weights = next;
+  _iterations++;
+  _converged = max_move < _min_move || _iterations >= _max_iter;
+  return max_move;
+}
+
+// clamped at [0, 100], summing up to 100 (uniform if all 0)
+void WeightTuner::normalize(std::vector<double> &weights) {
+  double sum = 0;
+  for (double &w : weights) {
+    w = std::min(std::max(w, 0.0), 100.0);
+    sum += w;
+  }
+  for (double &w : weights) {
+    w = sum > 0 ? w / sum * 100 : 100.0 / weights.size();
+  }
+}
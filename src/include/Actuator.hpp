@@ -0,0 +1,53 @@
+/*
+ * Actuator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_ACTUATOR_HPP_
+#define INCLUDE_ACTUATOR_HPP_
+
+#include "include/Histogram.hpp"
+
+/*
+ * The resources the actuator writes to the hardware
+ */
+enum actuator_resource {
+  ACT_MBA = 0,  // MBA level (%)
+  ACT_LLC,      // number of L3 ways
+  ACT_MAX_RESOURCES
+};
+
+/*
+ * Request a new value for a class of service on a socket
+ * requests are only queued, bursts within one control period coalesce into
+ * the last requested value
+ */
+void actuator_request(actuator_resource res, unsigned socket_id,
+                      unsigned cos_value, int value);
+
+/*
+ * Write the pending requests that differ from the last applied value
+ * returns the number of hardware writes
+ */
+int actuator_commit(void);
+
+/*
+ * Last value applied to the hardware, -1 if unknown
+ */
+int actuator_get(actuator_resource res, unsigned socket_id,
+                 unsigned cos_value);
+
+/*
+ * Forget the cached values (e.g., after the hardware was reset elsewhere)
+ */
+void actuator_invalidate(void);
+
+/*
+ * Time spent in each hardware write (nsec)
+ */
+const Histogram& get_actuation_histogram(void);
+
+void actuator_print_stats(void);
+
+#endif /* INCLUDE_ACTUATOR_HPP_ */
@@ -0,0 +1,199 @@
+/*
+ * BinaryLog.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_BINARYLOG_HPP_
+#define INCLUDE_BINARYLOG_HPP_
+
+#include <stdint.h>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/*
+ * Binary log records of the asynchronous logger
+ *
+ * Every call site of the L* macros is registered once (LogSite: level,
+ * format, file, line, function), the hot path only copies the arguments of
+ * a message into a fixed-size record. The records are formatted later by
+ * the logger thread, or written raw to a file (LOG_BINARY) and rendered by
+ * bwlogdecode.
+ *
+ * Binary file: a BinaryLogHeader, then entries, each starting with a
+ * uint32_t type: LOG_ENTRY_SITE (the site, then its strings) before the
+ * first record of a site, LOG_ENTRY_RECORD (a LogRecord).
+ */
+
+namespace bwmanager {
+
+#define LOG_MAX_SITES 4096
+#define LOG_MAX_ARGS 12
+#define LOG_RECORD_SIZE 128
+#define BINARY_LOG_MAGIC 0x3130474f4c4d4342ULL  // "BCMLOG01"
+#define BINARY_LOG_VERSION 1
+
+// the colors and names of the levels, indexed by LogLevel
+extern const char *loglevel_colors[];
+extern const char *loglevel_names[];
+
+struct LogSite {
+  int level;
+  const char *fmt;
+  const char *file;
+  int line;
+  const char *function;
+  uint32_t id;
+};
+
+// the argument types
+enum log_arg_type : uint8_t {
+  LOG_ARG_INT = 'i',
+  LOG_ARG_UINT = 'u',
+  LOG_ARG_DOUBLE = 'd',
+  LOG_ARG_STRING = 's',
+  LOG_ARG_POINTER = 'p'
+};
+
+struct LogRecord {
+  uint64_t time;  // nsec since the logger started
+  uint32_t site;
+  uint32_t tid;
+  uint16_t size;  // of the payload in use
+  uint8_t nargs;
+  uint8_t truncated;
+  uint8_t types[LOG_MAX_ARGS];
+  char payload[LOG_RECORD_SIZE - 32];
+};
+
+static_assert(sizeof(LogRecord) == LOG_RECORD_SIZE, "LogRecord layout");
+
+enum log_entry_type : uint32_t {
+  LOG_ENTRY_SITE = 1,
+  LOG_ENTRY_RECORD
+};
+
+struct BinaryLogHeader {
+  uint64_t magic;
+  uint32_t version;
+  int32_t pid;
+};
+
+// a site in the binary file, followed by the fmt, file and function strings
+struct BinaryLogSite {
+  uint32_t id;
+  int32_t level;
+  int32_t line;
+  uint16_t fmt_len;
+  uint16_t file_len;
+  uint16_t function_len;
+  uint16_t pad;
+};
+
+/*
+ * Encoding of the arguments, the strings are copied (they may not outlive
+ * the call), truncated if the payload is full
+ */
+inline bool log_put(LogRecord &r, log_arg_type type, const void *v, size_t n) {
+  if (r.nargs == LOG_MAX_ARGS || r.size + n > sizeof(r.payload)) {
+    r.truncated = 1;
+    return false;
+  }
+  r.types[r.nargs++] = type;
+  memcpy(r.payload + r.size, v, n);
+  r.size += n;
+  return true;
+}
+
+inline void log_encode(LogRecord &r, const char *s) {
+  if (s == NULL) {
+    s = "(null)";
+  }
+  size_t len = strlen(s);
+  size_t room = sizeof(r.payload) - r.size;
+  if (r.nargs == LOG_MAX_ARGS || room < sizeof(uint16_t) + 1) {
+    r.truncated = 1;
+    return;
+  }
+  if (len > room - sizeof(uint16_t)) {
+    len = room - sizeof(uint16_t);
+    r.truncated = 1;
+  }
+  uint16_t l = len;
+  r.types[r.nargs++] = LOG_ARG_STRING;
+  memcpy(r.payload + r.size, &l, sizeof(l));
+  memcpy(r.payload + r.size + sizeof(l), s, len);
+  r.size += sizeof(l) + len;
+}
+
+inline void log_encode(LogRecord &r, char *s) {
+  log_encode(r, (const char*) s);
+}
+
+inline void log_encode(LogRecord &r, const std::string &s) {
+  log_encode(r, s.c_str());
+}
+
+template<typename T>
+inline typename std::enable_if<
+    std::is_integral<T>::value || std::is_enum<T>::value>::type log_encode(
+    LogRecord &r, T v) {
+  if (std::is_signed<T>::value) {
+    int64_t x = (int64_t) v;
+    log_put(r, LOG_ARG_INT, &x, sizeof(x));
+  } else {
+    uint64_t x = (uint64_t) v;
+    log_put(r, LOG_ARG_UINT, &x, sizeof(x));
+  }
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type log_encode(
+    LogRecord &r, T v) {
+  double x = v;
+  log_put(r, LOG_ARG_DOUBLE, &x, sizeof(x));
+}
+
+template<typename T>
+inline void log_encode(LogRecord &r, const T *p) {
+  uint64_t x = (uint64_t) p;
+  log_put(r, LOG_ARG_POINTER, &x, sizeof(x));
+}
+
+// anything else with a conversion to a C string (e.g., a better enum name)
+template<typename T>
+inline typename std::enable_if<
+    !std::is_arithmetic<T>::value && !std::is_enum<T>::value
+        && !std::is_pointer<T>::value
+        && std::is_convertible<T, const char*>::value>::type log_encode(
+    LogRecord &r, const T &v) {
+  log_encode(r, (const char*) v);
+}
+
+inline void log_encode_all(LogRecord &r) {
+}
+
+template<typename Arg, typename ... Args>
+inline void log_encode_all(LogRecord &r, const Arg &arg, const Args &... args) {
+  log_encode(r, arg);
+  log_encode_all(r, args...);
+}
+
+/*
+ * Render the message of a record with the format of its site (printf
+ * conventions, the arguments are taken in order whatever their type)
+ */
+std::string log_format(const char *fmt, const LogRecord &r);
+
+/*
+ * Render a whole line as the synchronous logger prints it
+ * color: with the ANSI escape codes
+ */
+std::string log_format_line(const LogSite &site, const LogRecord &r, int pid,
+                            bool color);
+
+}
+
+#endif /* INCLUDE_BINARYLOG_HPP_ */
@@ -11,6 +11,7 @@
 #include <inttypes.h>
 #include <numa.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <string>
 #include <vector>
@@ -26,14 +27,75 @@ extern std::vector<int> BWMAN_CORES;
 extern int active_cpus;
 extern int fixed_ratio_value;
 
+extern int bwman_mode_value;  // see BWMAN_MODE
 extern double target_slo;
+extern bool target_slo_given;  // on the command line, wins over a checkpoint
 extern double target_slo_xapian;
 extern std::string server;
 extern int port;
 extern int current_remote_ratio;
 extern int optimal_mba;
+extern int optimal_llc_ways;
+extern int llc_control;  // shrink the BE LLC share before throttling with MBA
+// gains, setpoint (HP slack) and period (ms) of the PID mode
+extern double pid_kp;
+extern double pid_ki;
+extern double pid_kd;
+extern double pid_setpoint;
+extern int pid_period;
+// gradient step (%), learning rate, convergence (%), iterations and output
+// file of the bwap mode
+extern double bwap_step;
+extern double bwap_rate;
+extern double bwap_min_move;
+extern int bwap_max_iter;
+extern std::string bwap_weights_out;
 extern double delta_hp;  // operational region of the controller (5%) - HP
 extern double delta_be;  // operational region of the controller (5%) - BE
+// settle detection: sampling period, dead time and longest wait (usec),
+// samples that must stay within the noise, and the sliding window of the HP
+// p99 at the latency sources (usec)
+extern useconds_t settle_period;
+extern useconds_t settle_dead_time;
+extern useconds_t settle_max_wait;
+extern size_t settle_window;
+extern useconds_t latency_window;
+extern std::string be_priorities;  // "pid:priority,..."
+// 0=hardware, 1=trace replay (open-loop), 2=plant fitted to a trace,
+// 3=simulated
+extern int plant_mode;
+extern std::string trace_record_file;  // record a trace of the run
+extern std::string trace_replay_file;  // trace for the replay plants
+// the simulated plant: duration (sec), BE phases, BE throughput table
+extern int sim_duration;
+extern std::string sim_phases;
+extern int sim_phase_length;
+extern std::string sim_table;
+extern int sim_seed;
+// discovery of the BE segments from /proc: the BE processes (pids or
+// cgroup), the smallest mapping and resident size (bytes), the rescan
+// period (ms)
+extern std::string be_pids;
+extern std::string be_cgroup;
+extern unsigned long min_segment_size;
+extern unsigned long min_segment_rss;
+extern int discovery_period;
+// group of the segment queue (empty: the user of the manager only)
+extern std::string segment_queue_group;
+extern std::string control_socket;  // runtime control, empty: none
+// warm restart: checkpoint file (empty: none) and period (ms)
+extern std::string checkpoint_file_name;
+extern int checkpoint_period;
+// asynchronous logging, binary log file (empty: text to stdout)
+extern int log_async;
+extern std::string log_binary_file;
+// time series file (empty: none), chunks kept (0: all)
+extern std::string timeseries_file;
+extern int timeseries_max_chunks;
+extern int metrics_port;  // Prometheus endpoint on localhost, 0: none
+// Chrome trace of the actions (empty: none), rotated every max events
+extern std::string timeline_file;
+extern int timeline_max_events;
 
 // Worker Node
 extern int BWMAN_WORKERS;
@@ -51,6 +113,7 @@ extern double sum_nww;
 #define ADAPTATION_STEP 10  // E.g. Move 10% of shared pages to the worker nodes
 
 void start_bw_manager(void);
+void run_mode(void);  // run the controller of the selected mode
 
 #ifdef __cplusplus
 }  // extern "C"
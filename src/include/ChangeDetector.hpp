@@ -0,0 +1,66 @@
+/*
+ * ChangeDetector.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_CHANGEDETECTOR_HPP_
+#define INCLUDE_CHANGEDETECTOR_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Two-sided CUSUM change-point detector over a stream of samples
+ *
+ * The first warmup samples estimate the baseline (Welford mean/variance),
+ * afterwards every sample is standardized and accumulated in an upper and a
+ * lower CUSUM with a drift allowance of k standard deviations. A change is
+ * reported when either sum exceeds h standard deviations, the detector then
+ * re-learns the baseline of the new regime.
+ *
+ * The standard deviation has a floor of min_rel_std * |mean| so that a
+ * perfectly flat baseline does not turn noise into a change.
+ */
+class ChangeDetector {
+ public:
+  ChangeDetector(double k, double h, size_t warmup, double min_rel_std);
+
+  // returns true if a change has been detected at this sample
+  bool update(double x);
+  // forget the baseline (e.g., after the controller changed the plant)
+  void rearm();
+
+  inline bool armed() const {
+    return n >= _warmup;
+  }
+  inline double mean() const {
+    return _mean;
+  }
+
+ private:
+  double _k;
+  double _h;
+  size_t _warmup;
+  double _min_rel_std;
+
+  size_t n;
+  double _mean;
+  double m2;
+  double g_pos;
+  double g_neg;
+};
+
+/*
+ * Feed one sample of every monitored series (e.g., stall rate and bandwidth
+ * of every application), returns true if any of them changed phase
+ * a series added or removed (e.g., a BE came or went) starts all over
+ */
+bool detect_phase_change(const std::vector<double> &sample);
+
+/*
+ * Re-learn the baseline of every series
+ */
+void rearm_phase_detection(void);
+
+#endif /* INCLUDE_CHANGEDETECTOR_HPP_ */
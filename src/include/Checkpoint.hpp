@@ -0,0 +1,48 @@
+/*
+ * Checkpoint.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_CHECKPOINT_HPP_
+#define INCLUDE_CHECKPOINT_HPP_
+
+/*
+ * Warm restart from a memory-mapped checkpoint file (CHECKPOINT)
+ *
+ * Every CHECKPOINT_PERIOD the controller saves its state: mode, remote
+ * ratio, MBA level and L3 ways (globally and per BE), SLO targets, settle
+ * time estimates, the performance table and the segment table. The file
+ * holds two copies written in turn, the header points to the last complete
+ * one, so a crash in the middle of a save leaves the previous one valid.
+ *
+ * On startup the segments of the BEs still alive (same pid and process start
+ * time) are registered again (the one-shot handoff of the previous run is
+ * gone) and, once the segments are known, the operating point is resumed if
+ * the live placement still matches the saved remote ratio. The SLO targets
+ * are resumed unless TARGET_SLO was given. The model and the settle
+ * estimates are resumed in any case (same mode and grid).
+ */
+
+/*
+ * Map the checkpoint file, load the last valid state and register the
+ * segments of the BEs still alive
+ * returns true if there is a state to resume from
+ */
+bool open_checkpoint(void);
+
+/*
+ * Resume from the loaded state, after get_memory_segments()
+ * returns true if the operating point was resumed
+ */
+bool restore_checkpoint(void);
+
+/*
+ * Save the state now / if CHECKPOINT_PERIOD has elapsed (controller thread)
+ */
+void save_checkpoint(void);
+void checkpoint_if_due(void);
+
+void close_checkpoint(void);
+
+#endif /* INCLUDE_CHECKPOINT_HPP_ */
@@ -0,0 +1,46 @@
+/*
+ * ControlServer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_CONTROLSERVER_HPP_
+#define INCLUDE_CONTROLSERVER_HPP_
+
+/*
+ * Runtime control over a Unix domain socket (CONTROL_SOCKET)
+ *
+ * One request per line, one response line per request, "ok [...]" or
+ * "error <reason>":
+ *   state                          the controller state (key=value ...)
+ *   slo <memcached|xapian> <target>  set the SLO target of a source
+ *   mode <0-9>                     switch the mode (see BWMAN_MODE), 9
+ *                                  (bwap) is refused without the stall
+ *                                  rate counters
+ *   ratio <0-100>                  force the remote ratio of the BE pages
+ *   mba <level>                    force the MBA level of the BEs
+ *   period <ms>                    set the monitoring (and PID) period
+ *   pause                          stop controlling, the hardware is kept
+ *                                  as is (MBA, LLC, placement)
+ *   resume                         control again
+ * e.g., with CONTROL_SOCKET=/tmp/bwman.sock,
+ *   echo state | socat - UNIX-CONNECT:/tmp/bwman.sock
+ *
+ * The requests (but state) are applied by the controller thread at its
+ * next period, a forced ratio or MBA level holds until the mode changes it
+ * again (pause first to keep it).
+ */
+
+void start_control_server(void);
+void stop_control_server(void);
+
+/*
+ * Controller side: apply the pending requests, check for pause and for a
+ * mode switch (taking the requested mode)
+ */
+void control_apply_requests(void);
+bool control_paused(void);
+bool control_mode_requested(void);
+bool control_take_mode(int *mode);
+
+#endif /* INCLUDE_CONTROLSERVER_HPP_ */
@@ -0,0 +1,110 @@
+/*
+ * Histogram.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_HISTOGRAM_HPP_
+#define INCLUDE_HISTOGRAM_HPP_
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+
+#include "include/Logger.hpp"
+
+/*
+ * Log2-bucketed histogram, bucket i counts the values in [2^(i-1), 2^i)
+ * Updates are lock-free so that it can be read from another thread
+ */
+class Histogram {
+ public:
+  static const int NUM_BUCKETS = 48;
+
+  Histogram() {
+    reset();
+  }
+
+  inline void add(uint64_t value) {
+    int b = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    if (b >= NUM_BUCKETS)
+      b = NUM_BUCKETS - 1;
+    buckets[b].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t m = _max.load(std::memory_order_relaxed);
+    while (value > m
+        && !_max.compare_exchange_weak(m, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  inline void reset() {
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+  }
+
+  inline uint64_t count() const {
+    return _count.load(std::memory_order_relaxed);
+  }
+
+  inline uint64_t sum() const {
+    return _sum.load(std::memory_order_relaxed);
+  }
+
+  inline uint64_t max() const {
+    return _max.load(std::memory_order_relaxed);
+  }
+
+  inline uint64_t bucket(int i) const {
+    return buckets[i].load(std::memory_order_relaxed);
+  }
+
+  // upper bound of bucket i
+  static inline uint64_t bucket_bound(int i) {
+    return i == 0 ? 0 : (1ULL << i) - 1;
+  }
+
+  // upper bound of the bucket holding the p-th percentile (p in [0, 1])
+  inline uint64_t percentile(double p) const {
+    uint64_t total = count();
+    uint64_t seen = 0;
+    if (total == 0)
+      return 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      seen += bucket(i);
+      if (seen >= p * total)
+        return bucket_bound(i) < max() ? bucket_bound(i) : max();
+    }
+    return max();
+  }
+
+  inline void print(const char *name, const char *unit) const {
+    uint64_t total = count();
+    if (total == 0) {
+      LINFOF("%s: no samples", name);
+      return;
+    }
+    LINFOF("%s: count %" PRIu64 ", mean %" PRIu64 " %s, p50 <= %" PRIu64
+           " %s, p99 <= %" PRIu64 " %s, max %" PRIu64 " %s",
+           name, total, sum() / total, unit, percentile(0.5), unit,
+           percentile(0.99), unit, max(), unit);
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      if (bucket(i) != 0) {
+        LINFOF("  <= %12" PRIu64 " %s: %" PRIu64, bucket_bound(i), unit,
+               bucket(i));
+      }
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> buckets[NUM_BUCKETS];
+  std::atomic<uint64_t> _count;
+  std::atomic<uint64_t> _sum;
+  std::atomic<uint64_t> _max;
+};
+
+#endif /* INCLUDE_HISTOGRAM_HPP_ */
@@ -0,0 +1,40 @@
+/*
+ * Interleave.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_INTERLEAVE_HPP_
+#define INCLUDE_INTERLEAVE_HPP_
+
+#include <sys/types.h>
+
+#include <utility>
+#include <vector>
+
+/*
+ * The weighted interleave of BWAP, without the rest of the manager (the
+ * migration benchmark links it alone): the weights of a remote ratio, the
+ * node of every page by the weights, the move of the pages
+ */
+
+// the weights of the placement, (weight %, node) in ascending order
+extern std::vector<std::pair<double, int>> BWMAN_WEIGHTS_temp;
+
+// the weights of a remote ratio s (%) into BWMAN_WEIGHTS_temp
+void get_new_weights(double s);
+void get_new_weights_v2(double s);
+
+// the addresses of the page_count pages of pagesize from start
+void build_page_array(void *start, unsigned long page_count, int pagesize,
+                      void **addr);
+// the node of every page, interleaved by the weights (ascending, sum 100)
+void build_node_array(const std::vector<std::pair<double, int>> &weights,
+                      unsigned long page_count, int *nodes);
+// move_pages(2) batch pages at a time (0: all in one call), the pages not
+// moved or the result of the first failing call
+long move_pages_batched(pid_t pid, unsigned long page_count, void **addr,
+                        const int *nodes, int *status, unsigned long batch,
+                        int flags);
+
+#endif /* INCLUDE_INTERLEAVE_HPP_ */
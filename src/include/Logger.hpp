@@ -9,47 +9,58 @@
 #define INCLUDE_LOGGER_HPP_
 
 #include <dlfcn.h>
+#include <errno.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <ctime>
 #include <cstring>
 #include <cinttypes>
 #include <cstdio>
+#include <mutex>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <boost/stacktrace.hpp>
 
 #include "better-enums/enum.h"
+#include "include/BinaryLog.hpp"
 
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : \
                                                __FILE__)
 #define LFMT "\033[2m%22s:%-4d %-28s\033[m "
-#define LTRACE(msg) \
-  L->trace(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-#define LDEBUG(msg) \
-  L->debug(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-#define LINFO(msg) \
-  L->info(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-#define LWARN(msg) \
-  L->warn(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-#define LERROR(msg) \
-  L->error(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-#define LFATAL(msg) \
-  L->fatal(LFMT "%s", __FILENAME__, __LINE__, __FUNCTION__, msg);
-
-#define LTRACEF(fmt, ...) \
-  L->trace(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
-#define LDEBUGF(fmt, ...) \
-  L->debug(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
-#define LINFOF(fmt, ...) \
-  L->info(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
-#define LWARNF(fmt, ...) \
-  L->warn(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
-#define LERRORF(fmt, ...) \
-  L->error(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
-#define LFATALF(fmt, ...) \
-  L->fatal(LFMT fmt, __FILENAME__, __LINE__, __FUNCTION__, __VA_ARGS__);
+// the lowest level compiled in (cmake -DBWMAN_MIN_LOG_LEVEL=WARN), the
+// macros of the levels below compile to nothing
+#ifndef BWMAN_MIN_LOG_LEVEL
+#define BWMAN_MIN_LOG_LEVEL TRACE
+#endif
+// a call site is registered once, then only its arguments are logged
+#define LLOG(lvl, fmt, ...) \
+  do {\
+    if (std::integral_constant<bool,\
+        bwmanager::log_compiled(bwmanager::LogLevel::lvl)>::value\
+        && L->should_log(bwmanager::LogLevel::lvl)) {\
+      static const bwmanager::LogSite *_lsite = L->register_site(\
+          bwmanager::LogLevel::lvl, fmt, __FILENAME__, __LINE__, __FUNCTION__);\
+      L->log_site(*_lsite, __VA_ARGS__);\
+    }\
+  } while (0);
+#define LTRACE(msg) LLOG(TRACE, "%s", msg)
+#define LDEBUG(msg) LLOG(DEBUG, "%s", msg)
+#define LINFO(msg) LLOG(INFO, "%s", msg)
+#define LWARN(msg) LLOG(WARN, "%s", msg)
+#define LERROR(msg) LLOG(ERROR, "%s", msg)
+#define LFATAL(msg) LLOG(FATAL, "%s", msg)
+
+#define LTRACEF(fmt, ...) LLOG(TRACE, fmt, __VA_ARGS__)
+#define LDEBUGF(fmt, ...) LLOG(DEBUG, fmt, __VA_ARGS__)
+#define LINFOF(fmt, ...) LLOG(INFO, fmt, __VA_ARGS__)
+#define LWARNF(fmt, ...) LLOG(WARN, fmt, __VA_ARGS__)
+#define LERRORF(fmt, ...) LLOG(ERROR, fmt, __VA_ARGS__)
+#define LFATALF(fmt, ...) LLOG(FATAL, fmt, __VA_ARGS__)
 
 #define DIE(msg) \
   printf("\n\n");\
@@ -89,14 +100,20 @@ namespace bwmanager {
 
 BETTER_ENUM(LogLevel, int, TRACE, DEBUG, INFO, WARN, ERROR, FATAL, OFF)
 
-static const char *loglevel_colors[] = { "\033[37m",         // trace: white
-    "\033[36m",         // debug: cyan
-    "\033[32m",         // info: green
-    "\033[43m\033[1m",  // warn: yellow bold
-    "\033[31m\033[1m",  // error: red bold
-    "\033[1m\033[41m",  // fatal: bold on red
-    "\033[m"            // off: none
-    };
+constexpr bool log_compiled(LogLevel::_enumerated lvl) {
+  return lvl >= LogLevel::BWMAN_MIN_LOG_LEVEL;
+}
+
+#define LOG_RING_SIZE 2048  // records per thread
+
+// the records of a thread, single producer (the thread), single consumer
+struct LogRing {
+  LogRecord records[LOG_RING_SIZE];
+  std::atomic<uint64_t> head;  // next record to write
+  std::atomic<uint64_t> tail;  // next record to read
+  std::atomic<uint64_t> dropped;  // records lost to a full ring
+  uint32_t tid;
+};
 
 class Logger {
  private:
@@ -135,9 +152,57 @@ class Logger {
   }
 
   inline void printHorizontalRule(std::string msg = "", int bgcolor = 1) {
+    flush();
     printf("\033[4%dm%-160s\033[m\n", bgcolor % 8, msg.c_str());
   }
 
+  inline bool should_log(LogLevel lvl) {
+    return lvl >= _loglevel;
+  }
+
+  /*
+   * Asynchronous logging: the L* macros only copy their arguments into the
+   * ring of the thread, a logger thread formats the records to stdout (or
+   * writes them raw to binary_file, see bwlogdecode) every millisecond.
+   * Errors are flushed right away.
+   */
+  void start_async(const std::string &binary_file = "");
+  void stop_async();
+  // write out the pending records
+  void flush();
+
+  const LogSite *register_site(LogLevel lvl, const char *fmt, const char *file,
+                               int line, const char *function);
+
+  template<typename ... Args>
+  inline void log_site(const LogSite &site, const Args &... args) {
+    if (!_async.load(std::memory_order_relaxed)) {
+      print_prefix(site.level);
+      printf(LFMT, site.file, site.line, site.function);
+      printf(site.fmt, args...);
+      printf("\n");
+      return;
+    }
+    LogRing *ring = thread_ring();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) == LOG_RING_SIZE) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    LogRecord &r = ring->records[head % LOG_RING_SIZE];
+    r.time = elapsed();
+    r.site = site.id;
+    r.tid = ring->tid;
+    r.size = 0;
+    r.nargs = 0;
+    r.truncated = 0;
+    log_encode_all(r, args...);
+    ring->head.store(head + 1, std::memory_order_release);
+    if (site.level >= LogLevel::ERROR) {
+      flush();
+    }
+  }
+
   template<typename Arg1, typename ... Args>
   inline void trace(const char *fmt, const Arg1 &arg1, const Args &... args) {
     log(LogLevel::TRACE, fmt, arg1, args...);
@@ -201,8 +266,39 @@ class Logger {
  private:
   LogLevel _loglevel = LogLevel::DEBUG;
 
-  inline bool should_log(LogLevel lvl) {
-    return lvl >= _loglevel;
+  std::atomic<bool> _async { false };
+  std::thread _thread;
+  std::mutex _mutex;  // the sites, the rings and the output
+  std::vector<const LogSite*> _sites;
+  std::vector<LogRing*> _rings;
+  std::vector<bool> _sites_written;
+  FILE *_binary = NULL;
+
+  LogRing *new_ring();
+  void write_binary_site(const LogSite &site);
+  void run();
+
+  inline LogRing *thread_ring() {
+    static thread_local LogRing *ring = NULL;
+    if (ring == NULL) {
+      ring = new_ring();
+    }
+    return ring;
+  }
+
+  // nsec since the logger started
+  inline uint64_t elapsed() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - startTime.tv_sec) * 1000000000ULL + now.tv_nsec
+        - startTime.tv_nsec;
+  }
+
+  inline void print_prefix(int lvl) {
+    char time_str[32];
+    getElapsedTimeString(time_str, sizeof(time_str));
+    printf("\033[2m%s \033[4%dm%6d\033[m %s%5s\033[m ", time_str, getpid() % 8,
+           getpid(), loglevel_colors[lvl], loglevel_names[lvl]);
   }
 
   inline void getElapsedTimeString(char *str, size_t len) {
@@ -223,10 +319,10 @@ class Logger {
     if (!should_log(lvl)) {
       return;
     }
-    char time_str[32];
-    getElapsedTimeString(time_str, sizeof(time_str));
-    printf("\033[2m%s \033[4%dm%6d\033[m %s%5s\033[m ", time_str, getpid() % 8,
-           getpid(), loglevel_colors[lvl], lvl._to_string());
+    if (_async.load(std::memory_order_relaxed)) {
+      flush();
+    }
+    print_prefix(lvl);
     printf(fmt, args...);
     printf("\n");
   }
@@ -1,4 +1,5 @@
 #include <inttypes.h>
+#include <vector>
 /*
  * translates definition of single
  * allocation class of service
@@ -21,4 +22,60 @@ void initialize_mba();
 /*
  * Reset mba
  */
-void reset_mba();
\ No newline at end of file
+void reset_mba();
+/*
+ * Discover the valid MBA levels of the platform from the pqos capability
+ * (throttle_step/throttle_max), falling back to resctrl info/MB
+ */
+void discover_mba_levels();
+
+/*
+ * Measure the bandwidth response of every MBA level with a streaming kernel
+ * pinned to the given core and drop levels that do not change the bandwidth
+ * (never the maximum). One core may not saturate the memory, so it is off
+ * by default (MBA_CALIBRATION), core < 0 keeps the nominal levels.
+ */
+void calibrate_mba_levels(int core);
+
+/*
+ * Valid MBA levels (ascending) and the MBA -> bandwidth (MB/s) lookup table
+ */
+const std::vector<int>& get_mba_levels();
+double get_mba_bandwidth(int mba_value);
+int get_min_mba();
+int get_max_mba();
+/*
+ * Number of classes of service with MBA, including the default class 0
+ */
+int get_num_mba_classes();
+/*
+ * Set the valid MBA levels and their bandwidth (e.g., from a trace)
+ */
+void set_mba_levels(const std::vector<int> &levels,
+                    const std::vector<double> &bandwidth);
+int get_next_mba(int mba_value);
+int get_prev_mba(int mba_value);
+
+/*
+ * Discover the L3 cache allocation (CAT) capability of the platform
+ * returns false if L3 CAT is not supported
+ */
+bool discover_l3ca();
+
+/*
+ * Set the L3 way mask of a class of service on the given socket
+ * (the first ways of the cache, pqos writes the L3: schemata via resctrl
+ * when running on the OS interface)
+ */
+int set_l3ca_allocation(const unsigned socket_id, const unsigned cos_value,
+                        const unsigned ways);
+
+/*
+ * Number of L3 ways that can be allocated to a class of service
+ */
+int get_min_llc_ways();
+int get_max_llc_ways();
+/*
+ * Set the number of L3 ways without touching the hardware (e.g., replay)
+ */
+void set_llc_ways(unsigned ways);
@@ -0,0 +1,70 @@
+/*
+ * Metrics.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_METRICS_HPP_
+#define INCLUDE_METRICS_HPP_
+
+#include <stdint.h>
+
+#define METRICS_MAX_BES 64
+#define METRICS_MAX_COS 16
+
+/*
+ * Telemetry of the controller in the Prometheus text format, served on
+ * http://127.0.0.1:METRICS_PORT/metrics by a thread of its own (off by
+ * default)
+ *
+ * The controller thread publishes a snapshot of its state at every
+ * iteration into a seqlock, the server (and the state request of the
+ * runtime control) copies the snapshot out without blocking the controller
+ * (it retries if it raced with a publication).
+ * The histograms (actuation latency, loop iteration time, the self-profile
+ * of Profiler.hpp) are lock-free and read in place.
+ */
+
+struct metrics_be {
+  int32_t pid;
+  int32_t cos;
+  int32_t mba;
+  int32_t ratio;
+  double bandwidth;
+  double local_bandwidth;
+};
+
+// the state of the controller, written by the controller thread only
+struct MetricsSnapshot {
+  int mode;
+  int paused;
+  double target_slo[2];  // memcached, xapian
+  double latency[2];
+  double slack[2];
+  int violations_slack[2];  // slack below slack_up
+  int violations_target[2];  // latency above the target
+  int remote_ratio;
+  int mba;
+  int llc_ways;
+  unsigned period_ms;
+  uint64_t segments;
+  int num_cos;
+  int cos_mba[METRICS_MAX_COS];  // -1: never written
+  uint64_t bes_total;
+  int num_bes;  // the first METRICS_MAX_BES
+  metrics_be bes[METRICS_MAX_BES];
+  uint64_t iterations;
+};
+
+// controller thread: publish the state, once per loop iteration
+void metrics_publish(void);
+
+// a consistent copy of the last snapshot, from any thread
+void metrics_read_snapshot(MetricsSnapshot *s);
+
+// a page placement of pages (bytes) that took nsec
+void metrics_record_migration(uint64_t pages, uint64_t bytes, uint64_t nsec);
+
+void start_metrics_server(void);
+
+#endif /* INCLUDE_METRICS_HPP_ */
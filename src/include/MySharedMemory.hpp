@@ -29,6 +29,8 @@ class MySharedMemory {
 };
 
 std::vector<MySharedMemory> get_shared_memory();
+// non-blocking, returns false while the BE has not created the segment yet
+bool try_get_shared_memory(std::vector<MySharedMemory> &mem_segments);
 void destroy_shared_memory();
 void test();
 
@@ -15,6 +15,7 @@
 #include <sys/syscall.h>
 #include <errno.h>
 
+#include "include/Interleave.hpp"
 #include "include/MySharedMemory.hpp"
 
 #define PAGE_ALIGN_DOWN(x) (((intptr_t) (x)) & PAGE_MASK)
@@ -23,8 +24,15 @@
 static const int PAGE_SIZE = sysconf(_SC_PAGESIZE);
 static const int PAGE_MASK = (~(PAGE_SIZE - 1));
 
-void move_pages_remote(pid_t pid, void *addr, unsigned long len, double ratio);
+// the pages interleaved by the weights, (weight %, node) in ascending order
+void move_pages_remote(pid_t pid, void *addr, unsigned long len,
+                       const std::vector<std::pair<double, int>> &weights);
 void place_all_pages(std::vector<MySharedMemory> mem_segments, double ratio);
-void get_new_weights(double s);
+// weights (%) of the pages on every node
+void place_all_pages(std::vector<MySharedMemory> mem_segments,
+                     const std::vector<double> &weights);
+// share of the resident pages off the worker node (%), sampled, -1 if none
+double get_remote_ratio(const std::vector<MySharedMemory> &mem_segments,
+                        int max_samples);
 
 #endif /* INCLUDE_PAGEPLACEMENT_HPP_ */
@@ -28,7 +28,8 @@
 #include "include/BwManager.hpp"
 #include "include/Logger.hpp"
 
-void initialize_likwid();
+bool initialize_likwid();  // false if the counters cannot be set up
+bool likwid_initialized();  // whether the counters have been set up
 
 std::vector<double> get_stall_rate();  // via Like I Knew What I'm Doing (LIKWID Library!)
 void stop_all_counters();  // Restarting it might have some issues if counters are not stopped!
@@ -42,10 +43,27 @@ std::vector<double> get_average_stall_rate(int num_measurements,
                                            useconds_t usec_between_measurements,
                                            int num_outliers_to_filter);
 
+#if defined(__unix__) || defined(__linux__)
+// System-specific definitions for Linux
+
 // read time stamp counter
-inline uint64_t readtsc(void);
+inline uint64_t readtsc(void) {
+  uint32_t lo, hi;
+  __asm __volatile__("rdtsc" : "=a"(lo), "=d"(hi) : :);
+  return lo | (uint64_t) hi << 32;
+}
 
 // read performance monitor counter
-inline uint64_t readpmc(int32_t n);
+inline uint64_t readpmc(int32_t n) {
+  uint32_t lo, hi;
+  __asm __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(n) :);
+  return lo | (uint64_t) hi << 32;
+}
+
+#else  // not Linux
+
+#error We only support Linux
+
+#endif
 
 #endif /* INCLUDE_PERFORMANCECOUNTERS_HPP_ */
@@ -0,0 +1,81 @@
+/*
+ * PerformanceModel.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_PERFORMANCEMODEL_HPP_
+#define INCLUDE_PERFORMANCEMODEL_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Online performance model over the (remote ratio x MBA) grid
+ *
+ * Every observation updates the cell of the grid it was taken at (the online
+ * version of the mba_table[ratio][mba] of test/mba_logs_processor.py) and a
+ * bilinear surrogate fitted over the observed cells predicts the HP slack
+ * and the BE throughput of the cells that have not been probed yet.
+ * next_probe() picks the cell that maximizes the (optimistic) BE throughput
+ * among the cells predicted to meet every SLO.
+ */
+class PerformanceModel {
+ public:
+  struct Cell {
+    int count;
+    double slack;    // min slack over all the HP sources
+    double be_perf;  // BE throughput (any monotonic metric)
+  };
+
+  PerformanceModel();
+
+  void reset(const std::vector<int> &ratios, const std::vector<int> &mbas);
+  // forget the observations, keeping the grid
+  void clear();
+  void observe(int ratio, int mba, double slack, double be_perf);
+
+  /*
+   * Pick the next (ratio, mba) to probe, given the current configuration
+   * returns false if the current configuration is the best known one
+   */
+  bool next_probe(int current_ratio, int current_mba, double min_slack,
+                  int *ratio, int *mba) const;
+
+  double predict_slack(int ratio, int mba) const;
+  double predict_be(int ratio, int mba) const;
+  double uncertainty(int ratio, int mba) const;
+  int observations() const;
+  void print() const;
+
+  inline const std::vector<int>& get_ratios() const {
+    return ratios;
+  }
+  inline const std::vector<int>& get_mbas() const {
+    return mbas;
+  }
+  inline const std::vector<Cell>& get_cells() const {
+    return cells;
+  }
+  // restore a table (e.g., from a checkpoint)
+  void set_cells(const std::vector<Cell> &c);
+
+ private:
+  static const int NUM_COEFFS = 4;
+
+  std::vector<int> ratios;
+  std::vector<int> mbas;
+  std::vector<Cell> cells;
+  double slack_coeffs[NUM_COEFFS];
+  double be_coeffs[NUM_COEFFS];
+
+  int index(int ratio, int mba) const;
+  int nearest(const std::vector<int> &v, int value) const;
+  void features(size_t r, size_t m, double *x) const;
+  void refit();
+  double predict(const double *coeffs, size_t r, size_t m) const;
+};
+
+extern PerformanceModel perf_model;
+
+#endif /* INCLUDE_PERFORMANCEMODEL_HPP_ */
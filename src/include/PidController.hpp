@@ -0,0 +1,47 @@
+/*
+ * PidController.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_PIDCONTROLLER_HPP_
+#define INCLUDE_PIDCONTROLLER_HPP_
+
+/*
+ * Discrete PID controller
+ * - the integral term holds the accumulated output, so reset() gives a
+ *   bumpless start from the current actuator value
+ * - the derivative acts on the (low-pass filtered) measurement, so a change
+ *   of the setpoint does not kick the output
+ * - conditional integration (anti-windup): the integral is frozen while the
+ *   output is saturated and the error pushes it further out
+ */
+class PidController {
+ public:
+  PidController(double kp, double ki, double kd, double out_min,
+                double out_max);
+
+  void reset(double output);
+  double update(double setpoint, double measurement, double dt);
+
+  inline double output() const {
+    return _output;
+  }
+
+  inline void limits(double out_min, double out_max) {
+    _out_min = out_min;
+    _out_max = out_max;
+  }
+
+ private:
+  double _kp, _ki, _kd;
+  double _out_min, _out_max;
+
+  double integral;
+  double prev_measurement;
+  double derivative;
+  bool first;
+  double _output;
+};
+
+#endif /* INCLUDE_PIDCONTROLLER_HPP_ */
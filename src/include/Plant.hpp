@@ -0,0 +1,196 @@
+/*
+ * Plant.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_PLANT_HPP_
+#define INCLUDE_PLANT_HPP_
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "include/Actuator.hpp"
+#include "include/MySharedMemory.hpp"
+
+/*
+ * What the controller observes and acts on
+ *
+ * sensors: latency of the HP applications and stall rate of every monitored
+ * core, actuators: the hardware writes of the actuator and the remote ratio
+ * of the BE pages, time: the clock the control loops and the settle
+ * detector run on (usec)
+ *
+ * The hardware is the default plant, the replay and simulated plants run on
+ * a virtual clock so a policy can be evaluated as fast as possible
+ */
+class Plant {
+ public:
+  virtual ~Plant() {
+  }
+
+  virtual const char* name() const = 0;
+
+  // sensors
+  virtual double latency() = 0;
+  virtual double latency_xpn() = 0;
+  virtual bool has_counters() = 0;
+  virtual std::vector<double> stall_rate() = 0;
+
+  // actuators, write() returns < 0 on error
+  virtual int write(actuator_resource res, unsigned socket_id,
+                    unsigned cos_value, int value) = 0;
+  virtual void place_pages(const std::vector<MySharedMemory> &segments,
+                           int ratio) = 0;
+  // all the segments of the BE
+  void place_pages(int ratio);
+  // weights (%) of the pages on every node; the plants that model a single
+  // worker node (0) place the share off it as the ratio
+  virtual void place_weights(const std::vector<MySharedMemory> &segments,
+                             const std::vector<double> &weights);
+  void place_weights(const std::vector<double> &weights);
+
+  // time
+  virtual uint64_t now() = 0;
+  virtual void sleep_until(uint64_t t) = 0;
+
+  void sleep(useconds_t usec) {
+    sleep_until(now() + usec);
+  }
+};
+
+/*
+ * The running machine: pqos, move_pages, the latency sockets and likwid
+ */
+class HardwarePlant : public Plant {
+ public:
+  const char* name() const {
+    return "hardware";
+  }
+
+  double latency();
+  double latency_xpn();
+  bool has_counters();
+  std::vector<double> stall_rate();
+
+  int write(actuator_resource res, unsigned socket_id, unsigned cos_value,
+            int value);
+  void place_pages(const std::vector<MySharedMemory> &segments, int ratio);
+  using Plant::place_pages;
+  void place_weights(const std::vector<MySharedMemory> &segments,
+                     const std::vector<double> &weights);
+  using Plant::place_weights;
+
+  uint64_t now();
+  void sleep_until(uint64_t t);
+};
+
+/*
+ * Forwards to another plant and writes every sample and every action to a
+ * binary trace (see Trace.hpp)
+ */
+class RecordingPlant : public Plant {
+ public:
+  explicit RecordingPlant(Plant *inner);
+
+  const char* name() const {
+    return _inner->name();
+  }
+
+  double latency();
+  double latency_xpn();
+  bool has_counters();
+  std::vector<double> stall_rate();
+
+  int write(actuator_resource res, unsigned socket_id, unsigned cos_value,
+            int value);
+  void place_pages(const std::vector<MySharedMemory> &segments, int ratio);
+  using Plant::place_pages;
+  void place_weights(const std::vector<MySharedMemory> &segments,
+                     const std::vector<double> &weights);
+  using Plant::place_weights;
+
+  uint64_t now();
+  void sleep_until(uint64_t t);
+
+ private:
+  Plant *_inner;
+};
+
+/*
+ * Base of the plants that run on a virtual clock (replay, simulation)
+ * they model a single BE: every BE class and segment acts on it
+ *
+ * sleep_until() advances the clock in steps of virtual_period, every step
+ * moves the plant (step()) and accounts the SLO violations and the BE
+ * throughput of the policy; when the duration is over the evaluation is
+ * printed and the manager exits
+ */
+class VirtualPlant : public Plant {
+ public:
+  explicit VirtualPlant(uint64_t duration);
+
+  int write(actuator_resource res, unsigned socket_id, unsigned cos_value,
+            int value);
+  void place_pages(const std::vector<MySharedMemory> &segments, int ratio);
+  using Plant::place_pages;
+
+  uint64_t now() {
+    return _now;
+  }
+  void sleep_until(uint64_t t);
+
+ protected:
+  // move the plant by dt usec
+  virtual void step(uint64_t dt) {
+  }
+  // throughput of the BE (0 - 1): its bandwidth relative to the
+  // unthrottled BE, or its unstalled fraction of cycles with counters
+  virtual double be_throughput();
+  void finish();
+
+  uint64_t _now;
+  uint64_t _duration;
+  // state of the BE: MBA level and L3 ways of its class, remote ratio
+  int _mba;
+  int _llc_ways;
+  int _ratio;
+
+ private:
+  void account(uint64_t dt);
+
+  uint64_t time_violated;
+  uint64_t time_violated_xpn;
+  uint64_t time_near;  // slack below slack_up
+  double be_work;
+  unsigned long num_mba_writes;
+  unsigned long num_llc_writes;
+  unsigned long num_migrations;
+  unsigned long migrated;  // sum of the ratio changes (% of the BE pages)
+};
+
+/*
+ * The plant every control loop runs on
+ */
+extern Plant *plant;
+
+/*
+ * Select the plant from the configuration (PLANT, TRACE_*, SIM_*)
+ */
+void initialize_plant(void);
+
+/*
+ * Whether the plant is the real machine (i.e., pqos/likwid/sockets are set
+ * up and must be cleaned up)
+ */
+bool plant_is_hardware(void);
+
+/*
+ * Release the plant (flushes the trace)
+ */
+void finalize_plant(void);
+
+#endif /* INCLUDE_PLANT_HPP_ */
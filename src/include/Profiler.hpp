@@ -0,0 +1,66 @@
+/*
+ * Profiler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_PROFILER_HPP_
+#define INCLUDE_PROFILER_HPP_
+
+#include <stdint.h>
+
+#include "include/Histogram.hpp"
+
+/*
+ * Self-profile of the manager: what the controller costs the machine it
+ * shares with the HP and the BEs
+ *
+ * Every section keeps the wall time and the CPU time of the thread that ran
+ * it (CLOCK_THREAD_CPUTIME_ID, nsec), and the TSC cycles, in log2
+ * histograms. The clocks are the real ones, also on the virtual plants.
+ * The summary is printed at the end, the histograms are also served with
+ * the telemetry (METRICS_PORT).
+ */
+
+enum profile_section {
+  PROF_ITERATION,  // control loop, from one iteration to the next
+  PROF_MEASUREMENT,  // a latency or stall rate read
+  PROF_ACTUATION,  // a hardware write (MBA, LLC)
+  PROF_MIGRATION,  // a move_pages batch (a BE segment)
+  PROF_NUM_SECTIONS
+};
+
+struct ProfileStats {
+  Histogram wall;  // nsec
+  Histogram cpu;  // nsec of the thread
+  Histogram cycles;  // TSC
+};
+
+const char* profile_section_name(profile_section section);
+const ProfileStats& profile_stats(profile_section section);
+
+// controller thread: once per loop iteration (see keep_running())
+void profile_iteration(void);
+
+// CPU time of the whole manager (user + sys), in nsec
+uint64_t profile_process_cpu(void);
+
+void profile_print_summary(void);
+
+/*
+ * A section from its construction to its destruction, e.g.
+ *   ProfileScope scope(PROF_ACTUATION);
+ */
+class ProfileScope {
+ public:
+  explicit ProfileScope(profile_section section);
+  ~ProfileScope();
+
+ private:
+  profile_section _section;
+  uint64_t _wall;
+  uint64_t _cpu;
+  uint64_t _cycles;
+};
+
+#endif /* INCLUDE_PROFILER_HPP_ */
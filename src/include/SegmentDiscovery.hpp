@@ -0,0 +1,38 @@
+/*
+ * SegmentDiscovery.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_SEGMENTDISCOVERY_HPP_
+#define INCLUDE_SEGMENTDISCOVERY_HPP_
+
+#include <sys/types.h>
+
+#include <set>
+
+/*
+ * Discovery of the BE segments from /proc/<pid>/maps (and smaps), no
+ * cooperation from the BEs needed
+ *
+ * The BEs are given by pid (BE_PIDS) or by cgroup (BE_CGROUP, every process
+ * of the cgroup, rescanned). Their private anonymous and heap mappings of
+ * at least MIN_SEGMENT_SIZE bytes, and MIN_SEGMENT_RSS resident bytes when
+ * they are first seen, are managed. Every DISCOVERY_PERIOD the maps are
+ * read again and the difference with the previous scan goes to the segment
+ * registry, smaps is read only for the new mappings.
+ */
+
+bool discovery_enabled(void);
+
+/*
+ * The BE processes now: BE_PIDS and the processes of BE_CGROUP
+ */
+std::set<pid_t> get_be_pids(void);
+
+/*
+ * Rescan the BEs if the period elapsed (called by sync_segments())
+ */
+void discover_segments(void);
+
+#endif /* INCLUDE_SEGMENTDISCOVERY_HPP_ */
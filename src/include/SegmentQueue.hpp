@@ -0,0 +1,245 @@
+/*
+ * SegmentQueue.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_SEGMENTQUEUE_HPP_
+#define INCLUDE_SEGMENTQUEUE_HPP_
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <atomic>
+
+/*
+ * Registration channel between the BE processes and the manager
+ *
+ * A bounded multi-producer single-consumer queue (Vyukov) in the shared
+ * memory object SEGMENT_QUEUE_NAME, created by the manager. Producers
+ * (the BE processes, e.g., through the preload library) enqueue register
+ * and unregister events for their memory segments at any time, the manager
+ * drains the queue before it places pages. Every event carries a
+ * generation from a global counter so the manager can drop events that
+ * lost a race with a newer event on the same range (see
+ * segment_queue_generation()).
+ *
+ * A producer that stalls between claiming and publishing a slot may find it
+ * skipped (segment_queue_skip()) and reused by the next round, its late
+ * writes then mix with the event of that round. Every slot carries a tag of
+ * its position and fields, written last by the producer, and the manager
+ * drops the events whose tag does not match (torn).
+ *
+ * Header only and free of the manager code so producers can include it.
+ */
+#define SEGMENT_QUEUE_NAME "BwManSegments"
+#define SEGMENT_QUEUE_MAGIC 0x5345475155455545ULL  // "SEGQUEUE"
+#define SEGMENT_QUEUE_VERSION 2
+#define SEGMENT_QUEUE_CAPACITY 4096  // power of 2
+
+enum segment_event_type {
+  SEGMENT_REGISTER = 0,  // [start, start + length) may be migrated
+  SEGMENT_UNREGISTER,    // [start, start + length) is gone
+  SEGMENT_EXIT           // every segment of the process is gone
+};
+
+struct SegmentEvent {
+  std::atomic<uint64_t> sequence;
+  uint32_t type;
+  int32_t pid;
+  uint64_t start;
+  uint64_t length;
+  uint64_t generation;
+  std::atomic<uint64_t> tag;  // segment_event_tag(), written last
+};
+
+struct SegmentQueue {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  alignas(64) std::atomic<uint64_t> head;  // next slot to fill
+  alignas(64) std::atomic<uint64_t> tail;  // next slot to drain
+  alignas(64) std::atomic<uint64_t> generation;
+  std::atomic<uint64_t> dropped;  // events lost because the queue was full
+  std::atomic<uint64_t> torn;  // events dropped for a mismatching tag
+  SegmentEvent slots[SEGMENT_QUEUE_CAPACITY];
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "the segment queue needs lock-free 64-bit atomics");
+
+/*
+ * Reset a freshly created queue (manager side)
+ */
+inline void segment_queue_init(SegmentQueue *q) {
+  q->capacity = SEGMENT_QUEUE_CAPACITY;
+  q->version = SEGMENT_QUEUE_VERSION;
+  q->head.store(0, std::memory_order_relaxed);
+  q->tail.store(0, std::memory_order_relaxed);
+  q->generation.store(0, std::memory_order_relaxed);
+  q->dropped.store(0, std::memory_order_relaxed);
+  q->torn.store(0, std::memory_order_relaxed);
+  for (uint64_t i = 0; i < SEGMENT_QUEUE_CAPACITY; i++) {
+    q->slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  // publish the queue last, producers check the magic
+  std::atomic_thread_fence(std::memory_order_release);
+  q->magic = SEGMENT_QUEUE_MAGIC;
+}
+
+/*
+ * Map the queue of a running manager (producer side)
+ * returns NULL if there is no (valid) queue
+ */
+inline SegmentQueue* segment_queue_attach() {
+  int fd = shm_open("/" SEGMENT_QUEUE_NAME, O_RDWR, 0);
+  if (fd < 0) {
+    return NULL;
+  }
+  void *p = mmap(NULL, sizeof(SegmentQueue), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  SegmentQueue *q = (SegmentQueue*) p;
+  if (q->magic != SEGMENT_QUEUE_MAGIC || q->version != SEGMENT_QUEUE_VERSION) {
+    munmap(p, sizeof(SegmentQueue));
+    return NULL;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return q;
+}
+
+/*
+ * Take the generation of an event: before munmap() for an unregister, after
+ * mmap() for a register, so that a range unmapped and mapped again by
+ * another thread is registered with a newer generation
+ */
+inline uint64_t segment_queue_generation(SegmentQueue *q) {
+  return q->generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/*
+ * Tag of the event at pos: a hash of the position and the fields, two
+ * producers writing the slot leave a tag that matches neither's fields
+ */
+inline uint64_t segment_event_tag(uint64_t pos, uint32_t type, int32_t pid,
+                                  uint64_t start, uint64_t length,
+                                  uint64_t generation) {
+  const uint64_t fields[] = { ((uint64_t) type << 32) | (uint32_t) pid, start,
+      length, generation };
+  uint64_t h = pos;
+  for (uint64_t f : fields) {
+    h = (h ^ f) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+  }
+  return h;
+}
+
+/*
+ * Enqueue an event, never blocks
+ * returns false (and counts the event as dropped) if the queue is full or
+ * the slot was skipped before the event was published
+ */
+inline bool segment_queue_push(SegmentQueue *q, segment_event_type type,
+                               pid_t pid, uint64_t start, uint64_t length,
+                               uint64_t generation) {
+  uint64_t pos = q->head.load(std::memory_order_relaxed);
+  SegmentEvent *slot;
+
+  for (;;) {
+    slot = &q->slots[pos & (SEGMENT_QUEUE_CAPACITY - 1)];
+    uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+    int64_t diff = (int64_t) seq - (int64_t) pos;
+    if (diff == 0) {
+      if (q->head.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      q->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = q->head.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->type = type;
+  slot->pid = pid;
+  slot->start = start;
+  slot->length = length;
+  slot->generation = generation;
+  slot->tag.store(segment_event_tag(pos, type, pid, start, length, generation),
+                  std::memory_order_release);
+  // a skipped slot belongs to the next round, leave its sequence alone
+  uint64_t claimed = pos;
+  if (!slot->sequence.compare_exchange_strong(claimed, pos + 1,
+                                              std::memory_order_release)) {
+    q->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Dequeue an event (single consumer: the manager), the torn events are
+ * dropped and counted
+ * returns false if the queue is empty
+ */
+inline bool segment_queue_pop(SegmentQueue *q, SegmentEvent *event) {
+  for (;;) {
+    uint64_t pos = q->tail.load(std::memory_order_relaxed);
+    SegmentEvent *slot = &q->slots[pos & (SEGMENT_QUEUE_CAPACITY - 1)];
+    uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+
+    if ((int64_t) seq - (int64_t) (pos + 1) < 0) {
+      return false;
+    }
+    event->type = slot->type;
+    event->pid = slot->pid;
+    event->start = slot->start;
+    event->length = slot->length;
+    event->generation = slot->generation;
+    // the tag after the fields, a late producer writes it after its fields
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t tag = slot->tag.load(std::memory_order_relaxed);
+    slot->sequence.store(pos + SEGMENT_QUEUE_CAPACITY, std::memory_order_release);
+    q->tail.store(pos + 1, std::memory_order_relaxed);
+    if (tag == segment_event_tag(pos, event->type, event->pid, event->start,
+                                 event->length, event->generation)) {
+      return true;
+    }
+    q->torn.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/*
+ * Whether the slot at the tail is claimed by a producer but not published
+ * (single consumer), its position in *pos
+ */
+inline bool segment_queue_unpublished(SegmentQueue *q, uint64_t *pos) {
+  *pos = q->tail.load(std::memory_order_relaxed);
+  SegmentEvent *slot = &q->slots[*pos & (SEGMENT_QUEUE_CAPACITY - 1)];
+  return q->head.load(std::memory_order_relaxed) != *pos
+      && slot->sequence.load(std::memory_order_acquire) == *pos;
+}
+
+/*
+ * Skip the slot at the tail (single consumer), for a producer that died
+ * between claiming and publishing it: the queue would wait for it forever.
+ * If the producer was only late, it cannot publish its event any more (it
+ * counts it as dropped), but its writes may land in the event of the next
+ * round of the slot, which is then torn and dropped by segment_queue_pop().
+ */
+inline void segment_queue_skip(SegmentQueue *q) {
+  uint64_t pos = q->tail.load(std::memory_order_relaxed);
+  SegmentEvent *slot = &q->slots[pos & (SEGMENT_QUEUE_CAPACITY - 1)];
+  slot->sequence.store(pos + SEGMENT_QUEUE_CAPACITY, std::memory_order_release);
+  q->tail.store(pos + 1, std::memory_order_relaxed);
+}
+
+#endif /* INCLUDE_SEGMENTQUEUE_HPP_ */
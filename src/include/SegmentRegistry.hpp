@@ -0,0 +1,49 @@
+/*
+ * SegmentRegistry.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_SEGMENTREGISTRY_HPP_
+#define INCLUDE_SEGMENTREGISTRY_HPP_
+
+#include <vector>
+
+#include "include/MySharedMemory.hpp"
+
+/*
+ * The segment table of the manager, kept current from the registration
+ * queue (SegmentQueue.hpp) instead of the one-shot MyVector handoff
+ *
+ * Every BE range carries the generation of the event that registered it,
+ * events older than the ranges they overlap are stale and dropped. The
+ * legacy MyVector segments are imported as registrations.
+ */
+
+/*
+ * Create the registration queue, the BEs can register from then on
+ */
+void open_segment_registry(void);
+
+/*
+ * Remove the registration queue
+ */
+void close_segment_registry(void);
+
+/*
+ * Register and unregister segments received some other way (the legacy
+ * handoff, the discovery from /proc)
+ */
+void register_segments(const std::vector<MySharedMemory> &segments);
+void unregister_segments(const std::vector<MySharedMemory> &segments);
+void unregister_process(pid_t pid);
+
+/*
+ * Rescan the BEs (discovery), drain the queue, apply the events to the
+ * segment table and drop the processes that are gone. If the table changed,
+ * rebuild mem_segments and regroup the BEs.
+ * returns true if the table changed
+ */
+bool sync_segments(void);
+
+#endif /* INCLUDE_SEGMENTREGISTRY_HPP_ */
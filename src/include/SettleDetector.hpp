@@ -0,0 +1,95 @@
+/*
+ * SettleDetector.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_SETTLEDETECTOR_HPP_
+#define INCLUDE_SETTLEDETECTOR_HPP_
+
+#include <unistd.h>
+
+#include <deque>
+#include <vector>
+
+/*
+ * The actions whose settle time is measured
+ */
+enum settle_action {
+  SETTLE_MBA = 0,
+  SETTLE_LLC,
+  SETTLE_RATIO,
+  SETTLE_MAX_ACTIONS
+};
+
+/*
+ * State machine that decides when the plant has settled after an action
+ *
+ * IDLE -> DEAD_TIME: start() right after the action has been applied
+ * DEAD_TIME -> WATCHING: the dead time has passed (the action takes effect)
+ * WATCHING -> SETTLED: every signal stayed within the tolerance over the
+ *                      last window samples and shows no trend
+ * any -> TIMED_OUT: max_wait has passed
+ *
+ * step() is fed one sample (one value per signal, e.g., latency and stall
+ * rate of every application) per period by a timer
+ */
+class SettleDetector {
+ public:
+  enum State {
+    IDLE = 0,
+    DEAD_TIME,
+    WATCHING,
+    SETTLED,
+    TIMED_OUT
+  };
+
+  SettleDetector(useconds_t period, useconds_t dead_time, useconds_t max_wait,
+                 size_t window, double tolerance);
+
+  void start();
+  State step(const std::vector<double> &sample);
+
+  inline State state() const {
+    return _state;
+  }
+
+  inline bool done() const {
+    return _state == SETTLED || _state == TIMED_OUT;
+  }
+
+  // time since start() (usec)
+  inline useconds_t elapsed() const {
+    return _elapsed;
+  }
+
+ private:
+  useconds_t _period;
+  useconds_t _dead_time;
+  useconds_t _max_wait;
+  size_t _window;
+  double _tolerance;
+
+  State _state;
+  useconds_t _elapsed;
+  std::vector<std::deque<double>> windows;
+
+  bool is_stable(const std::deque<double> &w) const;
+};
+
+/*
+ * Commit the pending actuations and wait (timer-driven) until the plant
+ * settles or the cap is reached, returns the settle time (usec)
+ */
+useconds_t wait_settle(settle_action action);
+
+/*
+ * Smoothed settle time of an action (usec), 0 if never measured
+ * set: restore an estimate (e.g., from a checkpoint)
+ */
+double get_settle_estimate(settle_action action);
+void set_settle_estimate(settle_action action, double estimate);
+
+void settle_print_stats(void);
+
+#endif /* INCLUDE_SETTLEDETECTOR_HPP_ */
@@ -0,0 +1,77 @@
+/*
+ * Simulator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_SIMULATOR_HPP_
+#define INCLUDE_SIMULATOR_HPP_
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/Plant.hpp"
+
+/*
+ * Synthetic plant: one BE and the HP applications sharing the memory
+ * bandwidth of the HP node
+ *
+ * The BE alternates between phases of memory intensity (SIM_PHASES), its
+ * memory throughput is throttled by MBA and slowed down by remote pages,
+ * either following a parametric curve or a table of measured BE throughput
+ * per (MBA, remote ratio), the mba_table of test/mba_logs_processor.py
+ * (SIM_TABLE). The BE traffic left on the HP node (its local pages)
+ * contends with the HP applications whose p99 latency grows like a queue
+ * with the contention. Every knob acts with a first-order lag, migrations
+ * add their own traffic while they run and the latencies carry correlated
+ * noise.
+ */
+class SimulatedPlant : public VirtualPlant {
+ public:
+  SimulatedPlant();
+
+  const char* name() const {
+    return "simulated";
+  }
+
+  double latency();
+  double latency_xpn();
+  bool has_counters() {
+    return true;
+  }
+  std::vector<double> stall_rate();
+
+  void place_pages(const std::vector<MySharedMemory> &segments, int ratio);
+  using Plant::place_pages;
+
+ protected:
+  void step(uint64_t dt);
+  double be_throughput();
+
+ private:
+  // BE memory intensity (0 - 1) at the current time
+  double intensity();
+  // BE memory throughput (0 - 1) of a configuration, intensity excluded
+  double be_memory_throughput(int mba, int ratio, int ways);
+  double contention_target();
+  void load_table(const std::string &path);
+
+  std::vector<double> phases;
+  // optional measured BE throughput, table[mba row][ratio column]
+  std::vector<int> table_mbas;
+  std::vector<int> table_ratios;
+  std::vector<std::vector<double>> table;
+
+  std::mt19937 rng;
+  std::normal_distribution<double> normal;
+
+  double contention;  // lagged BE traffic on the HP node
+  double llc_share;   // lagged L3 share of the BE
+  double be_memory;   // lagged BE memory throughput
+  uint64_t migrating_until;
+  double noise;
+  double noise_xpn;
+};
+
+#endif /* INCLUDE_SIMULATOR_HPP_ */
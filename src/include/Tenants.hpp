@@ -0,0 +1,83 @@
+/*
+ * Tenants.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_TENANTS_HPP_
+#define INCLUDE_TENANTS_HPP_
+
+#include <unistd.h>
+
+#include <vector>
+
+#include "include/MySharedMemory.hpp"
+
+struct pqos_mon_data;
+
+/*
+ * State of one BE process
+ */
+struct BeProcess {
+  pid_t pid;
+  std::vector<MySharedMemory> segments;
+  unsigned long bytes;  // footprint of the segments
+  int ratio;            // remote ratio of its pages
+  unsigned cos;         // MBA class of service (may be shared)
+  int mba;              // MBA level of its class
+  int priority;         // higher priority BEs are throttled last
+  double bandwidth;        // memory bandwidth (MB/s)
+  double local_bandwidth;  // of which to the HP node (MB/s)
+  struct pqos_mon_data *mon;  // MBM group, NULL without MBM
+};
+
+extern std::vector<BeProcess> be_processes;
+
+/*
+ * Group the segments by process, give every BE its own MBA class while
+ * there are classes left (the last class is shared otherwise) and start
+ * monitoring its memory bandwidth (MBM)
+ */
+void initialize_be_processes(const std::vector<MySharedMemory> &segments);
+
+/*
+ * Regroup the segments after the segment table changed, the known BEs keep
+ * their state, the new ones get a class of their own and the BEs without
+ * segments left are dropped
+ */
+void update_be_segments(const std::vector<MySharedMemory> &segments);
+
+/*
+ * Stop the bandwidth monitoring
+ */
+void finalize_be_processes(void);
+
+/*
+ * Refresh the bandwidth of every BE, from MBM or, without MBM, estimated
+ * from its footprint, MBA level and remote ratio
+ */
+void update_be_bandwidth(void);
+
+/*
+ * Set the MBA level of a BE (of every BE of its class) and the remote ratio
+ * of its pages
+ */
+void set_be_mba(BeProcess &be, int mba_value);
+void set_be_ratio(BeProcess &be, int ratio);
+
+/*
+ * The arbiter
+ *
+ * pick_victim: the BE to throttle or migrate first when the HP slack
+ * drops, the one with the largest traffic to the HP node per unit of
+ * priority among those that can still be throttled
+ * pick_release: the BE to release first when there is slack again, the
+ * highest priority one, the lightest on the HP node between equals
+ * both return NULL if there is none
+ */
+BeProcess* arbiter_pick_victim(void);
+BeProcess* arbiter_pick_release(void);
+
+void print_be_processes(void);
+
+#endif /* INCLUDE_TENANTS_HPP_ */
@@ -0,0 +1,132 @@
+/*
+ * TimeSeries.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_TIMESERIES_HPP_
+#define INCLUDE_TIMESERIES_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Time series of the controller: the latency samples of the measurement
+ * thread and the actions of the control loops
+ *
+ * The rows are fixed-width and stored by columns in chunks of a file
+ * (TIMESERIES) that is written through mmap, two chunks at a time: the one
+ * being filled and the next one, mapped in advance. The memory of the
+ * recorder stays constant and a row is in the file as soon as it is
+ * recorded, even if the manager is killed. With TIMESERIES_MAX_CHUNKS (at
+ * least 2) the file is a ring of chunks, the oldest is overwritten. The
+ * file of the previous run is kept as <file>.1.
+ *
+ * File: a TimeSeriesHeader (TS_HEADER_SIZE bytes) describing the columns,
+ * then the chunks, each a TimeSeriesChunk followed by the columns of its
+ * chunk_rows rows at their offset. A reader (bwtsdump, numpy.memmap)
+ * orders the chunks by index and reads their first rows.
+ */
+
+#define TS_MAGIC 0x3153544e414d5742ULL  // "BWMANTS1"
+#define TS_VERSION 1
+#define TS_HEADER_SIZE 4096
+#define TS_CHUNK_ROWS 4096
+#define TS_MAX_COLUMNS 32
+
+// the actions, interned
+enum ts_action : uint8_t {
+  TS_NONE = 0,
+  TS_SAMPLE,  // a sample of the measurement thread
+  TS_ITERATION,
+  TS_APPLY_MBA,
+  TS_APPLY_RATIO,
+  TS_APPLY_LLC,
+  TS_APPLY_PROBE,
+  TS_PHASE_CHANGE,
+  TS_APPLY_WEIGHTS,
+  TS_ACTIONS
+};
+
+inline const char *ts_action_name(int action) {
+  static const char *names[] = { "-", "sample", "iteration", "apply_mba",
+      "apply_ratio", "apply_llc", "apply_probe", "phase_change", "apply_weights" };
+  return action >= 0 && action < TS_ACTIONS ? names[action] : "?";
+}
+
+// an action and its arguments, e.g. {TS_APPLY_MBA, level, 0, be pid}
+struct TsAction {
+  ts_action type;
+  int value;
+  int value2;
+  int pid;  // of the BE, 0: all
+};
+
+struct TimeSeriesRow {
+  uint64_t time;  // nsec since the epoch (of the plant clock if virtual)
+  uint32_t counter;
+  uint8_t action;
+  int32_t pid;
+  int32_t value;
+  int32_t value2;
+  int32_t remote_ratio;
+  int32_t mba;
+  double target_slo;
+  double latency;
+  double latency_xpn;
+  double slack;
+  double hp_stall_rate;
+  double be_stall_rate;
+};
+
+struct TimeSeriesColumn {
+  char name[20];
+  char type;  // 'u', 'i' or 'f'
+  uint8_t size;
+  uint16_t row_offset;  // in TimeSeriesRow
+  uint64_t offset;  // in a chunk
+};
+
+// the columns of a row
+static const TimeSeriesColumn ts_columns[] = {
+    { "time", 'u', 8, offsetof(TimeSeriesRow, time), 0 },
+    { "counter", 'u', 4, offsetof(TimeSeriesRow, counter), 0 },
+    { "action", 'u', 1, offsetof(TimeSeriesRow, action), 0 },
+    { "pid", 'i', 4, offsetof(TimeSeriesRow, pid), 0 },
+    { "value", 'i', 4, offsetof(TimeSeriesRow, value), 0 },
+    { "value2", 'i', 4, offsetof(TimeSeriesRow, value2), 0 },
+    { "remote_ratio", 'i', 4, offsetof(TimeSeriesRow, remote_ratio), 0 },
+    { "mba", 'i', 4, offsetof(TimeSeriesRow, mba), 0 },
+    { "target_slo", 'f', 8, offsetof(TimeSeriesRow, target_slo), 0 },
+    { "latency", 'f', 8, offsetof(TimeSeriesRow, latency), 0 },
+    { "latency_xpn", 'f', 8, offsetof(TimeSeriesRow, latency_xpn), 0 },
+    { "slack", 'f', 8, offsetof(TimeSeriesRow, slack), 0 },
+    { "hp_stall_rate", 'f', 8, offsetof(TimeSeriesRow, hp_stall_rate), 0 },
+    { "be_stall_rate", 'f', 8, offsetof(TimeSeriesRow, be_stall_rate), 0 } };
+
+struct TimeSeriesHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t ncolumns;
+  uint64_t chunk_rows;
+  uint64_t chunk_size;  // bytes
+  uint64_t max_chunks;  // 0: unbounded
+  TimeSeriesColumn columns[TS_MAX_COLUMNS];
+};
+
+struct TimeSeriesChunk {
+  uint64_t magic;
+  uint64_t index;  // of the chunk in the series
+  uint32_t rows;  // recorded, updated after each row
+  uint32_t pad[11];
+};
+
+static_assert(sizeof(TimeSeriesHeader) <= TS_HEADER_SIZE, "TimeSeriesHeader");
+static_assert(sizeof(TimeSeriesChunk) == 64, "TimeSeriesChunk layout");
+
+// the recorder, disabled if TIMESERIES is empty
+void open_timeseries(void);
+void close_timeseries(void);
+void timeseries_record(const TimeSeriesRow &row);
+
+#endif /* INCLUDE_TIMESERIES_HPP_ */
@@ -0,0 +1,60 @@
+/*
+ * Timeline.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_TIMELINE_HPP_
+#define INCLUDE_TIMELINE_HPP_
+
+#include <stdint.h>
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+/*
+ * Timeline of the controller in the Chrome Trace Event format (TIMELINE),
+ * to open in chrome://tracing or ui.perfetto.dev
+ *
+ * Spans: page placements (and every move_pages batch), hardware writes,
+ * counter and latency reads, settle waits. Instants: the decisions of the
+ * control loops. Counters: the p99 latencies. The time is the clock of the
+ * plant, virtual for the replay and simulated plants.
+ *
+ * After TIMELINE_MAX_EVENTS events the file is rotated to TIMELINE.1, every
+ * file is a complete trace.
+ */
+
+typedef std::initializer_list<std::pair<const char*, double>> timeline_args;
+
+extern bool timeline_enabled;
+
+void open_timeline(void);
+void close_timeline(void);
+
+void timeline_instant(const char *cat, const char *name, timeline_args args =
+                          { });
+void timeline_counter(const char *name, timeline_args args);
+
+/*
+ * A span from its construction to its destruction, e.g.
+ *   TimelineSpan span("actuation", "MBA write", {{"cos", 1}, {"value", 80}});
+ */
+class TimelineSpan {
+ public:
+  TimelineSpan(const char *cat, const char *name, timeline_args args = { });
+  ~TimelineSpan();
+
+  // an argument known at the end of the span
+  void arg(const char *key, double value);
+
+ private:
+  const char *_cat;
+  const char *_name;
+  bool _active;  // the timeline was on at the start
+  uint64_t _start;
+  std::string _args;
+};
+
+#endif /* INCLUDE_TIMELINE_HPP_ */
@@ -0,0 +1,69 @@
+/*
+ * Trace.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_TRACE_HPP_
+#define INCLUDE_TRACE_HPP_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * Binary trace of a run: a header followed by fixed-size records in time
+ * order, every sample the controller takes and every action it applies
+ */
+#define TRACE_MAGIC 0x3145434152544d42ULL  // "BMTRACE1"
+#define TRACE_VERSION 1
+
+enum trace_kind {
+  TRACE_LATENCY = 0,  // p99 latency of the HP (usec)
+  TRACE_LATENCY_XPN,  // p99 latency of xapian (ms)
+  TRACE_STALL_RATE,   // index: monitored core
+  TRACE_MBA,          // index: socket << 16 | cos
+  TRACE_LLC,          // index: socket << 16 | cos
+  TRACE_RATIO,        // index: pid of the BE moved, value: remote ratio
+  TRACE_MBA_LEVEL,    // index: valid MBA level, value: bandwidth (MB/s)
+  TRACE_LLC_WAYS,     // value: number of L3 ways
+  TRACE_MAX_KINDS
+};
+
+struct trace_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t num_cores;
+  double target_slo;
+  double target_slo_xapian;
+  int32_t remote_ratio;  // remote ratio at the start of the trace
+  int32_t mba;           // BE MBA level at the start of the trace
+};
+
+struct trace_record {
+  uint64_t t;  // usec since the start of the trace
+  uint32_t kind;
+  uint32_t index;
+  double value;
+};
+
+#define TRACE_INDEX(socket, cos) (((socket) << 16) | (cos))
+#define TRACE_SOCKET(index) ((index) >> 16)
+#define TRACE_COS(index) ((index) & 0xffff)
+
+/*
+ * Create the trace file and write the header, returns false on error
+ */
+bool trace_open(const std::string &path, const trace_header &header);
+bool trace_is_open(void);
+void trace_write(uint64_t t, trace_kind kind, uint32_t index, double value);
+void trace_close(void);
+
+/*
+ * Load a whole trace, returns false if the file is not a valid trace
+ */
+bool trace_read(const std::string &path, trace_header *header,
+                std::vector<trace_record> *records);
+
+#endif /* INCLUDE_TRACE_HPP_ */
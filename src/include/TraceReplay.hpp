@@ -0,0 +1,91 @@
+/*
+ * TraceReplay.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_TRACEREPLAY_HPP_
+#define INCLUDE_TRACEREPLAY_HPP_
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "include/Plant.hpp"
+#include "include/Trace.hpp"
+
+/*
+ * Open-loop replay: the sensors return what was recorded at the same
+ * (virtual) time, the actions of the policy do not change them
+ * useful to see what a new policy would have done on the same input
+ */
+class TracePlant : public VirtualPlant {
+ public:
+  explicit TracePlant(const std::string &path);
+
+  const char* name() const {
+    return "trace replay";
+  }
+
+  double latency();
+  double latency_xpn();
+  bool has_counters();
+  std::vector<double> stall_rate();
+
+ private:
+  // apply the records up to the current time
+  void seek();
+
+  trace_header header;
+  std::vector<trace_record> records;
+  size_t cursor;
+  bool counters;
+  double last_latency;
+  double last_latency_xpn;
+  std::vector<double> last_stall_rate;
+};
+
+/*
+ * Closed-loop replay: the samples of the trace are grouped by the
+ * configuration (remote ratio, MBA, L3 ways) that was active when they were
+ * taken, the sensors replay the samples of the configuration the policy
+ * applies (or of the nearest recorded one)
+ */
+class FittedPlant : public VirtualPlant {
+ public:
+  explicit FittedPlant(const std::string &path);
+
+  const char* name() const {
+    return "fitted";
+  }
+
+  double latency();
+  double latency_xpn();
+  bool has_counters();
+  std::vector<double> stall_rate();
+
+ protected:
+  void step(uint64_t dt);
+  double be_throughput();
+
+ private:
+  typedef std::tuple<int, int, int> Config;  // ratio, mba, ways
+  typedef std::pair<uint32_t, uint32_t> Series;  // kind, index
+  struct Samples {
+    std::vector<double> values;
+    uint64_t last_t = 0;
+  };
+
+  // samples of a series in the current configuration
+  Samples* lookup(trace_kind kind, uint32_t index);
+  double value(trace_kind kind, uint32_t index);
+
+  trace_header header;
+  bool counters;
+  unsigned long ticks;
+  std::map<Config, std::map<Series, Samples>> cells;
+};
+
+#endif /* INCLUDE_TRACEREPLAY_HPP_ */
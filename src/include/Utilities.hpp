@@ -15,6 +15,10 @@
 #include <ctime>
 
 #include "include/MySharedMemory.hpp"
+#include "include/TimeSeries.hpp"
+
+// the memory segments of the BE
+extern std::vector<MySharedMemory> mem_segments;
 
 void read_weights(std::string filename);
 
@@ -26,7 +30,9 @@ double get_latest_percentile_latency_xpn();
 double get_percentile_latency_xpn();
 
 void measurement_collector(void);
-double get_latest_percentile_latency(void);
+double get_latest_percentile_latency(void);  // from the plant
+double get_sampled_percentile_latency(void);  // from the measurement thread
+double get_sampled_percentile_latency_xpn(void);
 void spawn_measurement_thread(void);
 
 // Important Modes
@@ -35,11 +41,19 @@ void page_migration_only(void);
 void mba_only(void);
 void linux_default(void);
 void mba_10(void);
+void abc_numa_model(void);  // joint (ratio x mba) search with an online model
+void pid_mba(void);  // continuous MBA regulation on the HP slack
+void abc_numa_multi(void);  // several BEs, throttled by the arbiter
+void bwap_tune(void);  // online gradient descent of the BE weights (BWAP)
+bool bwap_ready(void);  // whether the stall rates of bwap_tune are read
 
 // Important Functionalities
 void apply_mba(int mba_value);
+void apply_llc(int ways);
+int shrink_llc(void);
+int release_llc(void);
 int search_optimal_mba(void);
-int mba_binary_search(int current_mba, double progress);
+int mba_binary_search(int low_mba, int high_mba);
 int apply_pagemigration_rl(void);
 int apply_pagemigration_lr(void);
 int apply_pagemigration_rl_be(void);
@@ -47,6 +61,7 @@ int check_opt_direction(void);
 int release_mba(void);
 int apply_pagemigration_lr_dc(void);
 void get_memory_segments(void);
+void initialize_stall_rates(void);
 int apply_pagemigration_lr_same_socket(void);
 
 void signalHandler(int signum);
@@ -57,10 +72,9 @@ void bw_manager_test(void);
 void find_optimal_lr_ratio(void);
 void my_logger(std::chrono::system_clock::time_point tn, int crr, int cml,
                double hpt, double hcl, double slk, double hps, double bes,
-               std::string, int lc);
+               const TsAction &action, int lc);
 void test_fixed_ratio(void);
 void print_logs(void);
 void print_logs_v2(void);
-void print_to_file(void);
 
 #endif /* INCLUDE_UTILITIES_HPP_ */
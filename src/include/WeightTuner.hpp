@@ -0,0 +1,60 @@
+/*
+ * WeightTuner.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef INCLUDE_WEIGHTTUNER_HPP_
+#define INCLUDE_WEIGHTTUNER_HPP_
+
+#include <vector>
+
+/*
+ * Gradient descent over the weights (%) of the BE pages on N nodes, the
+ * online counterpart of scripts/bwap_gd_executor.c
+ * - an iteration takes the cost (e.g. the BE stall rate) at the weights and
+ *   at one probe per node: that node + step, the others - step / (N - 1)
+ * - the derivative of a node is the relative change of the cost per % of
+ *   the pages moved to it, every weight moves against its derivative by
+ *   rate x derivative (at most step), then the weights are clamped at 0 and
+ *   normalized to 100
+ * - it has converged when no weight moved by min_move or more, or after
+ *   max_iter iterations
+ */
+class WeightTuner {
+ public:
+  WeightTuner(int nodes, double step, double rate, double min_move,
+              int max_iter);
+
+  void reset(const std::vector<double> &weights);
+  // the weights to take the derivative of node at
+  std::vector<double> probe(int node) const;
+  // the costs at the weights and at the probe of every node, returns the
+  // largest move of a weight
+  double update(double cost, const std::vector<double> &probe_costs);
+
+  inline const std::vector<double>& weights() const {
+    return _weights;
+  }
+
+  inline bool converged() const {
+    return _converged;
+  }
+
+  inline int iterations() const {
+    return _iterations;
+  }
+
+ private:
+  static void normalize(std::vector<double> &weights);
+
+  int _nodes;
+  double _step, _rate, _min_move;
+  int _max_iter;
+
+  std::vector<double> _weights;
+  int _iterations;
+  bool _converged;
+};
+
+#endif /* INCLUDE_WEIGHTTUNER_HPP_ */
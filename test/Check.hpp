@@ -0,0 +1,45 @@
+/*
+ * Check.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TEST_CHECK_HPP_
+#define TEST_CHECK_HPP_
+
+#include <math.h>
+#include <stdio.h>
+
+/*
+ * Minimal checks of the unit tests (ctest), every failure is printed and
+ * counted, main() returns check_result()
+ */
+
+static int check_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      check_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) do { \
+    double check_a = (a), check_b = (b); \
+    if (!(fabs(check_a - check_b) <= (tolerance))) { \
+      printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, \
+             __LINE__, #a, #b, check_a, check_b); \
+      check_failures++; \
+    } \
+  } while (0)
+
+static inline int check_result() {
+  if (check_failures != 0) {
+    printf("%d checks failed\n", check_failures);
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
+
+#endif /* TEST_CHECK_HPP_ */
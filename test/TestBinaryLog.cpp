@@ -0,0 +1,133 @@
+/*
+ * TestBinaryLog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the binary log records: the arguments encoded on the hot
+ * path render like printf would have printed them
+ */
+
+#include <stdio.h>
+
+#include <string>
+
+#include "include/BinaryLog.hpp"
+#include "Check.hpp"
+
+using namespace bwmanager;
+
+template<typename ... Args>
+static std::string render(const char *fmt, const Args &... args) {
+  LogRecord r;
+  memset(&r, 0, sizeof(r));
+  log_encode_all(r, args...);
+  return log_format(fmt, r);
+}
+
+template<typename ... Args>
+static std::string print(const char *fmt, const Args &... args) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), fmt, args...);
+  return buf;
+}
+
+#define CHECK_SAME(fmt, ...) do { \
+    std::string check_rendered = render(fmt, __VA_ARGS__); \
+    std::string check_printed = print(fmt, __VA_ARGS__); \
+    if (check_rendered != check_printed) { \
+      printf("%s:%d: \"%s\" rendered \"%s\", printf \"%s\"\n", __FILE__, \
+             __LINE__, fmt, check_rendered.c_str(), check_printed.c_str()); \
+      check_failures++; \
+    } \
+  } while (0)
+
+static void test_integers() {
+  CHECK_SAME("%d %i", -42, 7);
+  CHECK_SAME("%u %lu %llu", 42u, 1UL << 40, 18446744073709551615ULL);
+  CHECK_SAME("%ld %lld", -(1L << 40), -9223372036854775807LL);
+  CHECK_SAME("%x %X %o %#x", 255u, 255u, 8u, 255u);
+  CHECK_SAME("[%5d|%-5d|%05d|%+d]", 42, 42, 42, 42);
+  CHECK_SAME("%c%c", 'o', 'k');
+  CHECK_SAME("%d", true);
+}
+
+static void test_doubles() {
+  CHECK_SAME("%f %lf %.10lf", 3.25, -0.5, 1.0 / 3);
+  CHECK_SAME("%e %E %g %G", 12345.678, 0.000123, 1e-10, 1e20);
+  CHECK_SAME("[%8.2lf|%-8.1f|%08.3f]", 3.14159, 2.5, -1.5);
+  CHECK_SAME("%.0lf%%", 99.6);
+  CHECK_SAME("%f", 1.5f);
+}
+
+static void test_strings() {
+  CHECK_SAME("%s, %s!", "hello", "world");
+  CHECK_SAME("[%10s|%-10s|%.3s]", "right", "left", "truncated");
+  std::string s = "a std::string";
+  CHECK(render("%s", s) == s);
+  const char *null = NULL;
+  CHECK(render("%s", null) == "(null)");
+  CHECK(render("%s", "") == "");
+}
+
+static void test_pointers() {
+  int x;
+  CHECK_SAME("%p", &x);
+}
+
+// the arguments are taken in order whatever their type
+static void test_mismatch() {
+  CHECK(render("%d", 2.9) == "2");
+  CHECK(render("%u", 7.0) == "7");
+  CHECK(render("%.1f", 3) == "3.0");
+  CHECK(render("%.1f", 3u) == "3.0");
+  CHECK(render("%s", 12) == "12");
+  // a string read as a number is 0
+  CHECK(render("%d %u|", "x", "y") == "0 0|");
+  CHECK(render("%.1f", "x") == "0.0");
+}
+
+static void test_missing() {
+  CHECK(render("%d and %d", 1) == "1 and <?>");
+  CHECK(render("100%% %d", 5) == "100% 5");
+  CHECK(render("no arguments") == "no arguments");
+  CHECK(render("%k", 1) == "<%k?>");
+}
+
+// a record that does not fit is cut and marked
+static void test_truncated() {
+  std::string big(200, 'x');
+  std::string rendered = render("%s", big);
+  CHECK(rendered.size() < big.size());
+  CHECK(rendered.find(" [truncated]") != std::string::npos);
+
+  rendered = render("%d%d%d%d%d%d%d%d%d%d%d%d%d", 0, 1, 2, 3, 4, 5, 6, 7, 8,
+                    9, 0, 1, 2);
+  CHECK(rendered == "012345678901<?> [truncated]");
+}
+
+static void test_line() {
+  LogSite site = { 2, "%d segments", "Test.cpp", 12, "main", 0 };
+  LogRecord r;
+  memset(&r, 0, sizeof(r));
+  r.time = 1500000000;
+  log_encode_all(r, 3);
+  std::string line = log_format_line(site, r, 1234, false);
+  CHECK(line.find("00001.500000000") == 0);
+  CHECK(line.find(" INFO ") != std::string::npos);
+  CHECK(line.find("Test.cpp:12") != std::string::npos);
+  CHECK(line.size() > 10 && line.substr(line.size() - 10) == "3 segments");
+}
+
+int main() {
+  test_integers();
+  test_doubles();
+  test_strings();
+  test_pointers();
+  test_mismatch();
+  test_missing();
+  test_truncated();
+  test_line();
+  return check_result();
+}
@@ -0,0 +1,110 @@
+/*
+ * TestChangeDetector.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the CUSUM phase change detector
+ */
+
+#include <math.h>
+
+#include <limits>
+#include <vector>
+
+#include "include/ChangeDetector.hpp"
+#include "Check.hpp"
+
+// a noisy but stationary signal around mean
+static double noisy(double mean, int i) {
+  return mean * (1 + 0.02 * sin(i * 1.3));
+}
+
+// samples until the first change, -1 if none
+static int first_change(ChangeDetector &d, double mean, int samples) {
+  for (int i = 0; i < samples; i++) {
+    if (d.update(noisy(mean, i))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void test_warmup() {
+  ChangeDetector d(1, 10, 50, 0.05);
+  for (int i = 0; i < 50; i++) {
+    CHECK(!d.armed());
+    // no decision while learning, however large the sample
+    CHECK(!d.update(i % 2 ? 100 : 1000));
+  }
+  CHECK(d.armed());
+}
+
+static void test_stationary() {
+  ChangeDetector d(1, 10, 50, 0.05);
+  CHECK(first_change(d, 100, 5000) == -1);
+  CHECK_NEAR(d.mean(), 100, 1);
+}
+
+// a shift of the mean is detected in a few samples, both ways, and the
+// detector re-learns the baseline of the new regime
+static void test_shift() {
+  ChangeDetector d(1, 10, 50, 0.05);
+  CHECK(first_change(d, 100, 200) == -1);
+  int up = first_change(d, 150, 200);
+  CHECK(up >= 0 && up < 5);
+  CHECK(!d.armed());
+  CHECK(first_change(d, 150, 200) == -1);
+  CHECK_NEAR(d.mean(), 150, 2);
+  int down = first_change(d, 100, 200);
+  CHECK(down >= 0 && down < 5);
+}
+
+// the floor of the standard deviation: a flat baseline does not turn a
+// little noise into a change
+static void test_flat_baseline() {
+  ChangeDetector d(1, 10, 50, 0.05);
+  for (int i = 0; i < 50; i++) {
+    d.update(100);
+  }
+  CHECK(first_change(d, 100, 1000) == -1);
+}
+
+// unavailable samples (e.g., counters disabled) are skipped
+static void test_unavailable() {
+  ChangeDetector d(1, 10, 50, 0.05);
+  for (int i = 0; i < 100; i++) {
+    CHECK(!d.update(std::numeric_limits<double>::quiet_NaN()));
+    CHECK(!d.update(std::numeric_limits<double>::infinity()));
+  }
+  CHECK(!d.armed());
+}
+
+// a change in one series starts every series over
+static void test_phase_change() {
+  std::vector<double> sample(2);
+  for (int i = 0; i < 100; i++) {
+    sample = { noisy(100, i), noisy(10, i + 7) };
+    CHECK(!detect_phase_change(sample));
+  }
+  bool changed = false;
+  for (int i = 0; i < 5 && !changed; i++) {
+    sample = { noisy(100, i), noisy(20, i + 7) };
+    changed = detect_phase_change(sample);
+  }
+  CHECK(changed);
+  // back to learning: a shift of the other series goes unnoticed
+  sample = { 500, 20 };
+  CHECK(!detect_phase_change(sample));
+}
+
+int main() {
+  test_warmup();
+  test_stationary();
+  test_shift();
+  test_flat_baseline();
+  test_unavailable();
+  test_phase_change();
+  return check_result();
+}
@@ -0,0 +1,128 @@
+/*
+ * TestPerformanceModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the performance model of the abc-numa-model mode
+ */
+
+#include <vector>
+
+#include "include/PerformanceModel.hpp"
+#include "Check.hpp"
+
+static const std::vector<int> ratios = { 0, 25, 50, 75, 100 };
+static const std::vector<int> mbas = { 10, 30, 50, 70, 90, 100 };
+
+// a plant where throttling or moving the BE away gives the HP slack
+static double plant_slack(int ratio, int mba) {
+  return 0.5 + 0.3 * ratio / 100.0 - 0.6 * mba / 100.0;
+}
+
+static double plant_be(int ratio, int mba) {
+  return mba * (1 - 0.2 * ratio / 100.0);
+}
+
+static void observe_all(PerformanceModel &model, int times) {
+  for (int i = 0; i < times; i++) {
+    for (int r : ratios) {
+      for (int m : mbas) {
+        model.observe(r, m, plant_slack(r, m), plant_be(r, m));
+      }
+    }
+  }
+}
+
+// the cells keep an EWMA of their observations, off-grid values go to the
+// nearest cell
+static void test_cells() {
+  PerformanceModel model;
+  model.reset(ratios, mbas);
+  CHECK(model.observations() == 0);
+  CHECK_NEAR(model.uncertainty(50, 50), 1, 1e-9);
+
+  model.observe(50, 50, 0.5, 10);
+  model.observe(52, 48, 1.0, 20);
+  CHECK(model.observations() == 2);
+  CHECK_NEAR(model.predict_slack(50, 50), 0.65, 1e-9);
+  CHECK_NEAR(model.predict_be(50, 50), 13, 1e-9);
+  CHECK_NEAR(model.uncertainty(50, 50), 0, 1e-9);
+  // distance 2 on the grid
+  CHECK(model.uncertainty(75, 70) > model.uncertainty(75, 50));
+
+  model.clear();
+  CHECK(model.observations() == 0);
+  CHECK(model.get_cells().size() == ratios.size() * mbas.size());
+}
+
+// the surrogate fills the unobserved cells from the observed ones
+static void test_fit() {
+  PerformanceModel model;
+  model.reset(ratios, mbas);
+  for (int i = 0; i < 20; i++) {
+    for (int r : ratios) {
+      for (int m : mbas) {
+        if (r != 50 || m != 50) {
+          model.observe(r, m, plant_slack(r, m), plant_be(r, m));
+        }
+      }
+    }
+  }
+  CHECK_NEAR(model.predict_slack(50, 50), plant_slack(50, 50), 0.05);
+  CHECK_NEAR(model.predict_be(50, 50), plant_be(50, 50), 5);
+
+  // a single observation already orders the grid like the prior
+  PerformanceModel sparse;
+  sparse.reset(ratios, mbas);
+  sparse.observe(0, 100, -0.1, 100);
+  CHECK(sparse.predict_slack(0, 10) > sparse.predict_slack(0, 100));
+  CHECK(sparse.predict_slack(100, 100) > sparse.predict_slack(0, 100));
+  CHECK(sparse.predict_be(0, 10) < sparse.predict_be(0, 100));
+}
+
+// the best BE throughput among the cells that meet the SLO
+static void test_next_probe() {
+  PerformanceModel model;
+  model.reset(ratios, mbas);
+  observe_all(model, 5);
+
+  int ratio = -1, mba = -1;
+  CHECK(model.next_probe(0, 100, 0.1, &ratio, &mba));
+  CHECK(plant_slack(ratio, mba) >= 0.1);
+  for (int r : ratios) {
+    for (int m : mbas) {
+      if (plant_slack(r, m) >= 0.1) {
+        CHECK(plant_be(r, m) <= plant_be(ratio, mba) + 0.05 * 100);
+      }
+    }
+  }
+
+  // already there
+  int again_ratio = -1, again_mba = -1;
+  CHECK(!model.next_probe(ratio, mba, 0.1, &again_ratio, &again_mba));
+  CHECK(again_ratio == ratio && again_mba == mba);
+
+  // nothing meets the SLO: the safest cell
+  CHECK(model.next_probe(0, 100, 10, &ratio, &mba));
+  CHECK(ratio == 100 && mba == 10);
+}
+
+// an unobserved cell is worth a visit
+static void test_exploration() {
+  PerformanceModel model;
+  model.reset(ratios, mbas);
+  model.observe(0, 10, 0.4, 10);
+  int ratio = -1, mba = -1;
+  CHECK(model.next_probe(0, 10, 0, &ratio, &mba));
+  CHECK(mba > 10);
+}
+
+int main() {
+  test_cells();
+  test_fit();
+  test_next_probe();
+  test_exploration();
+  return check_result();
+}
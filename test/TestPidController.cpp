@@ -0,0 +1,73 @@
+/*
+ * TestPidController.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the PID controller of the pid mode
+ */
+
+#include "include/PidController.hpp"
+#include "Check.hpp"
+
+// reset() starts from the actuator value, clamped to the limits
+static void test_reset() {
+  PidController pid(10, 10, 0, 10, 100);
+  pid.reset(60);
+  CHECK_NEAR(pid.output(), 60, 1e-9);
+  // no error, no move
+  CHECK_NEAR(pid.update(0.1, 0.1, 0.2), 60, 1e-9);
+
+  pid.reset(200);
+  CHECK_NEAR(pid.output(), 100, 1e-9);
+  pid.reset(0);
+  CHECK_NEAR(pid.output(), 10, 1e-9);
+}
+
+// the integral stays at the limit while the output is saturated, so the
+// output leaves the limit as soon as the error changes sign
+static void test_anti_windup() {
+  PidController pid(10, 10, 0, 10, 100);
+  pid.reset(100);
+  for (int i = 0; i < 100; i++) {
+    CHECK_NEAR(pid.update(0, 5, 0.2), 100, 1e-9);
+  }
+  // integral 100 - ki x 1 x dt, minus kp x 1
+  CHECK_NEAR(pid.update(0, -1, 0.2), 88, 1e-9);
+
+  pid.reset(10);
+  for (int i = 0; i < 100; i++) {
+    CHECK_NEAR(pid.update(0, -5, 0.2), 10, 1e-9);
+  }
+  CHECK_NEAR(pid.update(0, 1, 0.2), 22, 1e-9);
+}
+
+// the integral term accumulates the error over time
+static void test_integral() {
+  PidController pid(0, 10, 0, 0, 100);
+  pid.reset(50);
+  pid.update(0, 1, 0.5);
+  pid.update(0, 1, 0.5);
+  CHECK_NEAR(pid.output(), 60, 1e-9);
+  pid.update(0, -2, 0.25);
+  CHECK_NEAR(pid.output(), 55, 1e-9);
+}
+
+// the derivative acts on the measurement: a setpoint step does not kick
+static void test_derivative_on_measurement() {
+  PidController pid(0, 0, 10, 0, 100);
+  pid.reset(50);
+  pid.update(0.1, 0.5, 0.2);
+  CHECK_NEAR(pid.update(0.4, 0.5, 0.2), 50, 1e-9);
+  // a rising measurement pushes the output up
+  CHECK(pid.update(0.4, 0.6, 0.2) > 50);
+}
+
+int main() {
+  test_reset();
+  test_anti_windup();
+  test_integral();
+  test_derivative_on_measurement();
+  return check_result();
+}
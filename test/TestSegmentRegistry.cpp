@@ -0,0 +1,170 @@
+/*
+ * TestSegmentRegistry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the segment table: ranges registered and unregistered in
+ * pieces, and coalesced into mem_segments; and of the registration queue
+ * with a late producer
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "include/BwManager.hpp"
+#include "include/SegmentDiscovery.hpp"
+#include "include/SegmentQueue.hpp"
+#include "include/SegmentRegistry.hpp"
+#include "include/Tenants.hpp"
+#include "include/Utilities.hpp"
+#include "Check.hpp"
+
+// the rest of the manager, without discovery or BEs to regroup
+std::vector<MySharedMemory> mem_segments;
+std::string segment_queue_group;
+static int regroups = 0;
+
+bool discovery_enabled() {
+  return false;
+}
+
+std::set<pid_t> get_be_pids() {
+  return std::set<pid_t>();
+}
+
+void discover_segments() {
+}
+
+void update_be_segments(const std::vector<MySharedMemory> &segments) {
+  regroups++;
+}
+
+static const uint64_t PAGE = sysconf(_SC_PAGESIZE);
+static const uint64_t BASE = 0x7f0000000000ULL;
+
+static MySharedMemory segment(pid_t pid, uint64_t page, uint64_t pages) {
+  return MySharedMemory((void*) (BASE + page * PAGE), pages * PAGE, pid);
+}
+
+static bool has_segment(pid_t pid, uint64_t page, uint64_t pages) {
+  for (const MySharedMemory &s : mem_segments) {
+    if (s.processID == pid
+        && (uint64_t) s.pageAlignedStartAddress == BASE + page * PAGE
+        && s.pageAlignedLength == pages * PAGE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// adjacent ranges of a process become one segment, a gap or another
+// process keeps them apart
+static void test_coalesce(pid_t pid) {
+  register_segments({ segment(pid, 0, 4), segment(pid, 4, 4) });
+  register_segments({ segment(pid, 8, 2), segment(pid, 20, 1) });
+  CHECK(sync_segments());
+  CHECK(mem_segments.size() == 2);
+  CHECK(has_segment(pid, 0, 10));
+  CHECK(has_segment(pid, 20, 1));
+
+  // nothing new, nothing to rebuild
+  int before = regroups;
+  CHECK(!sync_segments());
+  CHECK(regroups == before);
+
+  // the same addresses in another process
+  register_segments({ segment(1, 10, 10) });
+  CHECK(sync_segments());
+  CHECK(mem_segments.size() == 3);
+  CHECK(has_segment(1, 10, 10));
+  CHECK(has_segment(pid, 0, 10));
+  unregister_process(1);
+  CHECK(sync_segments());
+  CHECK(mem_segments.size() == 2);
+}
+
+// unregistering a piece splits a range, registering over it joins it again
+static void test_split(pid_t pid) {
+  unregister_segments({ segment(pid, 3, 2) });
+  CHECK(sync_segments());
+  CHECK(mem_segments.size() == 3);
+  CHECK(has_segment(pid, 0, 3));
+  CHECK(has_segment(pid, 5, 5));
+
+  register_segments({ segment(pid, 2, 4) });
+  CHECK(sync_segments());
+  CHECK(mem_segments.size() == 2);
+  CHECK(has_segment(pid, 0, 10));
+
+  // an unaligned range covers its pages
+  MySharedMemory unaligned((void*) (BASE + 30 * PAGE + 100), PAGE, pid);
+  register_segments({ unaligned });
+  CHECK(sync_segments());
+  CHECK(has_segment(pid, 30, 2));
+}
+
+// the segments of a process that exited without telling are dropped
+static void test_exited() {
+  pid_t child = fork();
+  if (child == 0) {
+    _exit(0);
+  }
+  waitpid(child, NULL, 0);
+  register_segments({ segment(child, 100, 1) });
+  CHECK(sync_segments());
+  CHECK(mem_segments.empty());
+}
+
+// a producer claims a slot and stalls, the slot is skipped and reused: the
+// writes of the late producer tear the next event of the slot
+static void test_late_producer() {
+  SegmentQueue *q = new SegmentQueue();
+  segment_queue_init(q);
+  SegmentEvent event;
+  uint64_t pos;
+
+  // claimed, not published
+  q->head.store(1);
+  CHECK(segment_queue_unpublished(q, &pos) && pos == 0);
+  CHECK(!segment_queue_pop(q, &event));
+  segment_queue_skip(q);
+
+  // a full round, the slot of the late producer comes again
+  for (uint64_t i = 1; i < SEGMENT_QUEUE_CAPACITY; i++) {
+    CHECK(segment_queue_push(q, SEGMENT_REGISTER, 1, i, 1, i));
+    CHECK(segment_queue_pop(q, &event) && event.start == i);
+  }
+  CHECK(segment_queue_push(q, SEGMENT_REGISTER, 2, 4096, 1, 100));
+  // the late producer writes its fields over the new event
+  q->slots[0].pid = 3;
+  q->slots[0].start = 8192;
+  CHECK(!segment_queue_pop(q, &event));
+  CHECK(q->torn.load() == 1);
+
+  // the queue goes on
+  CHECK(segment_queue_push(q, SEGMENT_UNREGISTER, 1, 1, 1, 101));
+  CHECK(segment_queue_pop(q, &event) && event.type == SEGMENT_UNREGISTER
+        && event.start == 1);
+  CHECK(!segment_queue_pop(q, &event));
+  delete q;
+}
+
+int main() {
+  pid_t pid = getpid();
+  // first, the liveness is checked at most once per second
+  test_exited();
+  test_coalesce(pid);
+  test_split(pid);
+  unregister_process(pid);
+  CHECK(sync_segments());
+  CHECK(mem_segments.empty());
+  test_late_producer();
+  return check_result();
+}
@@ -0,0 +1,199 @@
+/*
+ * TestSettleDetector.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the settle detector on synthetic responses to an action
+ */
+
+#include <math.h>
+
+#include <limits>
+#include <vector>
+
+#include "include/Actuator.hpp"
+#include "include/BwManager.hpp"
+#include "include/ChangeDetector.hpp"
+#include "include/Plant.hpp"
+#include "include/SettleDetector.hpp"
+#include "include/Timeline.hpp"
+#include "include/Utilities.hpp"
+#include "Check.hpp"
+
+// the rest of the manager, wait_settle() is not tested here
+Plant *plant = NULL;
+double noise_allowed = 0.05;
+useconds_t settle_period = 20000;
+useconds_t settle_dead_time = 100000;
+useconds_t settle_max_wait = 3000000;
+size_t settle_window = 10;
+useconds_t latency_window = 1000000;
+
+int actuator_commit() {
+  return 0;
+}
+
+double get_latest_percentile_latency() {
+  return 0;
+}
+
+double get_latest_percentile_latency_xpn() {
+  return 0;
+}
+
+void rearm_phase_detection() {
+}
+
+TimelineSpan::TimelineSpan(const char *cat, const char *name,
+                           timeline_args args)
+    : _cat(cat),
+      _name(name),
+      _active(false),
+      _start(0) {
+}
+
+TimelineSpan::~TimelineSpan() {
+}
+
+void TimelineSpan::arg(const char *key, double value) {
+}
+
+static const useconds_t PERIOD = 20000;
+
+// first order response from 1 to 2 with time constant tau (usec), a little
+// noise on top
+static double response(useconds_t t, useconds_t tau) {
+  return (2 - exp(-(double) t / tau)) * (1 + 0.005 * sin(t / 7000.0));
+}
+
+// feed the detector until it is done, returns the elapsed time
+static useconds_t run(SettleDetector &d, useconds_t tau) {
+  d.start();
+  useconds_t t = 0;
+  while (!d.done()) {
+    t += PERIOD;
+    d.step({ response(t, tau), 5.0 });
+  }
+  return d.elapsed();
+}
+
+// a faster plant settles sooner, in a few time constants
+static void test_response() {
+  SettleDetector d(PERIOD, 100000, 3000000, 10, 0.05);
+  CHECK(d.state() == SettleDetector::IDLE);
+  useconds_t fast = run(d, 50000);
+  CHECK(d.state() == SettleDetector::SETTLED);
+  useconds_t slow = run(d, 300000);
+  CHECK(d.state() == SettleDetector::SETTLED);
+  CHECK(fast < slow);
+  CHECK(slow > 300000 && slow < 2000000);
+  // the window must be full of settled samples
+  CHECK(fast >= 100000 + 10 * PERIOD);
+}
+
+// nothing is tested during the dead time, even a flat signal
+static void test_dead_time() {
+  SettleDetector d(PERIOD, 1000000, 3000000, 10, 0.05);
+  d.start();
+  for (useconds_t t = PERIOD; t < 1000000; t += PERIOD) {
+    CHECK(d.step({ 1.0 }) == SettleDetector::DEAD_TIME);
+  }
+  CHECK(d.step({ 1.0 }) == SettleDetector::WATCHING);
+  while (!d.done()) {
+    d.step({ 1.0 });
+  }
+  CHECK(d.state() == SettleDetector::SETTLED);
+  CHECK(d.elapsed() == 1000000 + 9 * PERIOD);
+}
+
+// a stale p99 (held flat until the latency window rolls over) settles on
+// stale data with a short dead time, not with a dead time of a full window
+static void test_stale_latency() {
+  const useconds_t window = 1000000;
+  for (useconds_t dead_time : { (useconds_t) 100000, window }) {
+    SettleDetector d(PERIOD, dead_time, 3000000, 10, 0.05);
+    d.start();
+    useconds_t t = 0;
+    while (!d.done()) {
+      t += PERIOD;
+      // the new level shows once the window only holds samples after the
+      // action
+      d.step({ t < window ? 1.0 : 2.0 });
+    }
+    CHECK(d.state() == SettleDetector::SETTLED);
+    if (dead_time < window) {
+      CHECK(d.elapsed() < window);
+    } else {
+      CHECK(d.elapsed() >= window + 9 * PERIOD);
+    }
+  }
+}
+
+// a signal still drifting does not settle
+static void test_trend() {
+  SettleDetector d(PERIOD, 100000, 1000000, 10, 0.05);
+  d.start();
+  useconds_t t = 0;
+  while (!d.done()) {
+    t += PERIOD;
+    d.step({ exp(t / 2e6) });
+  }
+  CHECK(d.state() == SettleDetector::TIMED_OUT);
+  CHECK(d.elapsed() == 1000000);
+}
+
+// noisier than the tolerance never settles, unavailable signals do not hold
+// it back, invalid samples are left out
+static void test_signals() {
+  SettleDetector d(PERIOD, 100000, 1000000, 10, 0.05);
+  d.start();
+  int i = 0;
+  while (!d.done()) {
+    d.step({ i++ % 2 ? 1.0 : 1.2 });
+  }
+  CHECK(d.state() == SettleDetector::TIMED_OUT);
+
+  d.start();
+  while (!d.done()) {
+    d.step({ 3.0, std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN() });
+  }
+  CHECK(d.state() == SettleDetector::SETTLED);
+
+  // an invalid sample now and then neither settles a noisy signal
+  d.start();
+  i = 0;
+  while (!d.done()) {
+    i++;
+    d.step({ i % 3 == 0 ? std::numeric_limits<double>::infinity() :
+        i % 2 ? 1.0 : 1.2 });
+  }
+  CHECK(d.state() == SettleDetector::TIMED_OUT);
+
+  // nor holds back a flat one
+  d.start();
+  i = 0;
+  while (!d.done()) {
+    d.step({ i++ % 3 == 0 ? std::numeric_limits<double>::quiet_NaN() : 2.0 });
+  }
+  CHECK(d.state() == SettleDetector::SETTLED);
+  CHECK(d.elapsed() < 1000000);
+
+  // all zero is no data, not flat
+  d.start();
+  while (!d.done()) {
+    d.step({ 0.0 });
+  }
+  CHECK(d.state() == SettleDetector::TIMED_OUT);
+}
+
+int main() {
+  test_response();
+  test_dead_time();
+  test_stale_latency();
+  test_trend();
+  test_signals();
+  return check_result();
+}
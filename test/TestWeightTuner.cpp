@@ -0,0 +1,137 @@
+/*
+ * TestWeightTuner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Unit tests of the gradient descent of the bwap mode
+ */
+
+#include <math.h>
+
+#include <vector>
+
+#include "include/WeightTuner.hpp"
+#include "Check.hpp"
+
+static double sum(const std::vector<double> &w) {
+  double s = 0;
+  for (double x : w) {
+    s += x;
+  }
+  return s;
+}
+
+// a convex cost, lowest with best % of the pages on node 0
+static double cost(const std::vector<double> &w, double best) {
+  return 1 + (w[0] - best) * (w[0] - best) / 1e4;
+}
+
+// run the descent to the end, as bwap_tune() does
+static void tune(WeightTuner &tuner, double best) {
+  while (!tuner.converged()) {
+    std::vector<double> probe_costs;
+    for (size_t i = 0; i < tuner.weights().size(); i++) {
+      probe_costs.push_back(cost(tuner.probe(i), best));
+    }
+    tuner.update(cost(tuner.weights(), best), probe_costs);
+  }
+}
+
+// the weights are clamped at [0, 100] and sum up to 100
+static void test_normalize() {
+  WeightTuner tuner(2, 7, 1000, 0.5, 20);
+  CHECK_NEAR(tuner.weights()[0], 50, 1e-9);
+
+  tuner.reset({ 1, 3 });
+  CHECK_NEAR(tuner.weights()[0], 25, 1e-9);
+  CHECK_NEAR(tuner.weights()[1], 75, 1e-9);
+
+  tuner.reset({ -5, 300 });
+  CHECK_NEAR(tuner.weights()[0], 0, 1e-9);
+  CHECK_NEAR(tuner.weights()[1], 100, 1e-9);
+
+  tuner.reset({ 0, 0 });
+  CHECK_NEAR(tuner.weights()[0], 50, 1e-9);
+
+  // missing nodes get nothing
+  WeightTuner three(3, 7, 1000, 0.5, 20);
+  three.reset({ 100 });
+  CHECK(three.weights().size() == 3);
+  CHECK_NEAR(three.weights()[0], 100, 1e-9);
+  CHECK_NEAR(sum(three.weights()), 100, 1e-9);
+}
+
+// a probe moves step % of the pages to a node, taken evenly from the others
+static void test_probe() {
+  WeightTuner tuner(3, 6, 1000, 0.5, 20);
+  tuner.reset({ 40, 30, 30 });
+  std::vector<double> p = tuner.probe(1);
+  CHECK_NEAR(p[0], 37, 1e-9);
+  CHECK_NEAR(p[1], 36, 1e-9);
+  CHECK_NEAR(p[2], 27, 1e-9);
+
+  // clamped at the edge
+  tuner.reset({ 100, 0, 0 });
+  p = tuner.probe(0);
+  CHECK_NEAR(p[0], 100, 1e-9);
+  CHECK_NEAR(sum(p), 100, 1e-9);
+}
+
+// the descent finds the lowest cost, from either side
+static void test_converge() {
+  WeightTuner tuner(2, 7, 1000, 0.5, 50);
+  tuner.reset({ 100, 0 });
+  tune(tuner, 60);
+  CHECK(tuner.iterations() < 50);
+  CHECK_NEAR(tuner.weights()[0], 60, 5);
+  CHECK_NEAR(sum(tuner.weights()), 100, 1e-9);
+
+  tuner.reset({ 0, 100 });
+  tune(tuner, 60);
+  CHECK(tuner.iterations() < 50);
+  CHECK_NEAR(tuner.weights()[0], 60, 5);
+
+  // the lowest cost at the edge
+  tuner.reset({ 50, 50 });
+  tune(tuner, 100);
+  CHECK(tuner.weights()[0] > 95);
+}
+
+// a flat cost does not move the weights, the descent stops right away
+static void test_flat() {
+  WeightTuner tuner(2, 7, 1000, 0.5, 20);
+  tuner.reset({ 70, 30 });
+  CHECK_NEAR(tuner.update(1, { 1, 1 }), 0, 1e-9);
+  CHECK(tuner.converged());
+  CHECK(tuner.iterations() == 1);
+  CHECK_NEAR(tuner.weights()[0], 70, 1e-9);
+}
+
+// a move is at most step, and the descent stops after max_iter
+static void test_limits() {
+  WeightTuner tuner(2, 7, 1e6, 0.01, 3);
+  tuner.reset({ 50, 50 });
+  double move = tuner.update(1, { 2, 1 });
+  CHECK(move <= 7 + 1e-9);
+  CHECK(tuner.weights()[0] < 50);
+  tuner.update(1, { 2, 1 });
+  CHECK(!tuner.converged());
+  tuner.update(1, { 2, 1 });
+  CHECK(tuner.converged());
+  CHECK(tuner.iterations() == 3);
+
+  // a single node has nothing to tune
+  WeightTuner one(1, 7, 1000, 0.5, 20);
+  CHECK(one.converged());
+}
+
+int main() {
+  test_normalize();
+  test_probe();
+  test_converge();
+  test_flat();
+  test_limits();
+  return check_result();
+}
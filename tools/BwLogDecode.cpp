@@ -0,0 +1,108 @@
+/*
+ * BwLogDecode.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Render a binary log of BwManager (LOG_BINARY) as the text logger prints it
+ *
+ * Usage: bwlogdecode [-p] FILE
+ *   -p: plain text, without the ANSI escape codes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "include/BinaryLog.hpp"
+
+using namespace bwmanager;
+
+// the strings of the sites of the file
+struct DecodedSite {
+  LogSite site;
+  std::string fmt;
+  std::string file;
+  std::string function;
+};
+
+static bool read_string(FILE *f, uint16_t len, std::string &s) {
+  s.resize(len);
+  return len == 0 || fread(&s[0], 1, len, f) == len;
+}
+
+int main(int argc, char *argv[]) {
+  bool color = true;
+  int opt;
+  while ((opt = getopt(argc, argv, "p")) != -1) {
+    if (opt == 'p') {
+      color = false;
+    } else {
+      fprintf(stderr, "Usage: %s [-p] FILE\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "Usage: %s [-p] FILE\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  FILE *f = fopen(argv[optind], "r");
+  if (f == NULL) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+  BinaryLogHeader header;
+  if (fread(&header, sizeof(header), 1, f) != 1
+      || header.magic != BINARY_LOG_MAGIC) {
+    fprintf(stderr, "%s: not a binary log\n", argv[optind]);
+    return EXIT_FAILURE;
+  }
+  if (header.version != BINARY_LOG_VERSION) {
+    fprintf(stderr, "%s: unsupported version %u\n", argv[optind],
+            header.version);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<DecodedSite*> sites;
+  uint32_t type;
+  while (fread(&type, sizeof(type), 1, f) == 1) {
+    if (type == LOG_ENTRY_SITE) {
+      BinaryLogSite entry;
+      DecodedSite *d = new DecodedSite();
+      if (fread(&entry, sizeof(entry), 1, f) != 1
+          || !read_string(f, entry.fmt_len, d->fmt)
+          || !read_string(f, entry.file_len, d->file)
+          || !read_string(f, entry.function_len, d->function)) {
+        break;
+      }
+      d->site = {entry.level, d->fmt.c_str(), d->file.c_str(), entry.line,
+        d->function.c_str(), entry.id};
+      if (entry.id >= sites.size()) {
+        sites.resize(entry.id + 1, NULL);
+      }
+      sites[entry.id] = d;
+    } else if (type == LOG_ENTRY_RECORD) {
+      LogRecord r;
+      if (fread(&r, sizeof(r), 1, f) != 1) {
+        break;
+      }
+      if (r.site >= sites.size() || sites[r.site] == NULL) {
+        fprintf(stderr, "record of an unknown site %u\n", r.site);
+        continue;
+      }
+      printf("%s\n",
+             log_format_line(sites[r.site]->site, r, header.pid, color).c_str());
+    } else {
+      fprintf(stderr, "%s: corrupted entry of type %u\n", argv[optind], type);
+      return EXIT_FAILURE;
+    }
+  }
+  fclose(f);
+  return EXIT_SUCCESS;
+}
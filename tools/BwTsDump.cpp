@@ -0,0 +1,137 @@
+/*
+ * BwTsDump.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Print a time series of BwManager (TIMESERIES) as tab-separated rows, in
+ * the order they were recorded, also while the manager is running
+ *
+ * Usage: bwtsdump [-a | -s] FILE
+ *   -a: only the actions
+ *   -s: only the latency samples
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "include/TimeSeries.hpp"
+
+static void print_value(const TimeSeriesColumn &column, const char *value) {
+  if (column.type == 'f') {
+    double d;
+    memcpy(&d, value, sizeof(d));
+    printf("%.4f", d);
+  } else if (column.type == 'i') {
+    int32_t i;
+    memcpy(&i, value, sizeof(i));
+    printf("%d", i);
+  } else {
+    uint64_t u = 0;
+    memcpy(&u, value, column.size);
+    if (strcmp(column.name, "action") == 0) {
+      printf("%s", ts_action_name(u));
+    } else {
+      printf("%" PRIu64, u);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int only = -1;  // 1: actions, 0: samples
+  int opt;
+  while ((opt = getopt(argc, argv, "as")) != -1) {
+    if (opt == 'a') {
+      only = 1;
+    } else if (opt == 's') {
+      only = 0;
+    } else {
+      fprintf(stderr, "Usage: %s [-a | -s] FILE\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "Usage: %s [-a | -s] FILE\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+  if (st.st_size < TS_HEADER_SIZE) {
+    fprintf(stderr, "%s: not a time series\n", argv[optind]);
+    return EXIT_FAILURE;
+  }
+  char *file = (char*) mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (file == MAP_FAILED) {
+    perror("mmap");
+    return EXIT_FAILURE;
+  }
+  const TimeSeriesHeader *header = (const TimeSeriesHeader*) file;
+  if (header->magic != TS_MAGIC || header->version != TS_VERSION
+      || header->ncolumns > TS_MAX_COLUMNS) {
+    fprintf(stderr, "%s: not a time series\n", argv[optind]);
+    return EXIT_FAILURE;
+  }
+
+  // the chunks in the order of the series
+  std::vector<const TimeSeriesChunk*> chunks;
+  for (off_t offset = TS_HEADER_SIZE;
+      offset + (off_t) header->chunk_size <= st.st_size;
+      offset += header->chunk_size) {
+    const TimeSeriesChunk *chunk = (const TimeSeriesChunk*) (file + offset);
+    if (chunk->magic == TS_MAGIC && chunk->rows > 0) {
+      chunks.push_back(chunk);
+    }
+  }
+  std::sort(chunks.begin(), chunks.end(),
+            [](const TimeSeriesChunk *a, const TimeSeriesChunk *b) {
+              return a->index < b->index;
+            });
+
+  int action_column = -1;
+  for (uint32_t c = 0; c < header->ncolumns; c++) {
+    printf("%s%s", c == 0 ? "" : "\t", header->columns[c].name);
+    if (strcmp(header->columns[c].name, "action") == 0) {
+      action_column = c;
+    }
+  }
+  printf("\n");
+
+  for (const TimeSeriesChunk *chunk : chunks) {
+    uint32_t rows = __atomic_load_n(&chunk->rows, __ATOMIC_ACQUIRE);
+    rows = std::min<uint64_t>(rows, header->chunk_rows);
+    for (uint32_t i = 0; i < rows; i++) {
+      if (only != -1 && action_column != -1) {
+        uint8_t action = ((const uint8_t*) chunk)[header->columns[action_column]
+            .offset + i];
+        if ((action != TS_SAMPLE) != (only == 1)) {
+          continue;
+        }
+      }
+      for (uint32_t c = 0; c < header->ncolumns; c++) {
+        const TimeSeriesColumn &column = header->columns[c];
+        printf("%s", c == 0 ? "" : "\t");
+        print_value(column,
+                    (const char*) chunk + column.offset + i * column.size);
+      }
+      printf("\n");
+    }
+  }
+  munmap(file, st.st_size);
+  close(fd);
+  return EXIT_SUCCESS;
+}
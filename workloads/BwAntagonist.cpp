@@ -0,0 +1,287 @@
+/*
+ * BwAntagonist.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Memory bandwidth antagonist, a BE that the manager can throttle and
+ * migrate without external benchmarks
+ *
+ * Every thread streams over (or reads at random from) its share of one
+ * buffer, the throughput is logged every second and summed up at the end.
+ * The buffer is published to the manager through the MyVector handoff of
+ * MySharedMemory, or registered in the segment queue with -q (also with a
+ * manager started later).
+ *
+ * Usage: bwantagonist [-s MB] [-t THREADS] [-a stream|random] [-n NODE]
+ *                     [-d SEC] [-c ON,OFF] [-q]
+ *   -s: the buffer (1024 MB)
+ *   -t: threads (1)
+ *   -a: access pattern, read-modify-write streams or random 8 B reads
+ *       (stream)
+ *   -n: the node of the buffer (first touch)
+ *   -d: duration (0: until SIGINT/SIGTERM)
+ *   -c: duty cycle, ON seconds at full speed then OFF seconds idle
+ *   -q: register in the segment queue instead of the handoff
+ */
+
+#include <math.h>
+#include <numa.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/Logger.hpp"
+#include "include/MySharedMemory.hpp"
+#include "include/SegmentQueue.hpp"
+
+#define CACHE_LINE 64
+
+struct alignas(CACHE_LINE) ThreadBytes {
+  std::atomic<uint64_t> bytes;
+};
+
+static std::atomic<bool> running(true);
+static std::atomic<bool> active(true);  // ON part of the duty cycle
+
+static void stop_handler(int) {
+  running = false;
+}
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// read-modify-write of every line, a pass at a time
+static void stream(uint64_t *begin, uint64_t words, ThreadBytes *counter) {
+  const uint64_t words_per_line = CACHE_LINE / sizeof(uint64_t);
+  while (running) {
+    if (!active) {
+      usleep(10000);
+      continue;
+    }
+    // a slice at a time to notice the end quickly
+    const uint64_t slice = 1 << 18;
+    for (uint64_t lo = 0; lo < words && running; lo += slice) {
+      uint64_t hi = std::min(words, lo + slice);
+      for (uint64_t i = lo; i < hi; i += words_per_line) {
+        begin[i]++;
+      }
+      counter->bytes.fetch_add((hi - lo) * sizeof(uint64_t),
+                               std::memory_order_relaxed);
+    }
+  }
+}
+
+// independent random reads of 8 B (xorshift), a line each
+static void random_access(uint64_t *begin, uint64_t words,
+                          ThreadBytes *counter) {
+  uint64_t x = (uint64_t) begin | 1;
+  uint64_t sum = 0;
+  while (running) {
+    if (!active) {
+      usleep(10000);
+      continue;
+    }
+    for (int i = 0; i < 65536; i++) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      sum += begin[x % words];
+    }
+    counter->bytes.fetch_add(65536 * CACHE_LINE, std::memory_order_relaxed);
+  }
+  // keep the reads
+  begin[0] = sum;
+}
+
+// the MyVector handoff, appended to if other BEs published already
+static void publish_handoff(void *start, unsigned long length) {
+  typedef ipc::allocator<MySharedMemory,
+      ipc::managed_shared_memory::segment_manager> ShmemAllocator;
+  typedef ipc::vector<MySharedMemory, ShmemAllocator> MyVector;
+
+  try {
+    ipc::managed_shared_memory segment(ipc::open_or_create, "MySharedMemory",
+                                       65536);
+    auto append = [&]() {
+      MyVector *myvector = segment.find_or_construct<MyVector>("MyVector")(
+          segment.get_segment_manager());
+      myvector->push_back(MySharedMemory(start, length, getpid()));
+    };
+    segment.atomic_func(append);
+    LINFOF("Published %lu bytes at %p in MySharedMemory", length, start);
+  } catch (ipc::interprocess_exception &ex) {
+    LERRORF("Unable to publish the buffer: %s", ex.what());
+    exit(EXIT_FAILURE);
+  }
+}
+
+// the segment queue of the current manager, NULL without one
+static SegmentQueue *queue = NULL;
+static ino_t queue_inode = 0;
+
+// register the buffer with a (new) manager
+static void register_queue(void *start, unsigned long length) {
+  struct stat st;
+  if (stat("/dev/shm/" SEGMENT_QUEUE_NAME, &st) != 0
+      || (queue != NULL && st.st_ino == queue_inode)) {
+    return;
+  }
+  SegmentQueue *q = segment_queue_attach();
+  if (q == NULL) {
+    return;
+  }
+  if (queue != NULL) {
+    munmap(queue, sizeof(SegmentQueue));
+  }
+  queue = q;
+  queue_inode = st.st_ino;
+  segment_queue_push(queue, SEGMENT_REGISTER, getpid(), (uint64_t) start,
+                     length, segment_queue_generation(queue));
+  LINFOF("Registered %lu bytes at %p in the segment queue", length, start);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long mb = 1024;
+  int nthreads = 1;
+  std::string pattern = "stream";
+  int node = -1;
+  int duration = 0;
+  int on = 0, off = 0;
+  bool use_queue = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "s:t:a:n:d:c:q")) != -1) {
+    switch (opt) {
+      case 's':
+        mb = atol(optarg);
+        break;
+      case 't':
+        nthreads = std::max(atoi(optarg), 1);
+        break;
+      case 'a':
+        pattern = optarg;
+        break;
+      case 'n':
+        node = atoi(optarg);
+        break;
+      case 'd':
+        duration = atoi(optarg);
+        break;
+      case 'c':
+        if (sscanf(optarg, "%d,%d", &on, &off) != 2 || on <= 0 || off < 0) {
+          fprintf(stderr, "Invalid duty cycle %s\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'q':
+        use_queue = true;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-s MB] [-t THREADS] [-a stream|random] "
+                "[-n NODE] [-d SEC] [-c ON,OFF] [-q]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (pattern != "stream" && pattern != "random") {
+    fprintf(stderr, "Invalid access pattern %s\n", pattern.c_str());
+    return EXIT_FAILURE;
+  }
+
+  unsigned long length = mb << 20;
+  void *buffer = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer == MAP_FAILED) {
+    LERRORF("mmap of %lu MB failed: %s", mb, strerror(errno));
+    return EXIT_FAILURE;
+  }
+  if (node >= 0) {
+    if (numa_available() < 0 || node > numa_max_node()) {
+      LERRORF("Invalid node %d", node);
+      return EXIT_FAILURE;
+    }
+    numa_tonode_memory(buffer, length, node);
+  }
+  memset(buffer, 1, length);
+
+  if (use_queue) {
+    register_queue(buffer, length);
+  } else {
+    publish_handoff(buffer, length);
+  }
+
+  signal(SIGINT, stop_handler);
+  signal(SIGTERM, stop_handler);
+
+  uint64_t words = length / sizeof(uint64_t);
+  uint64_t share = words / nthreads / (CACHE_LINE / sizeof(uint64_t))
+      * (CACHE_LINE / sizeof(uint64_t));
+  std::vector<ThreadBytes> counters(nthreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nthreads; i++) {
+    counters[i].bytes = 0;
+    uint64_t *begin = (uint64_t*) buffer + i * share;
+    threads.push_back(
+        std::thread(pattern == "stream" ? stream : random_access, begin,
+                    share, &counters[i]));
+  }
+  LINFOF("%d %s threads over %lu MB (pid %d)", nthreads, pattern.c_str(), mb,
+         getpid());
+
+  double start = now_sec(), last = start;
+  uint64_t last_bytes = 0;
+  while (running) {
+    sleep(1);
+    double now = now_sec();
+    if (duration > 0 && now - start >= duration) {
+      running = false;
+    }
+    if (on > 0) {
+      active = fmod(now - start, on + off) < on;
+    }
+    // a manager started (or restarted) later
+    if (use_queue) {
+      register_queue(buffer, length);
+    }
+    uint64_t bytes = 0;
+    for (auto &counter : counters) {
+      bytes += counter.bytes.load(std::memory_order_relaxed);
+    }
+    LINFOF("%.2f GB/s", (bytes - last_bytes) / (now - last) / 1e9);
+    last = now;
+    last_bytes = bytes;
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  double elapsed = now_sec() - start;
+  uint64_t bytes = 0;
+  for (auto &counter : counters) {
+    bytes += counter.bytes.load(std::memory_order_relaxed);
+  }
+  LINFOF("Total: %.2f GB in %.1f s, %.2f GB/s", bytes / 1e9, elapsed,
+         bytes / elapsed / 1e9);
+  if (queue != NULL) {
+    segment_queue_push(queue, SEGMENT_EXIT, getpid(), 0, 0,
+                       segment_queue_generation(queue));
+  }
+  munmap(buffer, length);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/*
+ * BwLcService.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * Latency-critical stand-in, a HP service the manager can protect without
+ * memcached or xapian
+ *
+ * Every worker draws the arrivals of its requests from a Poisson process
+ * (open loop), a request is a chain of dependent reads of random lines of
+ * the working set, so that it slows down with the memory bandwidth left to
+ * it. The response time includes the queueing behind late requests.
+ *
+ * The p99 of the last window is served like the HP clients of the manager
+ * do: on every connection to the port, the value as text (usec) and close
+ * (see get_percentile_latency()).
+ *
+ * Usage: bwlcservice [-p PORT] [-r RATE] [-t THREADS] [-w MB] [-l LINES]
+ *                    [-W MS] [-n NODE] [-d SEC]
+ *   -p: latency port (1234)
+ *   -r: requests per second, over all the workers (2000)
+ *   -t: workers (2)
+ *   -w: working set (256 MB)
+ *   -l: dependent reads per request (500)
+ *   -W: window of the p99 (1000 ms)
+ *   -n: the node of the working set (first touch)
+ *   -d: duration (0: until SIGINT/SIGTERM)
+ */
+
+#include <math.h>
+#include <numa.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "include/Logger.hpp"
+
+using boost::asio::ip::tcp;
+
+#define CACHE_LINE 64
+
+// a completed request
+struct Sample {
+  uint64_t time;  // completion (nsec)
+  double latency;  // usec
+};
+
+static std::atomic<bool> running(true);
+
+static std::mutex samples_mutex;
+static std::deque<Sample> samples;  // of the current window
+static std::vector<double> all_latencies;  // for the summary
+
+static uint64_t window = 1000000000ULL;  // nsec
+static volatile uint64_t sink;
+
+static void stop_handler(int) {
+  running = false;
+}
+
+static uint64_t now_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t t) {
+  struct timespec ts;
+  ts.tv_sec = t / 1000000000ULL;
+  ts.tv_nsec = t % 1000000000ULL;
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static double percentile(std::vector<double> &values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t k = std::min(values.size() - 1, (size_t) (p / 100 * values.size()));
+  std::nth_element(values.begin(), values.begin() + k, values.end());
+  return values[k];
+}
+
+// the p99 of the window (usec), 0 without requests
+static double window_p99() {
+  std::vector<double> latencies;
+  {
+    std::lock_guard<std::mutex> lock(samples_mutex);
+    uint64_t now = now_nsec();
+    while (!samples.empty() && samples.front().time + window < now) {
+      samples.pop_front();
+    }
+    for (const Sample &s : samples) {
+      latencies.push_back(s.latency);
+    }
+  }
+  return percentile(latencies, 99);
+}
+
+static void worker(const uint64_t *lines, uint64_t nlines, double rate,
+                   int lines_per_request, int id) {
+  std::mt19937_64 rng(now_nsec() + id);
+  std::exponential_distribution<double> interarrival(rate / 1e9);
+  uint64_t arrival = now_nsec();
+  uint64_t next = rng() % nlines;
+  uint64_t sum = 0;
+  while (running) {
+    arrival += (uint64_t) interarrival(rng);
+    sleep_until(arrival);
+
+    // dependent reads, the next line depends on the value read
+    for (int i = 0; i < lines_per_request; i++) {
+      uint64_t value = lines[next * (CACHE_LINE / sizeof(uint64_t))];
+      sum += value;
+      next = (next * 6364136223846793005ULL + value + 1442695040888963407ULL)
+          % nlines;
+    }
+
+    uint64_t done = now_nsec();
+    Sample s = { done, (done - arrival) / 1e3 };
+    std::lock_guard<std::mutex> lock(samples_mutex);
+    samples.push_back(s);
+    all_latencies.push_back(s.latency);
+  }
+  // keep the reads
+  sink += sum;
+}
+
+// the p99 to every client, one connection at a time
+static void latency_server(int tcp_port) {
+  try {
+    boost::asio::io_service io_service;
+    tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), tcp_port));
+    for (;;) {
+      tcp::socket socket(io_service);
+      acceptor.accept(socket);
+      char reply[32];
+      snprintf(reply, sizeof(reply), "%.0f", window_p99());
+      boost::system::error_code error;
+      boost::asio::write(socket, boost::asio::buffer(reply, strlen(reply)),
+                         error);
+    }
+  } catch (std::exception &e) {
+    LERRORF("Latency port %d: %s", tcp_port, e.what());
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int tcp_port = 1234;
+  double rate = 2000;
+  int nthreads = 2;
+  unsigned long mb = 256;
+  int lines_per_request = 500;
+  int node = -1;
+  int duration = 0;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "p:r:t:w:l:W:n:d:")) != -1) {
+    switch (opt) {
+      case 'p':
+        tcp_port = atoi(optarg);
+        break;
+      case 'r':
+        rate = atof(optarg);
+        break;
+      case 't':
+        nthreads = std::max(atoi(optarg), 1);
+        break;
+      case 'w':
+        mb = atol(optarg);
+        break;
+      case 'l':
+        lines_per_request = std::max(atoi(optarg), 1);
+        break;
+      case 'W':
+        window = atol(optarg) * 1000000ULL;
+        break;
+      case 'n':
+        node = atoi(optarg);
+        break;
+      case 'd':
+        duration = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-p PORT] [-r RATE] [-t THREADS] [-w MB] "
+                "[-l LINES] [-W MS] [-n NODE] [-d SEC]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (rate <= 0) {
+    fprintf(stderr, "Invalid rate %.0f\n", rate);
+    return EXIT_FAILURE;
+  }
+
+  unsigned long length = mb << 20;
+  uint64_t *lines = (uint64_t*) mmap(NULL, length, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (lines == MAP_FAILED) {
+    LERRORF("mmap of %lu MB failed: %s", mb, strerror(errno));
+    return EXIT_FAILURE;
+  }
+  if (node >= 0) {
+    if (numa_available() < 0 || node > numa_max_node()) {
+      LERRORF("Invalid node %d", node);
+      return EXIT_FAILURE;
+    }
+    numa_tonode_memory(lines, length, node);
+  }
+  std::mt19937_64 rng(1);
+  for (uint64_t i = 0; i < length / sizeof(uint64_t); i++) {
+    lines[i] = rng();
+  }
+
+  signal(SIGINT, stop_handler);
+  signal(SIGTERM, stop_handler);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nthreads; i++) {
+    threads.push_back(
+        std::thread(worker, lines, length / CACHE_LINE, rate / nthreads,
+                    lines_per_request, i));
+  }
+  std::thread server(latency_server, tcp_port);
+  // do not wait it to finish
+  server.detach();
+  LINFOF("%d workers, %.0f requests/s over %lu MB, p99 on port %d (pid %d)",
+         nthreads, rate, mb, tcp_port, getpid());
+
+  uint64_t start = now_nsec();
+  while (running) {
+    sleep(1);
+    if (duration > 0 && now_nsec() - start >= duration * 1000000000ULL) {
+      running = false;
+    }
+    LINFOF("p99: %.0f usec", window_p99());
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  double elapsed = (now_nsec() - start) / 1e9;
+  size_t requests = all_latencies.size();
+  double p50 = percentile(all_latencies, 50);
+  double p99 = percentile(all_latencies, 99);
+  LINFOF("Total: %lu requests in %.1f s (%.0f/s), p50 %.0f usec, p99 %.0f usec",
+         requests, elapsed, requests / elapsed, p50, p99);
+  munmap(lines, length);
+  return EXIT_SUCCESS;
+}